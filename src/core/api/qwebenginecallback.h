@@ -53,6 +53,10 @@ class CallbackDirectory;
 
 QT_BEGIN_NAMESPACE
 
+class QImage;
+class QJsonValue;
+class QNetworkCookie;
+
 namespace QtWebEnginePrivate {
 
 template <typename T>
@@ -97,6 +101,9 @@ Q_DECLARE_SHARED(QWebEngineCallback<const QByteArray &>)
 Q_DECLARE_SHARED_NOT_MOVABLE_UNTIL_QT6(QWebEngineCallback<bool>)
 Q_DECLARE_SHARED_NOT_MOVABLE_UNTIL_QT6(QWebEngineCallback<const QString &>)
 Q_DECLARE_SHARED_NOT_MOVABLE_UNTIL_QT6(QWebEngineCallback<const QVariant &>)
+Q_DECLARE_SHARED_NOT_MOVABLE_UNTIL_QT6(QWebEngineCallback<const QImage &>)
+Q_DECLARE_SHARED_NOT_MOVABLE_UNTIL_QT6(QWebEngineCallback<const QJsonValue &>)
+Q_DECLARE_SHARED_NOT_MOVABLE_UNTIL_QT6(QWebEngineCallback<const QList<QNetworkCookie> &>)
 #endif
 
 QT_END_NAMESPACE
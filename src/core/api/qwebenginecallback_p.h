@@ -56,6 +56,10 @@
 
 #include <QByteArray>
 #include <QHash>
+#include <QImage>
+#include <QJsonValue>
+#include <QList>
+#include <QNetworkCookie>
 #include <QSharedData>
 #include <QString>
 #include <QVariant>
@@ -67,7 +71,10 @@
     F(int) \
     F(const QString &) \
     F(const QByteArray &) \
-    F(const QVariant &)
+    F(const QVariant &) \
+    F(const QImage &) \
+    F(const QJsonValue &) \
+    F(const QList<QNetworkCookie> &)
 
 namespace QtWebEngineCore {
 
@@ -75,6 +82,8 @@ class CallbackDirectory {
     template<typename T>
     void invokeInternal(quint64 callbackId, T result);
     template<typename T>
+    void invokePartialInternal(quint64 callbackId, T result);
+    template<typename T>
     void invokeEmptyInternal(QtWebEnginePrivate::QWebEngineCallbackPrivateBase<T> *callback);
 
 public:
@@ -113,6 +122,12 @@ public:
     FOR_EACH_TYPE(DEFINE_INVOKE_FOR_TYPE)
 #undef DEFINE_INVOKE_FOR_TYPE
 
+    // Calls the callback but keeps it registered, for results delivered in several parts.
+    void invokePartial(quint64 callbackId, const QString &result)
+    {
+        invokePartialInternal<const QString &>(callbackId, result);
+    }
+
     template <typename A>
     void invokeDirectly(const QWebEngineCallback<A> &callback, const A &argument)
     {
@@ -174,6 +189,19 @@ void CallbackDirectory::invokeInternal(quint64 callbackId, T result)
     delete ptr;
 }
 
+template<typename T>
+inline
+void CallbackDirectory::invokePartialInternal(quint64 callbackId, T result)
+{
+    CallbackSharedDataPointerBase * const sharedPtrBase = m_callbackMap.value(callbackId);
+    if (!sharedPtrBase)
+        return;
+
+    auto ptr = static_cast<CallbackSharedDataPointer<T> *>(sharedPtrBase);
+    Q_ASSERT(ptr);
+    (*ptr->callback)(std::forward<T>(result));
+}
+
 template<typename T>
 inline
 void CallbackDirectory::invokeEmptyInternal(QtWebEnginePrivate::QWebEngineCallbackPrivateBase<T> *callback)
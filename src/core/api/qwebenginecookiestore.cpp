@@ -51,9 +51,6 @@ using namespace QtWebEngineCore;
 
 QWebEngineCookieStorePrivate::QWebEngineCookieStorePrivate()
     : m_nextCallbackId(CallbackDirectory::ReservedCallbackIdsEnd)
-    , m_deleteSessionCookiesPending(false)
-    , m_deleteAllCookiesPending(false)
-    , m_getAllCookiesPending(false)
     , delegate(0)
 {
 }
@@ -63,40 +60,39 @@ void QWebEngineCookieStorePrivate::processPendingUserCookies()
     Q_ASSERT(delegate);
     Q_ASSERT(delegate->hasCookieMonster());
 
-    if (m_getAllCookiesPending) {
-        m_getAllCookiesPending = false;
-        delegate->getAllCookies(CallbackDirectory::GetAllCookiesCallbackId);
+    QVector<PendingOperation> pendingOperations;
+    m_pendingOperations.swap(pendingOperations);
+
+    Q_FOREACH (const PendingOperation &operation, pendingOperations) {
+        switch (operation.type) {
+        case PendingOperation::SetCookie:
+            delegate->setCookie(operation.callbackId, operation.cookie, operation.url);
+            break;
+        case PendingOperation::SetCookies:
+            delegate->setCookies(operation.callbackId, operation.cookies);
+            break;
+        case PendingOperation::DeleteCookie:
+            delegate->deleteCookie(operation.cookie, operation.url);
+            break;
+        case PendingOperation::DeleteSessionCookies:
+            delegate->deleteSessionCookies(CallbackDirectory::DeleteSessionCookiesCallbackId);
+            break;
+        case PendingOperation::DeleteAllCookies:
+            delegate->deleteAllCookies(CallbackDirectory::DeleteAllCookiesCallbackId);
+            break;
+        case PendingOperation::GetAllCookies:
+            delegate->getAllCookies(CallbackDirectory::GetAllCookiesCallbackId);
+            break;
+        case PendingOperation::GetCookies:
+            delegate->getCookies(operation.callbackId, operation.url);
+            break;
+        }
     }
-
-    if (m_deleteAllCookiesPending) {
-        m_deleteAllCookiesPending = false;
-        delegate->deleteAllCookies(CallbackDirectory::DeleteAllCookiesCallbackId);
-    }
-
-    if (m_deleteSessionCookiesPending) {
-        m_deleteSessionCookiesPending = false;
-        delegate->deleteSessionCookies(CallbackDirectory::DeleteSessionCookiesCallbackId);
-    }
-
-    if (m_pendingUserCookies.isEmpty())
-        return;
-
-    Q_FOREACH (const auto &cookieData, m_pendingUserCookies) {
-        if (cookieData.callbackId == CallbackDirectory::DeleteCookieCallbackId)
-            delegate->deleteCookie(cookieData.cookie, cookieData.origin);
-        else
-            delegate->setCookie(cookieData.callbackId, cookieData.cookie, cookieData.origin);
-    }
-
-    m_pendingUserCookies.clear();
 }
 
 void QWebEngineCookieStorePrivate::rejectPendingUserCookies()
 {
-    m_getAllCookiesPending = false;
-    m_deleteAllCookiesPending = false;
-    m_deleteSessionCookiesPending = false;
-    m_pendingUserCookies.clear();
+    m_pendingOperations.clear();
 }
 
 void QWebEngineCookieStorePrivate::setCookie(const QWebEngineCallback<bool> &callback, const QNetworkCookie &cookie, const QUrl &origin)
@@ -107,17 +103,32 @@ void QWebEngineCookieStorePrivate::setCookie(const QWebEngineCallback<bool> &cal
         callbackDirectory.registerCallback(currentCallbackId, callback);
 
     if (!delegate || !delegate->hasCookieMonster()) {
-        m_pendingUserCookies.append(CookieData{ currentCallbackId, cookie, origin });
+        m_pendingOperations.append(PendingOperation{ PendingOperation::SetCookie, currentCallbackId, cookie, QList<QNetworkCookie>(), origin });
         return;
     }
 
     delegate->setCookie(currentCallbackId, cookie, origin);
 }
 
+void QWebEngineCookieStorePrivate::setCookies(const QWebEngineCallback<int> &callback, const QList<QNetworkCookie> &cookies)
+{
+    const quint64 currentCallbackId = callback ? m_nextCallbackId++ : static_cast<quint64>(CallbackDirectory::NoCallbackId);
+
+    if (currentCallbackId != CallbackDirectory::NoCallbackId)
+        callbackDirectory.registerCallback(currentCallbackId, callback);
+
+    if (!delegate || !delegate->hasCookieMonster()) {
+        m_pendingOperations.append(PendingOperation{ PendingOperation::SetCookies, currentCallbackId, QNetworkCookie(), cookies, QUrl() });
+        return;
+    }
+
+    delegate->setCookies(currentCallbackId, cookies);
+}
+
 void QWebEngineCookieStorePrivate::deleteCookie(const QNetworkCookie &cookie, const QUrl &url)
 {
     if (!delegate || !delegate->hasCookieMonster()) {
-        m_pendingUserCookies.append(CookieData{ CallbackDirectory::DeleteCookieCallbackId, cookie, url });
+        m_pendingOperations.append(PendingOperation{ PendingOperation::DeleteCookie, CallbackDirectory::NoCallbackId, cookie, QList<QNetworkCookie>(), url });
         return;
     }
 
@@ -127,7 +138,7 @@ void QWebEngineCookieStorePrivate::deleteCookie(const QNetworkCookie &cookie, co
 void QWebEngineCookieStorePrivate::deleteSessionCookies()
 {
     if (!delegate || !delegate->hasCookieMonster()) {
-        m_deleteSessionCookiesPending = true;
+        m_pendingOperations.append(PendingOperation{ PendingOperation::DeleteSessionCookies, CallbackDirectory::NoCallbackId, QNetworkCookie(), QList<QNetworkCookie>(), QUrl() });
         return;
     }
 
@@ -137,8 +148,7 @@ void QWebEngineCookieStorePrivate::deleteSessionCookies()
 void QWebEngineCookieStorePrivate::deleteAllCookies()
 {
     if (!delegate || !delegate->hasCookieMonster()) {
-        m_deleteAllCookiesPending = true;
-        m_deleteSessionCookiesPending = false;
+        m_pendingOperations.append(PendingOperation{ PendingOperation::DeleteAllCookies, CallbackDirectory::NoCallbackId, QNetworkCookie(), QList<QNetworkCookie>(), QUrl() });
         return;
     }
 
@@ -148,34 +158,69 @@ void QWebEngineCookieStorePrivate::deleteAllCookies()
 void QWebEngineCookieStorePrivate::getAllCookies()
 {
     if (!delegate || !delegate->hasCookieMonster()) {
-        m_getAllCookiesPending = true;
+        m_pendingOperations.append(PendingOperation{ PendingOperation::GetAllCookies, CallbackDirectory::NoCallbackId, QNetworkCookie(), QList<QNetworkCookie>(), QUrl() });
         return;
     }
 
     delegate->getAllCookies(CallbackDirectory::GetAllCookiesCallbackId);
 }
 
+void QWebEngineCookieStorePrivate::getCookies(const QWebEngineCallback<const QList<QNetworkCookie> &> &callback, const QUrl &url)
+{
+    if (!callback)
+        return;
+
+    const quint64 currentCallbackId = m_nextCallbackId++;
+    callbackDirectory.registerCallback(currentCallbackId, callback);
+
+    if (!delegate || !delegate->hasCookieMonster()) {
+        m_pendingOperations.append(PendingOperation{ PendingOperation::GetCookies, currentCallbackId, QNetworkCookie(), QList<QNetworkCookie>(), url });
+        return;
+    }
+
+    delegate->getCookies(currentCallbackId, url);
+}
+
 void QWebEngineCookieStorePrivate::onGetAllCallbackResult(qint64 callbackId, const QByteArray &cookieList)
 {
     callbackDirectory.invoke(callbackId, cookieList);
 }
+
+void QWebEngineCookieStorePrivate::onGetCookiesCallbackResult(qint64 callbackId, const QList<QNetworkCookie> &cookies)
+{
+    callbackDirectory.invoke(callbackId, cookies);
+}
+
 void QWebEngineCookieStorePrivate::onSetCallbackResult(qint64 callbackId, bool success)
 {
     callbackDirectory.invoke(callbackId, success);
 }
 
+void QWebEngineCookieStorePrivate::onSetCookiesCallbackResult(qint64 callbackId, int numCookies)
+{
+    callbackDirectory.invoke(callbackId, numCookies);
+}
+
 void QWebEngineCookieStorePrivate::onDeleteCallbackResult(qint64 callbackId, int numCookies)
 {
     callbackDirectory.invoke(callbackId, numCookies);
 }
 
-void QWebEngineCookieStorePrivate::onCookieChanged(const QNetworkCookie &cookie, bool removed)
+void QWebEngineCookieStorePrivate::onCookiesChanged(const QVector<QPair<QNetworkCookie, bool>> &changes)
 {
     Q_Q(QWebEngineCookieStore);
-    if (removed)
-        Q_EMIT q->cookieRemoved(cookie);
-    else
-        Q_EMIT q->cookieAdded(cookie);
+    QList<QNetworkCookie> added;
+    QList<QNetworkCookie> removed;
+    for (const QPair<QNetworkCookie, bool> &change : changes) {
+        if (change.second) {
+            removed.append(change.first);
+            Q_EMIT q->cookieRemoved(change.first);
+        } else {
+            added.append(change.first);
+            Q_EMIT q->cookieAdded(change.first);
+        }
+    }
+    Q_EMIT q->cookiesChanged(added, removed);
 }
 
 /*!
@@ -189,8 +234,9 @@ void QWebEngineCookieStorePrivate::onCookieChanged(const QNetworkCookie &cookie,
     to set, delete, and intercept cookies during navigation.
     Because cookie operations are asynchronous, the user can choose to provide a callback function
     to get notified about the success of the operation.
-    The signal handlers for removal and addition should not be used to execute heavy tasks,
-    because they might block the IO thread in case of a blocking connection.
+    Changes to the cookie store are collected on the network thread and delivered to the
+    thread of the cookie store object in batches, so handling them never blocks network
+    activity. setCookieChangeFilter() restricts the notifications to the cookies of interest.
 
     Use QWebEngineProfile::cookieStore() and QQuickWebEngineProfile::cookieStore()
     to access the cookie store object for a specific profile.
@@ -208,6 +254,22 @@ void QWebEngineCookieStorePrivate::onCookieChanged(const QNetworkCookie &cookie,
     This signal is emitted whenever a \a cookie is deleted from the cookie store.
 */
 
+/*!
+    \fn void QWebEngineCookieStore::cookiesChanged(const QList<QNetworkCookie> &added, const QList<QNetworkCookie> &removed)
+    \since 5.10
+
+    This signal is emitted with the cookies that were \a added to and \a removed from the
+    cookie store since the previous emission. Changes are coalesced per cookie, so a cookie
+    that is changed several times in a short period is only reported with its latest state,
+    and it appears in at most one of the two lists. A cookie that is added and removed again
+    within that period is not reported at all.
+
+    The signal is emitted after cookieAdded() and cookieRemoved() have been emitted for the
+    same changes, in the order the changes were made.
+
+    \sa setCookieChangeFilter()
+*/
+
 /*!
     Creates a new QWebEngineCookieStore object with \a parent.
 */
@@ -242,6 +304,74 @@ void QWebEngineCookieStore::setCookie(const QNetworkCookie &cookie, const QUrl &
     d->setCookie(QWebEngineCallback<bool>(), cookie, origin);
 }
 
+/*!
+    \fn void QWebEngineCookieStore::setCookies(const QList<QNetworkCookie> &cookies, FunctorOrLambda resultCallback)
+    \since 5.10
+
+    Adds all \a cookies to the cookie store in a single operation. This is considerably cheaper
+    than calling setCookie() for each cookie when importing a large number of cookies, for
+    example when synchronizing with a QNetworkAccessManager cookie jar.
+
+    The scope of each cookie is derived from its domain and path. Cookies without a domain
+    are rejected and not counted as accepted, use setCookie() with an origin for host-only
+    cookies.
+
+    When provided, \a resultCallback is called with the number of cookies that were accepted
+    once all of them have been processed.
+
+    \note This operation is asynchronous.
+    \sa setCookie(), getCookies()
+*/
+
+void QWebEngineCookieStore::setCookies(const QList<QNetworkCookie> &cookies, const QWebEngineCallback<int> &resultCallback)
+{
+    Q_D(QWebEngineCookieStore);
+    d->setCookies(resultCallback, cookies);
+}
+
+/*!
+    \fn void QWebEngineCookieStore::getCookies(FunctorOrLambda resultCallback, const QUrl &url)
+    \since 5.10
+
+    Retrieves the cookies in the cookie store and passes them to \a resultCallback as one
+    list. If \a url is not empty, only the cookies set for the host of \a url or one of
+    its parent domains are returned, whatever their path and including HttpOnly and Secure
+    cookies. The cookies are filtered on the network thread, so querying a single host
+    only converts the matching cookies.
+
+    Unlike loadAllCookies(), this function does not emit cookieAdded().
+
+    \note This operation is asynchronous.
+    \sa setCookies(), loadAllCookies()
+*/
+
+void QWebEngineCookieStore::getCookies(const QWebEngineCallback<const QList<QNetworkCookie> &> &resultCallback, const QUrl &url)
+{
+    Q_D(QWebEngineCookieStore);
+    d->getCookies(resultCallback, url);
+}
+
+/*!
+    \since 5.10
+
+    Restricts the change notifications of this cookie store to cookies set for one of
+    \a domains or their subdomains and named one of \a names. An empty list matches all
+    domains or names, respectively.
+
+    Cookies that do not match the filter are discarded on the network thread, and no
+    cookieAdded(), cookieRemoved(), or cookiesChanged() signals are emitted for them.
+    Calling the function with two empty lists removes the filter.
+*/
+
+void QWebEngineCookieStore::setCookieChangeFilter(const QStringList &domains, const QStringList &names)
+{
+    Q_D(QWebEngineCookieStore);
+    d->m_changeFilterDomains = domains;
+    d->m_changeFilterNames = names;
+    if (d->delegate)
+        d->delegate->setCookieChangeFilter(domains, names);
+}
+
 /*!
     Deletes \a cookie from the cookie store.
     It is possible to provide an optional \a origin URL argument to limit the scope of the
@@ -43,8 +43,10 @@
 #include <QtWebEngineCore/qtwebenginecoreglobal.h>
 #include <QtWebEngineCore/qwebenginecallback.h>
 
+#include <QtCore/qlist.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qscopedpointer.h>
+#include <QtCore/qstringlist.h>
 #include <QtCore/qurl.h>
 #include <QtNetwork/qnetworkcookie.h>
 
@@ -63,14 +65,23 @@ public:
     virtual ~QWebEngineCookieStore();
 
     void setCookie(const QNetworkCookie &cookie, const QUrl &origin = QUrl());
+#ifdef Q_QDOC
+    void setCookies(const QList<QNetworkCookie> &cookies, FunctorOrLambda resultCallback);
+    void getCookies(FunctorOrLambda resultCallback, const QUrl &url = QUrl());
+#else
+    void setCookies(const QList<QNetworkCookie> &cookies, const QWebEngineCallback<int> &resultCallback = QWebEngineCallback<int>());
+    void getCookies(const QWebEngineCallback<const QList<QNetworkCookie> &> &resultCallback, const QUrl &url = QUrl());
+#endif
     void deleteCookie(const QNetworkCookie &cookie, const QUrl &origin = QUrl());
     void deleteSessionCookies();
     void deleteAllCookies();
     void loadAllCookies();
+    void setCookieChangeFilter(const QStringList &domains, const QStringList &names = QStringList());
 
 Q_SIGNALS:
     void cookieAdded(const QNetworkCookie &cookie);
     void cookieRemoved(const QNetworkCookie &cookie);
+    void cookiesChanged(const QList<QNetworkCookie> &added, const QList<QNetworkCookie> &removed);
 
 private:
     explicit QWebEngineCookieStore(QObject *parent = Q_NULLPTR);
@@ -56,8 +56,11 @@
 #include "qwebenginecallback_p.h"
 #include "qwebenginecookiestore.h"
 
+#include <QList>
 #include <QVector>
 #include <QNetworkCookie>
+#include <QString>
+#include <QStringList>
 #include <QUrl>
 #include <QtCore/private/qobject_p.h>
 
@@ -70,19 +73,31 @@ QT_BEGIN_NAMESPACE
 class QWEBENGINE_PRIVATE_EXPORT QWebEngineCookieStorePrivate : public QObjectPrivate
 {
     Q_DECLARE_PUBLIC(QWebEngineCookieStore)
-    struct CookieData {
+    // An operation requested before the cookie monster was available.
+    struct PendingOperation {
+        enum Type {
+            SetCookie,
+            SetCookies,
+            DeleteCookie,
+            DeleteSessionCookies,
+            DeleteAllCookies,
+            GetAllCookies,
+            GetCookies
+        };
+        Type type;
         quint64 callbackId;
         QNetworkCookie cookie;
-        QUrl origin;
+        QList<QNetworkCookie> cookies;
+        QUrl url;
     };
-    friend class QTypeInfo<CookieData>;
+    friend class QTypeInfo<PendingOperation>;
 public:
     QtWebEngineCore::CallbackDirectory callbackDirectory;
-    QVector<CookieData> m_pendingUserCookies;
+    // Replayed in the order they were requested.
+    QVector<PendingOperation> m_pendingOperations;
+    QStringList m_changeFilterDomains;
+    QStringList m_changeFilterNames;
     quint64 m_nextCallbackId;
-    bool m_deleteSessionCookiesPending;
-    bool m_deleteAllCookiesPending;
-    bool m_getAllCookiesPending;
 
     QtWebEngineCore::CookieMonsterDelegateQt *delegate;
 
@@ -91,18 +106,22 @@ public:
     void processPendingUserCookies();
     void rejectPendingUserCookies();
     void setCookie(const QWebEngineCallback<bool> &callback, const QNetworkCookie &cookie, const QUrl &origin);
+    void setCookies(const QWebEngineCallback<int> &callback, const QList<QNetworkCookie> &cookies);
     void deleteCookie(const QNetworkCookie &cookie, const QUrl &url);
     void deleteSessionCookies();
     void deleteAllCookies();
     void getAllCookies();
+    void getCookies(const QWebEngineCallback<const QList<QNetworkCookie> &> &callback, const QUrl &url);
 
     void onGetAllCallbackResult(qint64 callbackId, const QByteArray &cookieList);
+    void onGetCookiesCallbackResult(qint64 callbackId, const QList<QNetworkCookie> &cookies);
     void onSetCallbackResult(qint64 callbackId, bool success);
+    void onSetCookiesCallbackResult(qint64 callbackId, int numCookies);
     void onDeleteCallbackResult(qint64 callbackId, int numCookies);
-    void onCookieChanged(const QNetworkCookie &cookie, bool removed);
+    void onCookiesChanged(const QVector<QPair<QNetworkCookie, bool>> &changes);
 };
 
-Q_DECLARE_TYPEINFO(QWebEngineCookieStorePrivate::CookieData, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(QWebEngineCookieStorePrivate::PendingOperation, Q_MOVABLE_TYPE);
 
 QT_END_NAMESPACE
 
@@ -52,7 +52,7 @@ QT_BEGIN_NAMESPACE
 
     A QWebEngineUrlRequestJob is given to QWebEngineUrlSchemeHandler::requestStarted() and must
     be handled by the derived implementations of the class. The job can be handled by calling
-    either reply(), redirect(), or fail().
+    either reply(), beginReply(), redirect(), or fail().
 
     The class is owned by the web engine and does not need to be deleted. However, the web engine
     may delete the job when it is no longer needed, and therefore the signal QObject::destroyed()
@@ -87,6 +87,7 @@ QWebEngineUrlRequestJob::QWebEngineUrlRequestJob(URLRequestCustomJobDelegate * p
     : QObject(p) // owned by the jobdelegate and deleted when the job is done
     , d_ptr(p)
 {
+    connect(p, &URLRequestCustomJobDelegate::readyForReplyData, this, &QWebEngineUrlRequestJob::readyForReplyData);
 }
 
 /*!
@@ -112,14 +113,121 @@ QByteArray QWebEngineUrlRequestJob::requestMethod() const
     return d_ptr->method();
 }
 
+/*!
+    \since 5.10
+
+    Returns the position of the first byte of the range requested through an HTTP
+    Range header, or -1 if the whole resource is requested.
+
+    Suffix ranges, which request the last bytes of the resource, and requests for
+    multiple ranges are reported as -1 too.
+
+    Unless setReplyRange() is called, a requested range, including a suffix range, is
+    served automatically from a random access device given to reply(), with a partial
+    content response. Sequential devices and replies started with beginReply() are sent
+    whole.
+
+    \sa requestedRangeEnd(), setReplyRange()
+*/
+qint64 QWebEngineUrlRequestJob::requestedRangeStart() const
+{
+    return d_ptr->rangeStart();
+}
+
+/*!
+    \since 5.10
+
+    Returns the position of the last byte of the requested range, inclusive, or -1
+    if the range extends to the end of the resource or if there is no range.
+
+    \sa requestedRangeStart()
+*/
+qint64 QWebEngineUrlRequestJob::requestedRangeEnd() const
+{
+    return d_ptr->rangeEnd();
+}
+
+/*!
+    \since 5.10
+
+    Tells that the data passed to the following reply() or beginReply() call only holds
+    the bytes from \a start to \a end, inclusive, of a resource that is \a totalSize bytes
+    large, or of unknown size if \a totalSize is -1.
+
+    The request is then answered with a partial content response for that range, and the
+    requested range is not applied to the reply data again. This is how scheme handlers
+    that honor requestedRangeStart() and requestedRangeEnd() themselves, or that reply
+    with sequential devices or in chunks, serve ranges.
+
+    \sa requestedRangeStart(), requestedRangeEnd()
+*/
+void QWebEngineUrlRequestJob::setReplyRange(qint64 start, qint64 end, qint64 totalSize)
+{
+    d_ptr->setReplyRange(start, end, totalSize);
+}
+
 /*!
     Replies to the request with \a device and the MIME type \a contentType.
+
+    The device is read from the thread the job lives in, as the web engine needs more data.
+    Sequential devices may deliver their data as it becomes available; the reply ends once
+    they are closed or have emitted QIODevice::readChannelFinished().
  */
 void QWebEngineUrlRequestJob::reply(const QByteArray &contentType, QIODevice *device)
 {
     d_ptr->setReply(contentType, device);
 }
 
+/*!
+    \since 5.10
+
+    Starts replying to the request with data of the MIME type \a contentType, which is
+    then passed in chunks to appendReplyData() until finishReply() is called.
+    If known, the total size of the reply should be given as \a contentLength.
+
+    \sa reply()
+ */
+void QWebEngineUrlRequestJob::beginReply(const QByteArray &contentType, qint64 contentLength)
+{
+    d_ptr->beginReply(contentType, contentLength);
+}
+
+/*!
+    \since 5.10
+
+    Appends \a data to a reply started with beginReply(). The data is not copied
+    until the web engine reads it, so chunks can be handed over as they are produced.
+
+    Returns \c false without taking \a data if the web engine already holds as much of
+    the reply as it buffers ahead, or if the reply was not started or is already finished.
+    Once the web engine has read enough of the buffered data, readyForReplyData() is
+    emitted and the data can be appended again.
+
+    \sa finishReply(), readyForReplyData()
+ */
+bool QWebEngineUrlRequestJob::appendReplyData(const QByteArray &data)
+{
+    return d_ptr->appendReplyData(data);
+}
+
+/*!
+    \fn void QWebEngineUrlRequestJob::readyForReplyData()
+    \since 5.10
+
+    This signal is emitted when more data can be appended to a streamed reply after
+    appendReplyData() returned \c false.
+ */
+
+/*!
+    \since 5.10
+
+    Ends a reply started with beginReply().
+ */
+void QWebEngineUrlRequestJob::finishReply()
+{
+    d_ptr->finishReply();
+}
+
 /*!
     Fails the request with the error \a r.
 
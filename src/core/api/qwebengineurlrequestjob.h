@@ -72,11 +72,20 @@ public:
 
     QUrl requestUrl() const;
     QByteArray requestMethod() const;
+    qint64 requestedRangeStart() const;
+    qint64 requestedRangeEnd() const;
 
+    void setReplyRange(qint64 start, qint64 end, qint64 totalSize = -1);
     void reply(const QByteArray &contentType, QIODevice *device);
+    void beginReply(const QByteArray &contentType, qint64 contentLength = -1);
+    bool appendReplyData(const QByteArray &data);
+    void finishReply();
     void fail(Error error);
     void redirect(const QUrl &url);
 
+Q_SIGNALS:
+    void readyForReplyData();
+
 private:
     QWebEngineUrlRequestJob(QtWebEngineCore::URLRequestCustomJobDelegate *);
     friend class QtWebEngineCore::URLRequestCustomJobShared;
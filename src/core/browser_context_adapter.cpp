@@ -46,6 +46,7 @@
 #include "content_client_qt.h"
 #include "download_manager_delegate_qt.h"
 #include "permission_manager_qt.h"
+#include "spare_renderer_pool_qt.h"
 #include "type_conversion.h"
 #include "visited_links_manager_qt.h"
 #include "web_engine_context.h"
@@ -101,6 +102,7 @@ BrowserContextAdapter::BrowserContextAdapter(const QString &storageName)
 
 BrowserContextAdapter::~BrowserContextAdapter()
 {
+    m_spareRendererPool.reset();
     m_browserContext->ShutdownStoragePartitions();
     if (m_downloadManagerDelegate)
         content::BrowserThread::DeleteSoon(content::BrowserThread::UI, FROM_HERE, m_downloadManagerDelegate.take());
@@ -440,6 +442,23 @@ UserResourceControllerHost *BrowserContextAdapter::userResourceController()
     return m_userResourceController.data();
 }
 
+SpareRendererPoolQt *BrowserContextAdapter::spareRendererPool()
+{
+    if (!m_spareRendererPool)
+        m_spareRendererPool.reset(new SpareRendererPoolQt(m_browserContext.data()));
+    return m_spareRendererPool.data();
+}
+
+int BrowserContextAdapter::spareRendererCount()
+{
+    return spareRendererPool()->size();
+}
+
+void BrowserContextAdapter::setSpareRendererCount(int count)
+{
+    spareRendererPool()->setSize(count);
+}
+
 void BrowserContextAdapter::permissionRequestReply(const QUrl &origin, PermissionType type, bool reply)
 {
     static_cast<PermissionManagerQt*>(browserContext()->GetPermissionManager())->permissionRequestReply(origin, type, reply);
@@ -60,6 +60,7 @@ namespace QtWebEngineCore {
 class BrowserContextAdapterClient;
 class BrowserContextQt;
 class DownloadManagerDelegateQt;
+class SpareRendererPoolQt;
 class UserResourceControllerHost;
 class VisitedLinksManagerQt;
 
@@ -163,6 +164,10 @@ public:
     bool removeCustomUrlSchemeHandler(QWebEngineUrlSchemeHandler *);
     QWebEngineUrlSchemeHandler *takeCustomUrlSchemeHandler(const QByteArray &);
     UserResourceControllerHost *userResourceController();
+    SpareRendererPoolQt *spareRendererPool();
+
+    int spareRendererCount();
+    void setSpareRendererCount(int count);
 
     void permissionRequestReply(const QUrl &origin, PermissionType type, bool reply);
     bool checkPermission(const QUrl &origin, PermissionType type);
@@ -183,6 +188,7 @@ private:
     QScopedPointer<VisitedLinksManagerQt> m_visitedLinksManager;
     QScopedPointer<DownloadManagerDelegateQt> m_downloadManagerDelegate;
     QScopedPointer<UserResourceControllerHost> m_userResourceController;
+    QScopedPointer<SpareRendererPoolQt> m_spareRendererPool;
     QScopedPointer<QWebEngineCookieStore> m_cookieStore;
     QPointer<QWebEngineUrlRequestInterceptor> m_requestInterceptor;
 
@@ -7,6 +7,7 @@
 #include "content/public/common/common_param_traits.h"
 #include "ipc/ipc_message_macros.h"
 
+#include "common/qt_param_traits.h"
 #include "user_script_data.h"
 
 IPC_STRUCT_TRAITS_BEGIN(UserScriptData)
@@ -34,12 +35,32 @@ IPC_MESSAGE_ROUTED1(RenderViewObserverQt_FetchDocumentMarkup,
 IPC_MESSAGE_ROUTED1(RenderViewObserverQt_FetchDocumentInnerText,
                     uint64_t /* requestId */)
 
+IPC_MESSAGE_ROUTED2(RenderViewObserverQt_StreamDocumentMarkup,
+                    uint64_t /* requestId */,
+                    uint64_t /* maxLength */)
+
+IPC_MESSAGE_ROUTED2(RenderViewObserverQt_StreamDocumentInnerText,
+                    uint64_t /* requestId */,
+                    uint64_t /* maxLength */)
+
 IPC_MESSAGE_ROUTED1(RenderViewObserverQt_SetBackgroundColor,
                     uint32_t /* color */)
 
-IPC_MESSAGE_ROUTED1(WebChannelIPCTransport_Install, uint /* worldId */)
+IPC_MESSAGE_ROUTED3(RenderViewObserverQt_ExecuteJavaScript,
+                    uint64_t /* requestId */,
+                    base::string16 /* script */,
+                    uint /* worldId */)
+
+IPC_MESSAGE_ROUTED4(RenderViewObserverQt_ExecuteJavaScriptBatch,
+                    uint64_t /* requestId */,
+                    std::vector<base::string16> /* scripts */,
+                    uint /* worldId */,
+                    base::string16 /* frameName */)
+
+IPC_MESSAGE_ROUTED2(WebChannelIPCTransport_Install, uint /* worldId */, bool /* objectMessages */)
 IPC_MESSAGE_ROUTED1(WebChannelIPCTransport_Uninstall, uint /* worldId */)
-IPC_MESSAGE_ROUTED2(WebChannelIPCTransport_Message, std::vector<char> /*binaryJSON*/, uint /* worldId */)
+IPC_MESSAGE_ROUTED1(WebChannelIPCTransport_SetObjectMessages, bool /* objectMessages */)
+IPC_MESSAGE_ROUTED2(WebChannelIPCTransport_Message, QByteArray /*binaryJSON*/, uint /* worldId */)
 
 // User scripts messages
 IPC_MESSAGE_ROUTED1(RenderViewObserverHelper_AddScript,
@@ -66,7 +87,20 @@ IPC_MESSAGE_ROUTED2(RenderViewObserverHostQt_DidFetchDocumentInnerText,
 
 IPC_MESSAGE_ROUTED0(RenderViewObserverHostQt_DidFirstVisuallyNonEmptyLayout)
 
-IPC_MESSAGE_ROUTED1(WebChannelIPCTransportHost_SendMessage, std::vector<char> /*binaryJSON*/)
+IPC_MESSAGE_ROUTED3(RenderViewObserverHostQt_DidStreamDocumentChunk,
+                    uint64_t /* requestId */,
+                    base::string16 /* chunk */,
+                    bool /* last */)
+
+IPC_MESSAGE_ROUTED2(RenderViewObserverHostQt_DidExecuteJavaScript,
+                    uint64_t /* requestId */,
+                    QByteArray /* binaryJSON */)
+
+IPC_MESSAGE_ROUTED2(RenderViewObserverHostQt_DidExecuteJavaScriptBatch,
+                    uint64_t /* requestId */,
+                    QByteArray /* binaryJSON */)
+
+IPC_MESSAGE_ROUTED1(WebChannelIPCTransportHost_SendMessage, QByteArray /*binaryJSON*/)
 
 //-----------------------------------------------------------------------------
 // Misc messages
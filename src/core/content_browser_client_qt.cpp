@@ -41,6 +41,7 @@
 
 #include "base/memory/ptr_util.h"
 #include "base/message_loop/message_loop.h"
+#include "base/pending_task.h"
 #include "base/threading/thread_restrictions.h"
 #if defined(ENABLE_SPELLCHECK)
 #include "chrome/browser/spellchecker/spellcheck_message_filter.h"
@@ -97,6 +98,7 @@
 #include "qrc_protocol_handler_qt.h"
 #include "renderer_host/resource_dispatcher_host_delegate_qt.h"
 #include "renderer_host/user_resource_controller_host.h"
+#include "spare_renderer_pool_qt.h"
 #include "web_contents_delegate_qt.h"
 #include "web_engine_context.h"
 #include "web_engine_library_info.h"
@@ -114,6 +116,7 @@
 
 #include <QGuiApplication>
 #include <QLocale>
+#include <QLoggingCategory>
 #ifndef QT_NO_OPENGL
 # include <QOpenGLContext>
 #endif
@@ -127,6 +130,8 @@ namespace QtWebEngineCore {
 
 namespace {
 
+Q_LOGGING_CATEGORY(lcMessagePump, "qt.webengine.messagepump")
+
 ContentBrowserClientQt* gBrowserClient = 0; // Owned by ContentMainDelegateQt.
 
 // Return a timeout suitable for the glib loop, -1 to block forever,
@@ -145,8 +150,17 @@ int GetTimeIntervalMilliseconds(const base::TimeTicks& from) {
   return delay < 0 ? 0 : delay;
 }
 
+// Default time spent running Chromium tasks in one go before yielding back to the Qt
+// event loop, so that input events are not starved. QTWEBENGINE_MESSAGE_PUMP_BUDGET
+// overrides it in milliseconds, 0 runs a single task per event loop iteration.
+const int kDefaultWorkBudgetMs = 8;
+
+// Interval of the statistics reported to the qt.webengine.messagepump logging category.
+const int kStatisticsIntervalSeconds = 10;
+
 class MessagePumpForUIQt : public QObject,
-                           public base::MessagePump
+                           public base::MessagePump,
+                           public base::MessageLoop::TaskObserver
 {
 public:
     MessagePumpForUIQt()
@@ -155,7 +169,29 @@ public:
         : m_delegate(base::MessageLoopForUI::current())
         , m_explicitLoop(0)
         , m_timerId(0)
+        , m_workBudget(base::TimeDelta::FromMilliseconds(kDefaultWorkBudgetMs))
+        , m_reportStatistics(lcMessagePump().isDebugEnabled())
+    {
+        bool ok = false;
+        const int workBudget = qEnvironmentVariableIntValue("QTWEBENGINE_MESSAGE_PUMP_BUDGET", &ok);
+        if (ok && workBudget >= 0)
+            m_workBudget = base::TimeDelta::FromMilliseconds(workBudget);
+        // Lets event filters tell the wake-up events of the pump apart.
+        setObjectName(QStringLiteral("QtWebEngineMessagePump"));
+        if (m_reportStatistics) {
+            m_statisticsStartTime = base::TimeTicks::Now();
+            base::MessageLoop::current()->AddTaskObserver(this);
+        }
+    }
+
+    ~MessagePumpForUIQt()
     {
+        if (m_reportStatistics) {
+            // The message loop is no longer current when it destroys its pump.
+            if (base::MessageLoop *loop = base::MessageLoop::current())
+                loop->RemoveTaskObserver(this);
+            reportStatistics();
+        }
     }
 
     virtual void Run(Delegate *delegate) Q_DECL_OVERRIDE
@@ -176,6 +212,15 @@ public:
 
     virtual void ScheduleWork() Q_DECL_OVERRIDE
     {
+        // This can be called from any thread. Only one wake-up event is kept in flight,
+        // work scheduled while it is pending will be picked up when it gets handled.
+        if (!m_workScheduled.testAndSetOrdered(0, 1)) {
+            if (m_reportStatistics)
+                m_coalescedWakeUps.ref();
+            return;
+        }
+        if (m_reportStatistics)
+            m_wakeUpPostTime.storeRelease(base::TimeTicks::Now().ToInternalValue());
         QCoreApplication::postEvent(this, new QEvent(QEvent::User));
     }
 
@@ -187,21 +232,45 @@ public:
             m_timerScheduledTime = base::TimeTicks();
         } else if (!m_timerId || delayed_work_time < m_timerScheduledTime) {
             killTimer(m_timerId);
-            m_timerId = startTimer(GetTimeIntervalMilliseconds(delayed_work_time));
+            m_timerId = startTimer(GetTimeIntervalMilliseconds(delayed_work_time), Qt::PreciseTimer);
             m_timerScheduledTime = delayed_work_time;
         }
     }
 
+    // base::MessageLoop::TaskObserver
+    virtual void WillProcessTask(const base::PendingTask &pendingTask) Q_DECL_OVERRIDE
+    {
+        // Delayed tasks only start waiting once they are due.
+        const base::TimeTicks readyTime = qMax(pendingTask.time_posted, pendingTask.delayed_run_time);
+        m_queueWait.add(base::TimeTicks::Now() - readyTime);
+    }
+
+    virtual void DidProcessTask(const base::PendingTask &) Q_DECL_OVERRIDE
+    {
+    }
+
 protected:
     virtual void customEvent(QEvent *ev) Q_DECL_OVERRIDE
     {
-        if (handleScheduledWork())
-            QCoreApplication::postEvent(this, new QEvent(QEvent::User));
+        const base::TimeTicks now = base::TimeTicks::Now();
+        if (m_reportStatistics)
+            m_wakeUpLatency.add(now - base::TimeTicks::FromInternalValue(m_wakeUpPostTime.loadAcquire()));
+
+        // Clear the flag before running any task, so that tasks posted meanwhile wake us up again.
+        m_workScheduled.storeRelease(0);
+        if (handleScheduledWork(now + m_workBudget))
+            ScheduleWork();
+
+        if (m_reportStatistics)
+            maybeReportStatistics();
     }
 
     virtual void timerEvent(QTimerEvent *ev) Q_DECL_OVERRIDE
     {
         Q_ASSERT(m_timerId == ev->timerId());
+        if (m_reportStatistics)
+            m_timerLateness.add(base::TimeTicks::Now() - m_timerScheduledTime);
+
         killTimer(m_timerId);
         m_timerId = 0;
         m_timerScheduledTime = base::TimeTicks();
@@ -212,11 +281,31 @@ protected:
     }
 
 private:
-    bool handleScheduledWork() {
-        bool more_work_is_plausible = m_delegate->DoWork();
+    struct LatencyStatistics {
+        LatencyStatistics() : count(0) { }
+        void add(base::TimeDelta latency)
+        {
+            ++count;
+            total += latency;
+            if (latency > max)
+                max = latency;
+        }
+        double averageMs() const { return count ? total.InMillisecondsF() / count : 0; }
+
+        int count;
+        base::TimeDelta total;
+        base::TimeDelta max;
+    };
 
+    bool handleScheduledWork(const base::TimeTicks &deadline) {
+        bool more_work_is_plausible;
         base::TimeTicks delayed_work_time;
-        more_work_is_plausible |= m_delegate->DoDelayedWork(&delayed_work_time);
+        // Run as many tasks as fit in the work budget, but at least one.
+        do {
+            more_work_is_plausible = m_delegate->DoWork();
+            delayed_work_time = base::TimeTicks();
+            more_work_is_plausible |= m_delegate->DoDelayedWork(&delayed_work_time);
+        } while (more_work_is_plausible && base::TimeTicks::Now() < deadline);
 
         if (more_work_is_plausible)
             return true;
@@ -228,10 +317,46 @@ private:
         return more_work_is_plausible;
     }
 
+    void maybeReportStatistics()
+    {
+        if (base::TimeTicks::Now() - m_statisticsStartTime < base::TimeDelta::FromSeconds(kStatisticsIntervalSeconds))
+            return;
+        reportStatistics();
+        m_queueWait = LatencyStatistics();
+        m_wakeUpLatency = LatencyStatistics();
+        m_timerLateness = LatencyStatistics();
+        m_coalescedWakeUps.store(0);
+        m_statisticsStartTime = base::TimeTicks::Now();
+    }
+
+    void reportStatistics() const
+    {
+        qCDebug(lcMessagePump, "%d tasks, queue wait avg %.2f ms, max %.2f ms; "
+                "%d wake-ups (%d coalesced), wake-up latency avg %.2f ms, max %.2f ms; "
+                "%d timers, lateness avg %.2f ms, max %.2f ms",
+                m_queueWait.count, m_queueWait.averageMs(), m_queueWait.max.InMillisecondsF(),
+                m_wakeUpLatency.count, m_coalescedWakeUps.load(),
+                m_wakeUpLatency.averageMs(), m_wakeUpLatency.max.InMillisecondsF(),
+                m_timerLateness.count,
+                m_timerLateness.averageMs(), m_timerLateness.max.InMillisecondsF());
+    }
+
     Delegate *m_delegate;
     QEventLoop *m_explicitLoop;
     int m_timerId;
     base::TimeTicks m_timerScheduledTime;
+    QAtomicInt m_workScheduled;
+    base::TimeDelta m_workBudget;
+
+    const bool m_reportStatistics;
+    // Written by ScheduleWork() on any thread, as base::TimeTicks internal value.
+    QAtomicInteger<qint64> m_wakeUpPostTime;
+    base::TimeTicks m_statisticsStartTime;
+    // Time between a task becoming ready to run and it being run.
+    LatencyStatistics m_queueWait;
+    LatencyStatistics m_wakeUpLatency;
+    LatencyStatistics m_timerLateness;
+    QAtomicInt m_coalescedWakeUps;
 };
 
 std::unique_ptr<base::MessagePump> messagePumpFactory()
@@ -410,7 +535,9 @@ void ContentBrowserClientQt::RenderProcessWillLaunch(content::RenderProcessHost*
     // FIXME: Add a settings variable to enable/disable the file scheme.
     const int id = host->GetID();
     content::ChildProcessSecurityPolicy::GetInstance()->GrantScheme(id, url::kFileScheme);
-    static_cast<BrowserContextQt*>(host->GetBrowserContext())->m_adapter->userResourceController()->renderProcessStartedWithHost(host);
+    BrowserContextAdapter *adapter = static_cast<BrowserContextQt*>(host->GetBrowserContext())->m_adapter;
+    adapter->userResourceController()->renderProcessStartedWithHost(host);
+    adapter->spareRendererPool()->renderProcessWillLaunch(host);
 #if defined(ENABLE_PEPPER_CDMS)
     host->AddFilter(new BrowserMessageFilterQt(id));
 #endif
@@ -41,6 +41,7 @@
 
 #include "base/bind.h"
 #include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/cookies/cookie_util.h"
 
@@ -48,6 +49,8 @@
 #include "api/qwebenginecookiestore_p.h"
 #include "type_conversion.h"
 
+#include <algorithm>
+
 namespace QtWebEngineCore {
 
 static GURL sourceUrlForCookie(const QNetworkCookie &cookie) {
@@ -75,9 +78,72 @@ static void onGetAllCookiesCallback(QWebEngineCookieStorePrivate *client, qint64
                                      base::Bind(&QWebEngineCookieStorePrivate::onGetAllCallbackResult, base::Unretained(client), callbackId, rawCookies));
 }
 
+static std::string normalizedCookieDomain(const QString &domain)
+{
+    QString normalized = domain.toLower();
+    if (normalized.startsWith(QLatin1Char('.')))
+        normalized.remove(0, 1);
+    return normalized.toStdString();
+}
+
+// Matches the domain itself and any of its subdomains, with or without a leading dot.
+static bool cookieDomainMatches(const std::string &cookieDomain, const std::string &domain)
+{
+    const size_t offset = cookieDomain.size() - std::min(cookieDomain.size(), domain.size());
+    return cookieDomain.compare(offset, std::string::npos, domain) == 0
+            && (offset == 0 || cookieDomain[offset - 1] == '.');
+}
+
+static void onGetCookiesCallback(QWebEngineCookieStorePrivate *client, qint64 callbackId, const net::CookieList& cookies) {
+    QList<QNetworkCookie> result;
+    result.reserve(int(cookies.size()));
+    for (auto&& cookie: cookies)
+        result.append(toQt(cookie));
+
+    content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
+                                     base::Bind(&QWebEngineCookieStorePrivate::onGetCookiesCallbackResult, base::Unretained(client), callbackId, result));
+}
+
+// Collects the results of the cookies set by one setCookies() call on the IO thread
+// and reports the number of accepted cookies back to the UI thread once all are done.
+class SetCookiesBatch : public base::RefCounted<SetCookiesBatch> {
+public:
+    SetCookiesBatch(QWebEngineCookieStorePrivate *client, qint64 callbackId, size_t pendingCount)
+        : m_client(client)
+        , m_callbackId(callbackId)
+        , m_pendingCount(pendingCount)
+        , m_successCount(0)
+    { }
+
+    void onSetCookie(bool success)
+    {
+        Q_ASSERT(m_pendingCount > 0);
+        if (success)
+            ++m_successCount;
+        if (--m_pendingCount == 0)
+            reply(m_client, m_callbackId, m_successCount);
+    }
+
+    static void reply(QWebEngineCookieStorePrivate *client, qint64 callbackId, int successCount)
+    {
+        content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
+                                         base::Bind(&QWebEngineCookieStorePrivate::onSetCookiesCallbackResult, base::Unretained(client), callbackId, successCount));
+    }
+
+private:
+    friend class base::RefCounted<SetCookiesBatch>;
+    ~SetCookiesBatch() { }
+
+    QWebEngineCookieStorePrivate *m_client;
+    qint64 m_callbackId;
+    size_t m_pendingCount;
+    int m_successCount;
+};
+
 CookieMonsterDelegateQt::CookieMonsterDelegateQt()
     : m_client(0)
     , m_cookieMonster(nullptr)
+    , m_cookieChangeFlushPending(false)
 {
 }
 
@@ -105,6 +171,39 @@ void CookieMonsterDelegateQt::GetAllCookiesOnIOThread(const net::CookieMonster::
         m_cookieMonster->GetAllCookiesAsync(callback);
 }
 
+void CookieMonsterDelegateQt::getCookies(quint64 callbackId, const QUrl &url)
+{
+    Q_ASSERT(hasCookieMonster());
+    Q_ASSERT(m_client);
+
+    net::CookieMonster::GetCookieListCallback callback = base::Bind(&onGetCookiesCallback, m_client->d_func(), callbackId);
+
+    if (url.isEmpty())
+        content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                         base::Bind(&CookieMonsterDelegateQt::GetAllCookiesOnIOThread, this, callback));
+    else
+        content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                         base::Bind(&CookieMonsterDelegateQt::GetCookiesOnIOThread, this, toGurl(url).host(), callback));
+}
+
+// Keeps the cookies that are set for the host or one of its parent domains, whatever their
+// path, Secure or SameSite attributes.
+static void filterCookiesForHost(const std::string &host, const net::CookieMonster::GetCookieListCallback &callback, const net::CookieList &cookies)
+{
+    net::CookieList result;
+    for (const net::CanonicalCookie &cookie : cookies) {
+        if (cookie.IsDomainMatch(host))
+            result.push_back(cookie);
+    }
+    callback.Run(result);
+}
+
+void CookieMonsterDelegateQt::GetCookiesOnIOThread(const std::string& host, const net::CookieMonster::GetCookieListCallback& callback)
+{
+    if (m_cookieMonster)
+        m_cookieMonster->GetAllCookiesAsync(base::Bind(&filterCookiesForHost, host, callback));
+}
+
 void CookieMonsterDelegateQt::setCookie(quint64 callbackId, const QNetworkCookie &cookie, const QUrl &origin)
 {
     Q_ASSERT(hasCookieMonster());
@@ -132,6 +231,59 @@ void CookieMonsterDelegateQt::SetCookieOnIOThread(
         m_cookieMonster->SetCookieWithOptionsAsync(url, cookie_line, options, callback);
 }
 
+void CookieMonsterDelegateQt::setCookies(quint64 callbackId, const QList<QNetworkCookie> &cookies)
+{
+    Q_ASSERT(hasCookieMonster());
+    Q_ASSERT(m_client);
+
+    // Cookies without a domain have no scope.
+    QList<QNetworkCookie> scopedCookies;
+    scopedCookies.reserve(cookies.size());
+    for (const QNetworkCookie &cookie : cookies) {
+        if (!cookie.domain().isEmpty())
+            scopedCookies.append(cookie);
+    }
+
+    content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                     base::Bind(&CookieMonsterDelegateQt::SetCookiesOnIOThread, this,
+                                                callbackId, scopedCookies));
+}
+
+void CookieMonsterDelegateQt::SetCookiesOnIOThread(quint64 callbackId, const QList<QNetworkCookie> &cookies)
+{
+    QWebEngineCookieStorePrivate *client = m_client ? m_client->d_func() : nullptr;
+    const bool wantsResult = client && callbackId != CallbackDirectory::NoCallbackId;
+
+    if (!m_cookieMonster || cookies.isEmpty()) {
+        if (wantsResult)
+            SetCookiesBatch::reply(client, callbackId, 0);
+        return;
+    }
+
+    net::CookieMonster::SetCookiesCallback callback;
+    if (wantsResult) {
+        scoped_refptr<SetCookiesBatch> batch(new SetCookiesBatch(client, callbackId, cookies.size()));
+        callback = base::Bind(&SetCookiesBatch::onSetCookie, batch);
+    }
+
+    // The cookies are created from their fields, without formatting and parsing a cookie line.
+    for (const QNetworkCookie &cookie : cookies) {
+        const QByteArray name = cookie.name();
+        const QByteArray value = cookie.value();
+        const std::string path = cookie.path().isEmpty() ? std::string("/") : cookie.path().toStdString();
+        const base::Time expiration = cookie.isSessionCookie() ? base::Time() : toTime(cookie.expirationDate());
+        m_cookieMonster->SetCookieWithDetailsAsync(sourceUrlForCookie(cookie),
+                                                   std::string(name.constData(), name.size()),
+                                                   std::string(value.constData(), value.size()),
+                                                   cookie.domain().toStdString(), path,
+                                                   base::Time(), expiration, base::Time(),
+                                                   cookie.isSecure(), cookie.isHttpOnly(),
+                                                   net::CookieSameSite::NO_RESTRICTION,
+                                                   /* enforce_strict_secure */ false,
+                                                   net::COOKIE_PRIORITY_DEFAULT, callback);
+    }
+}
+
 void CookieMonsterDelegateQt::deleteCookie(const QNetworkCookie &cookie, const QUrl &origin)
 {
     Q_ASSERT(hasCookieMonster());
@@ -206,6 +358,7 @@ void CookieMonsterDelegateQt::setClient(QWebEngineCookieStore *client)
         return;
 
     m_client->d_func()->delegate = this;
+    setCookieChangeFilter(m_client->d_func()->m_changeFilterDomains, m_client->d_func()->m_changeFilterNames);
 
     if (hasCookieMonster())
         m_client->d_func()->processPendingUserCookies();
@@ -217,11 +370,102 @@ bool CookieMonsterDelegateQt::canSetCookie(const QUrl &firstPartyUrl, const QByt
     return true;
 }
 
+void CookieMonsterDelegateQt::setCookieChangeFilter(const QStringList &domains, const QStringList &names)
+{
+    std::vector<std::string> domainFilter;
+    for (const QString &domain : domains)
+        domainFilter.push_back(normalizedCookieDomain(domain));
+
+    std::vector<std::string> nameFilter;
+    for (const QString &name : names)
+        nameFilter.push_back(name.toStdString());
+
+    content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                     base::Bind(&CookieMonsterDelegateQt::SetCookieChangeFilterOnIOThread, this,
+                                                base::Passed(&domainFilter), base::Passed(&nameFilter)));
+}
+
+void CookieMonsterDelegateQt::SetCookieChangeFilterOnIOThread(std::vector<std::string> domains, std::vector<std::string> names)
+{
+    m_changeFilterDomains = std::move(domains);
+    m_changeFilterNames = std::move(names);
+}
+
+bool CookieMonsterDelegateQt::MatchesCookieChangeFilter(const net::CanonicalCookie& cookie) const
+{
+    if (!m_changeFilterNames.empty()
+            && std::find(m_changeFilterNames.begin(), m_changeFilterNames.end(), cookie.Name()) == m_changeFilterNames.end())
+        return false;
+
+    if (m_changeFilterDomains.empty())
+        return true;
+
+    for (const std::string &domain : m_changeFilterDomains) {
+        if (cookieDomainMatches(cookie.Domain(), domain))
+            return true;
+    }
+    return false;
+}
+
 void CookieMonsterDelegateQt::OnCookieChanged(const net::CanonicalCookie& cookie, bool removed, net::CookieStore::ChangeCause cause)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    if (!m_client || !MatchesCookieChangeFilter(cookie))
+        return;
+
+    // Only the latest change of a cookie within one flush interval is delivered, so that
+    // an overwrite does not cost more than a single notification. A cookie that is added
+    // and removed again within the interval is not reported at all.
+    const std::string key = cookie.Domain() + '\n' + cookie.Path() + '\n' + cookie.Name();
+    auto it = m_pendingCookieStates.find(key);
+    if (it == m_pendingCookieStates.end()) {
+        PendingCookieState state = { m_pendingCookieChanges.size(), removed };
+        m_pendingCookieStates.insert(std::make_pair(key, state));
+        m_pendingCookieChanges.push_back(PendingCookieChange(cookie, removed));
+    } else {
+        PendingCookieState &state = it->second;
+        m_pendingCookieChanges[state.index].superseded = true;
+        if (removed && !state.existedBefore) {
+            m_pendingCookieStates.erase(it);
+        } else {
+            // The change moves to the end, so that the changes keep the order they were made in.
+            state.index = m_pendingCookieChanges.size();
+            m_pendingCookieChanges.push_back(PendingCookieChange(cookie, removed));
+        }
+    }
+
+    if (m_cookieChangeFlushPending)
+        return;
+    m_cookieChangeFlushPending = true;
+    content::BrowserThread::PostDelayedTask(content::BrowserThread::IO, FROM_HERE,
+                                            base::Bind(&CookieMonsterDelegateQt::FlushCookieChangesOnIOThread, this),
+                                            base::TimeDelta::FromMilliseconds(kCookieChangeFlushIntervalMs));
+}
+
+void CookieMonsterDelegateQt::FlushCookieChangesOnIOThread()
+{
+    m_cookieChangeFlushPending = false;
+
+    QVector<QPair<QNetworkCookie, bool>> changes;
+    changes.reserve(m_pendingCookieStates.size());
+    for (const PendingCookieChange &change : m_pendingCookieChanges) {
+        if (!change.superseded)
+            changes.append(qMakePair(toQt(change.cookie), change.removed));
+    }
+    m_pendingCookieChanges.clear();
+    m_pendingCookieStates.clear();
+    if (changes.isEmpty())
+        return;
+
+    content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
+                                     base::Bind(&CookieMonsterDelegateQt::deliverCookieChanges, this, changes));
+}
+
+void CookieMonsterDelegateQt::deliverCookieChanges(const QVector<QPair<QNetworkCookie, bool>> &changes)
 {
     if (!m_client)
         return;
-    m_client->d_func()->onCookieChanged(toQt(cookie), removed);
+    m_client->d_func()->onCookiesChanged(changes);
 }
 
 }
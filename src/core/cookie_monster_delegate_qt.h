@@ -50,8 +50,15 @@ QT_WARNING_DISABLE_CLANG("-Wunused-parameter")
 #include "net/cookies/cookie_monster.h"
 QT_WARNING_POP
 
+#include <QList>
 #include <QNetworkCookie>
 #include <QPointer>
+#include <QStringList>
+#include <QVector>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 QT_FORWARD_DECLARE_CLASS(QWebEngineCookieStore)
 
@@ -64,9 +71,34 @@ namespace QtWebEngineCore {
 static const char* const kCookieableSchemes[] =
     { "http", "https", "qrc", "ws", "wss" };
 
+// Cookie changes are collected on the IO thread and delivered to the UI thread at most
+// once per interval.
+static const int kCookieChangeFlushIntervalMs = 50;
+
 class QWEBENGINE_EXPORT CookieMonsterDelegateQt: public net::CookieMonsterDelegate {
+    struct PendingCookieChange {
+        PendingCookieChange(const net::CanonicalCookie &cookie, bool removed)
+            : cookie(cookie), removed(removed), superseded(false) { }
+        net::CanonicalCookie cookie;
+        bool removed;
+        bool superseded;
+    };
+    struct PendingCookieState {
+        size_t index;
+        // Whether the cookie existed before the first pending change, that is if the
+        // client has seen it being added.
+        bool existedBefore;
+    };
+
     QPointer<QWebEngineCookieStore> m_client;
     net::CookieMonster *m_cookieMonster;
+
+    // Only accessed on the IO thread.
+    std::vector<std::string> m_changeFilterDomains;
+    std::vector<std::string> m_changeFilterNames;
+    std::vector<PendingCookieChange> m_pendingCookieChanges;
+    std::unordered_map<std::string, PendingCookieState> m_pendingCookieStates;
+    bool m_cookieChangeFlushPending;
 public:
     CookieMonsterDelegateQt();
     ~CookieMonsterDelegateQt();
@@ -75,10 +107,14 @@ public:
 
     void setCookie(quint64 callbackId, const QNetworkCookie &cookie, const QUrl &origin);
     void deleteCookie(const QNetworkCookie &cookie, const QUrl &origin);
+    void setCookies(quint64 callbackId, const QList<QNetworkCookie> &cookies);
     void getAllCookies(quint64 callbackId);
+    void getCookies(quint64 callbackId, const QUrl &url);
     void deleteSessionCookies(quint64 callbackId);
     void deleteAllCookies(quint64 callbackId);
 
+    void setCookieChangeFilter(const QStringList &domains, const QStringList &names);
+
     void setCookieMonster(net::CookieMonster* monster);
     void setClient(QWebEngineCookieStore *client);
 
@@ -87,10 +123,16 @@ public:
 
 private:
     void GetAllCookiesOnIOThread(const net::CookieMonster::GetCookieListCallback& callback);
+    void GetCookiesOnIOThread(const std::string& host, const net::CookieMonster::GetCookieListCallback& callback);
     void SetCookieOnIOThread(const GURL& url, const std::string& cookie_line, const net::CookieMonster::SetCookiesCallback& callback);
+    void SetCookiesOnIOThread(quint64 callbackId, const QList<QNetworkCookie> &cookies);
     void DeleteCookieOnIOThread(const GURL& url, const std::string& cookie_name);
     void DeleteSessionCookiesOnIOThread(const net::CookieMonster::DeleteCallback& callback);
     void DeleteAllOnIOThread(const net::CookieMonster::DeleteCallback& callback);
+    void SetCookieChangeFilterOnIOThread(std::vector<std::string> domains, std::vector<std::string> names);
+    bool MatchesCookieChangeFilter(const net::CanonicalCookie& cookie) const;
+    void FlushCookieChangesOnIOThread();
+    void deliverCookieChanges(const QVector<QPair<QNetworkCookie, bool>> &changes);
 };
 
 }
@@ -57,6 +57,7 @@ SOURCES = \
         color_chooser_controller.cpp \
         common/qt_ipc_logging.cpp \
         common/qt_messages.cpp \
+        common/qt_param_traits.cpp \
         common/user_script_data.cpp \
         content_client_qt.cpp \
         content_browser_client_qt.cpp \
@@ -69,6 +70,7 @@ SOURCES = \
         download_manager_delegate_qt.cpp \
         favicon_manager.cpp \
         file_picker_controller.cpp \
+        frame_timing_recorder.cpp \
         gl_context_qt.cpp \
         gl_surface_qt.cpp \
         javascript_dialog_controller.cpp \
@@ -87,12 +89,14 @@ SOURCES = \
         renderer/render_frame_observer_qt.cpp \
         renderer/render_view_observer_qt.cpp \
         renderer/user_resource_controller.cpp \
+        renderer/v8_json_conversion.cpp \
         renderer/web_channel_ipc_transport.cpp \
         renderer_host/resource_dispatcher_host_delegate_qt.cpp \
         renderer_host/user_resource_controller_host.cpp \
         renderer_host/web_channel_ipc_transport_host.cpp \
         resource_bundle_qt.cpp \
         resource_context_qt.cpp \
+        spare_renderer_pool_qt.cpp \
         ssl_host_state_delegate_qt.cpp \
         surface_factory_qt.cpp \
         type_conversion.cpp \
@@ -129,6 +133,7 @@ HEADERS = \
         color_chooser_controller_p.h \
         color_chooser_controller.h \
         common/qt_messages.h \
+        common/qt_param_traits.h \
         common/user_script_data.h \
         content_client_qt.h \
         content_browser_client_qt.h \
@@ -143,6 +148,7 @@ HEADERS = \
         favicon_manager_p.h \
         favicon_manager.h \
         file_picker_controller.h \
+        frame_timing_recorder.h \
         gl_context_qt.h \
         gl_surface_qt.h \
         global_descriptors_qt.h \
@@ -163,11 +169,13 @@ HEADERS = \
         renderer/render_frame_observer_qt.h \
         renderer/render_view_observer_qt.h \
         renderer/user_resource_controller.h \
+        renderer/v8_json_conversion.h \
         renderer/web_channel_ipc_transport.h \
         renderer_host/resource_dispatcher_host_delegate_qt.h \
         renderer_host/user_resource_controller_host.h \
         renderer_host/web_channel_ipc_transport_host.h \
         resource_context_qt.h \
+        spare_renderer_pool_qt.h \
         ssl_host_state_delegate_qt.h \
         surface_factory_qt.h \
         type_conversion.h \
@@ -213,12 +221,14 @@ use?(pepper_plugins) {
 use?(printing) {
     SOURCES += \
         printing_message_filter_qt.cpp \
+        print_job_scheduler_qt.cpp \
         print_view_manager_base_qt.cpp \
         print_view_manager_qt.cpp \
         renderer/print_web_view_helper_delegate_qt.cpp
 
     HEADERS += \
         printing_message_filter_qt.h \
+        print_job_scheduler_qt.h \
         print_view_manager_base_qt.h \
         print_view_manager_qt.h \
         renderer/print_web_view_helper_delegate_qt.h
@@ -49,6 +49,7 @@
 #include "delegated_frame_node.h"
 
 #include "chromium_gpu_helper.h"
+#include "frame_timing_recorder.h"
 #include "gl_surface_qt.h"
 #include "stream_video_node.h"
 #include "type_conversion.h"
@@ -57,6 +58,7 @@
 #include "base/bind.h"
 #include "base/message_loop/message_loop.h"
 #include "base/threading/thread_task_runner_handle.h"
+#include "cc/base/math_util.h"
 #include "cc/output/delegated_frame_data.h"
 #include "cc/quads/debug_border_draw_quad.h"
 #include "cc/quads/draw_quad.h"
@@ -70,9 +72,12 @@
 #include "cc/resources/transferable_resource.h"
 #include "content/common/host_shared_bitmap_manager.h"
 #include "gpu/command_buffer/service/mailbox_manager.h"
+#include "ui/gfx/geometry/rect_conversions.h"
 #include "ui/gl/gl_context.h"
 #include "ui/gl/gl_fence.h"
 
+#include <algorithm>
+
 #ifndef QT_NO_OPENGL
 # include <QOpenGLContext>
 # include <QOpenGLFunctions>
@@ -81,6 +86,14 @@
 #include <QSGTexture>
 #include <private/qsgadaptationlayer_p.h>
 
+#if defined(USE_X11) && !defined(QT_NO_OPENGL)
+# include <QOffscreenSurface>
+# include <QOpenGLExtraFunctions>
+# if !defined(QT_NO_EGL)
+#  include <QtPlatformHeaders/QEGLNativeContext>
+# endif
+#endif
+
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 8, 0))
 #include <QSGImageNode>
 #include <QSGRectangleNode>
@@ -106,6 +119,18 @@
 #define GL_LINEAR                         0x2601
 #endif
 
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER              0x88EB
+#endif
+
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ                    0x88E1
+#endif
+
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT                   0x0001
+#endif
+
 #ifndef GL_RGBA
 #define GL_RGBA                           0x1908
 #endif
@@ -114,6 +139,14 @@
 #define GL_RGB                            0x1907
 #endif
 
+#ifndef GL_BGRA
+#define GL_BGRA                           0x80E1
+#endif
+
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH              0x0CF2
+#endif
+
 #ifndef GL_LINE_LOOP
 #define GL_LINE_LOOP                      0x0002
 #endif
@@ -148,12 +181,49 @@ private:
     EGLStreamData m_eglStreamData;
 #endif
     friend class DelegatedFrameNode;
+#if defined(USE_X11)
+    friend class CrossContextTextureImporter;
+#endif
+};
+
+// Texture for a software compositor tile that lives as long as the tile keeps its place
+// on screen. The bitmaps of the following resources at the same place only get their
+// damaged part uploaded.
+class SoftwareTileTexture : public QSGTexture, protected QOpenGLFunctions {
+public:
+    SoftwareTileTexture(const QSize &textureSize, bool hasAlpha);
+    ~SoftwareTileTexture();
+    virtual int textureId() const Q_DECL_OVERRIDE { return m_textureId; }
+    virtual QSize textureSize() const Q_DECL_OVERRIDE { return m_textureSize; }
+    virtual bool hasAlphaChannel() const Q_DECL_OVERRIDE { return m_hasAlpha; }
+    virtual bool hasMipmaps() const Q_DECL_OVERRIDE { return false; }
+    virtual void bind() Q_DECL_OVERRIDE;
+
+    // The dirty rect is uploaded from image on the next bind, it accumulates until then.
+    void setImage(const QImage &image, const QRect &dirtyRect);
+    // The part of the texture that bind() uploads for dirtyRect.
+    QRect uploadRect(const QRect &dirtyRect) const;
+    // Whether the pixels have to be converted to RGBA before being uploaded.
+    bool convertsPixels() const { return m_uploadFormat != GL_BGRA; }
+
+private:
+    GLuint m_textureId;
+    QSize m_textureSize;
+    bool m_hasAlpha;
+    bool m_allocated;
+    GLenum m_internalFormat;
+    GLenum m_uploadFormat;
+    bool m_unpackRowLength;
+    QImage m_pendingImage;
+    QRect m_dirtyRect;
 };
 #endif // QT_NO_OPENGL
 class ResourceHolder {
 public:
     ResourceHolder(const cc::TransferableResource &resource);
     QSharedPointer<QSGTexture> initTexture(bool quadIsAllOpaque, RenderWidgetHostViewQtDelegate *apiDelegate = 0);
+    void adoptTexture(const QSharedPointer<QSGTexture> &texture, bool quadNeedsBlending);
+    void adoptSoftwareTexture(const QSharedPointer<QSGTexture> &texture);
     QSGTexture *texture() const { return m_texture.data(); }
     cc::TransferableResource &transferableResource() { return m_resource; }
     cc::ReturnedResource returnResource();
@@ -170,10 +240,60 @@ class RectClipNode : public QSGClipNode
 {
 public:
     RectClipNode(const QRectF &);
+    void setRect(const QRectF &);
 private:
     QSGGeometry m_geometry;
 };
 
+// Keeps the nodes released by a commit to be recycled by the next ones instead of
+// going through the allocator. Only used from the scene graph render thread.
+class DelegatedNodePool
+{
+public:
+    enum NodeKind {
+        ClipNode,
+        TransformNode,
+        OpacityNode,
+        ImageNode,
+        TextureNode,
+        RectangleNode,
+        DebugBorderNode,
+        NodeKindCount
+    };
+
+    DelegatedNodePool();
+    ~DelegatedNodePool();
+
+    QSGNode *take(NodeKind kind);
+    // Takes ownership of node, it must not have any child left.
+    void release(QSGNode *node, NodeKind kind);
+    // Trims the pool to the peak number of nodes used by recent frames.
+    void endFrame(int nodeCount);
+    NodePoolStats stats() const;
+
+private:
+    QVector<QSGNode *> m_freeNodes[NodeKindCount];
+    // Ring buffer of the node count of recent frames.
+    QVector<int> m_recentNodeCounts;
+    int m_recentNodeCountsIndex;
+    int m_capacity;
+    quint64 m_hits;
+    quint64 m_misses;
+};
+
+static void updateDebugBorderGeometry(QSGGeometry *geometry, const QRect &r, float lineWidth)
+{
+    geometry->setLineWidth(lineWidth);
+    // QSGGeometry::updateRectGeometry would actually set the
+    // corners in the following order:
+    // top-left, bottom-left, top-right, bottom-right, leading to a nice criss cross,
+    // instead of having a closed loop.
+    geometry->vertexDataAsPoint2D()[0].set(r.x(), r.y());
+    geometry->vertexDataAsPoint2D()[1].set(r.x() + r.width(), r.y());
+    geometry->vertexDataAsPoint2D()[2].set(r.x() + r.width(), r.y() + r.height());
+    geometry->vertexDataAsPoint2D()[3].set(r.x(), r.y() + r.height());
+}
+
 class DelegatedNodeTreeHandler
 {
 public:
@@ -192,7 +312,7 @@ public:
     virtual void setupTiledContentNode(QSGTexture *, const QRect &, const QRectF &,
                                        QSGTexture::Filtering, QSGNode *) = 0;
     virtual void setupSolidColorNode(const QRect &, const QColor &, QSGNode *) = 0;
-    virtual void setupDebugBorderNode(QSGGeometry *, QSGFlatColorMaterial *, QSGNode *) = 0;
+    virtual void setupDebugBorderNode(const QRect &, const QColor &, float, QSGNode *) = 0;
 
 #ifndef QT_NO_OPENGL
     virtual void setupYUVVideoNode(QSGTexture *, QSGTexture *, QSGTexture *, QSGTexture *,
@@ -217,6 +337,13 @@ public:
     {
     }
 
+    // Updates the nodes starting at nodeIterator without going through the whole vector.
+    explicit DelegatedNodeTreeUpdater(QVector<QSGNode*>::iterator nodeIterator)
+        : DelegatedNodeTreeHandler(nullptr)
+        , m_nodeIterator(nodeIterator)
+    {
+    }
+
     void setupRenderPassNode(QSGTexture *layer, const QRect &rect, QSGNode *) Q_DECL_OVERRIDE
     {
         QSGInternalImageNode *imageNode = static_cast<QSGInternalImageNode*>(*m_nodeIterator++);
@@ -274,13 +401,19 @@ public:
              rectangleNode->setColor(color);
     }
 
-    void setupDebugBorderNode(QSGGeometry *geometry, QSGFlatColorMaterial *material,
+    void setupDebugBorderNode(const QRect &rect, const QColor &color, float lineWidth,
                               QSGNode *) Q_DECL_OVERRIDE
     {
         QSGGeometryNode *geometryNode = static_cast<QSGGeometryNode*>(*m_nodeIterator++);
 
-        geometryNode->setGeometry(geometry);
-        geometryNode->setMaterial(material);
+        // Update the geometry and material in place, they are owned by the node.
+        updateDebugBorderGeometry(geometryNode->geometry(), rect, lineWidth);
+        geometryNode->markDirty(QSGNode::DirtyGeometry);
+        QSGFlatColorMaterial *material = static_cast<QSGFlatColorMaterial *>(geometryNode->material());
+        if (material->color() != color) {
+            material->setColor(color);
+            geometryNode->markDirty(QSGNode::DirtyMaterial);
+        }
     }
 #ifndef QT_NO_OPENGL
     void setupYUVVideoNode(QSGTexture *, QSGTexture *, QSGTexture *, QSGTexture *,
@@ -307,15 +440,31 @@ class DelegatedNodeTreeCreator : public DelegatedNodeTreeHandler
 {
 public:
     DelegatedNodeTreeCreator(QVector<QSGNode*> *sceneGraphNodes,
-                             RenderWidgetHostViewQtDelegate *apiDelegate)
+                             RenderWidgetHostViewQtDelegate *apiDelegate,
+                             DelegatedNodePool *nodePool,
+                             QMultiHash<QuadKey, QSGNode**> *reusableNodes = nullptr)
         : DelegatedNodeTreeHandler(sceneGraphNodes)
         , m_apiDelegate(apiDelegate)
+        , m_nodePool(nodePool)
+        , m_reusableNodes(reusableNodes)
+        , m_createdNodeCount(0)
+        , m_reusedNodeCount(0)
     {
     }
 
+    // The key of the next quad, used to pick one of the reusable nodes instead of creating one.
+    void setQuadKey(const QuadKey &key) { m_quadKey = key; }
+    int createdNodeCount() const { return m_createdNodeCount; }
+    int reusedNodeCount() const { return m_reusedNodeCount; }
+
     void setupRenderPassNode(QSGTexture *layer, const QRect &rect,
                              QSGNode *layerChain) Q_DECL_OVERRIDE
     {
+        if (reuseNode(layerChain) || reusePooledNode(DelegatedNodePool::ImageNode, layerChain)) {
+            DelegatedNodeTreeUpdater(m_sceneGraphNodes->end() - 1).setupRenderPassNode(layer, rect, layerChain);
+            return;
+        }
+        ++m_createdNodeCount;
         // Only QSGInternalImageNode currently supports QSGLayer textures.
         QSGInternalImageNode *imageNode = m_apiDelegate->createImageNode();
         layerChain->appendChildNode(imageNode);
@@ -340,6 +489,12 @@ public:
                                  QSGTextureNode::TextureCoordinatesTransformMode texCoordTransForm,
                                  QSGNode *layerChain) Q_DECL_OVERRIDE
     {
+        if (reuseNode(layerChain) || reusePooledNode(DelegatedNodePool::TextureNode, layerChain)) {
+            DelegatedNodeTreeUpdater(m_sceneGraphNodes->end() - 1).setupTextureContentNode(
+                        texture, rect, sourceRect, filtering, texCoordTransForm, layerChain);
+            return;
+        }
+        ++m_createdNodeCount;
         QSGTextureNode *textureNode = m_apiDelegate->createTextureNode();
         textureNode->setTextureCoordinatesTransform(texCoordTransForm);
         textureNode->setRect(rect);
@@ -355,6 +510,16 @@ public:
                                QSGTexture::Filtering filtering,
                                QSGNode *layerChain) Q_DECL_OVERRIDE
     {
+        if (reuseNode(layerChain) || reusePooledNode(DelegatedNodePool::TextureNode, layerChain)) {
+            // Pooled nodes might come from a texture quad, reset what tiled quads don't set.
+            QSGTextureNode *textureNode = static_cast<QSGTextureNode *>(m_sceneGraphNodes->last());
+            if (textureNode->textureCoordinatesTransform() != QSGTextureNode::NoTransform)
+                textureNode->setTextureCoordinatesTransform(QSGTextureNode::NoTransform);
+            DelegatedNodeTreeUpdater(m_sceneGraphNodes->end() - 1).setupTiledContentNode(
+                        texture, rect, sourceRect, filtering, layerChain);
+            return;
+        }
+        ++m_createdNodeCount;
         QSGTextureNode *textureNode = m_apiDelegate->createTextureNode();
         textureNode->setRect(rect);
         textureNode->setSourceRect(sourceRect);
@@ -368,6 +533,11 @@ public:
     void setupSolidColorNode(const QRect &rect, const QColor &color,
                              QSGNode *layerChain) Q_DECL_OVERRIDE
     {
+        if (reuseNode(layerChain) || reusePooledNode(DelegatedNodePool::RectangleNode, layerChain)) {
+            DelegatedNodeTreeUpdater(m_sceneGraphNodes->end() - 1).setupSolidColorNode(rect, color, layerChain);
+            return;
+        }
+        ++m_createdNodeCount;
         QSGRectangleNode *rectangleNode = m_apiDelegate->createRectangleNode();
         rectangleNode->setRect(rect);
         rectangleNode->setColor(color);
@@ -376,9 +546,20 @@ public:
         m_sceneGraphNodes->append(rectangleNode);
     }
 
-    void setupDebugBorderNode(QSGGeometry *geometry, QSGFlatColorMaterial *material,
+    void setupDebugBorderNode(const QRect &rect, const QColor &color, float lineWidth,
                               QSGNode *layerChain) Q_DECL_OVERRIDE
     {
+        if (reuseNode(layerChain) || reusePooledNode(DelegatedNodePool::DebugBorderNode, layerChain)) {
+            DelegatedNodeTreeUpdater(m_sceneGraphNodes->end() - 1).setupDebugBorderNode(rect, color, lineWidth, layerChain);
+            return;
+        }
+        ++m_createdNodeCount;
+        QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 4);
+        geometry->setDrawingMode(GL_LINE_LOOP);
+        updateDebugBorderGeometry(geometry, rect, lineWidth);
+        QSGFlatColorMaterial *material = new QSGFlatColorMaterial;
+        material->setColor(color);
+
         QSGGeometryNode *geometryNode = new QSGGeometryNode;
         geometryNode->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
 
@@ -397,6 +578,7 @@ public:
                            float rMul, float rOff, const QRectF &rect,
                            QSGNode *layerChain) Q_DECL_OVERRIDE
     {
+        ++m_createdNodeCount;
         YUVVideoNode *videoNode = new YUVVideoNode(
                     yTexture,
                     uTexture,
@@ -418,6 +600,7 @@ public:
     void setupStreamVideoNode(MailboxTexture *texture, const QRectF &rect,
                               const QMatrix4x4 &textureMatrix, QSGNode *layerChain) Q_DECL_OVERRIDE
     {
+        ++m_createdNodeCount;
         StreamVideoNode *svideoNode = new StreamVideoNode(texture, false, ExternalTarget);
         svideoNode->setRect(rect);
         svideoNode->setTextureMatrix(textureMatrix);
@@ -428,7 +611,45 @@ public:
 #endif // QT_NO_OPENGL
 
 private:
+    // Moves a node left by a quad with the same key in the previous frame into layerChain.
+    bool reuseNode(QSGNode *layerChain)
+    {
+        if (!m_reusableNodes)
+            return false;
+        QMultiHash<QuadKey, QSGNode**>::iterator it = m_reusableNodes->find(m_quadKey);
+        if (it == m_reusableNodes->end())
+            return false;
+        QSGNode *node = **it;
+        // Clear the slot in the previous layer chain so that it doesn't get deleted with it.
+        **it = nullptr;
+        m_reusableNodes->erase(it);
+
+        if (node->parent())
+            node->parent()->removeChildNode(node);
+        layerChain->appendChildNode(node);
+        m_sceneGraphNodes->append(node);
+        ++m_reusedNodeCount;
+        return true;
+    }
+
+    // Moves a node of the given kind released by a previous commit into layerChain.
+    bool reusePooledNode(DelegatedNodePool::NodeKind kind, QSGNode *layerChain)
+    {
+        QSGNode *node = m_nodePool->take(kind);
+        if (!node)
+            return false;
+        layerChain->appendChildNode(node);
+        m_sceneGraphNodes->append(node);
+        ++m_reusedNodeCount;
+        return true;
+    }
+
     RenderWidgetHostViewQtDelegate *m_apiDelegate;
+    DelegatedNodePool *m_nodePool;
+    QMultiHash<QuadKey, QSGNode**> *m_reusableNodes;
+    QuadKey m_quadKey;
+    int m_createdNodeCount;
+    int m_reusedNodeCount;
 };
 
 
@@ -458,29 +679,6 @@ static QSGNode *buildRenderPassChain(QSGNode *chainParent)
     return zCompressNode;
 }
 
-static QSGNode *buildLayerChain(QSGNode *chainParent, const cc::SharedQuadState *layerState)
-{
-    QSGNode *layerChain = chainParent;
-    if (layerState->is_clipped) {
-        RectClipNode *clipNode = new RectClipNode(toQt(layerState->clip_rect));
-        layerChain->appendChildNode(clipNode);
-        layerChain = clipNode;
-    }
-    if (!layerState->quad_to_target_transform.IsIdentity()) {
-        QSGTransformNode *transformNode = new QSGTransformNode;
-        transformNode->setMatrix(toQt(layerState->quad_to_target_transform.matrix()));
-        layerChain->appendChildNode(transformNode);
-        layerChain = transformNode;
-    }
-    if (layerState->opacity < 1.0) {
-        QSGOpacityNode *opacityNode = new QSGOpacityNode;
-        opacityNode->setOpacity(layerState->opacity);
-        layerChain->appendChildNode(opacityNode);
-        layerChain = opacityNode;
-    }
-    return layerChain;
-}
-
 #ifndef QT_NO_OPENGL
 static void waitChromiumSync(gl::TransferableFence *sync)
 {
@@ -622,6 +820,94 @@ void MailboxTexture::bind()
 #endif
 }
 
+SoftwareTileTexture::SoftwareTileTexture(const QSize &textureSize, bool hasAlpha)
+    : m_textureId(0)
+    , m_textureSize(textureSize)
+    , m_hasAlpha(hasAlpha)
+    , m_allocated(false)
+    , m_internalFormat(GL_RGBA)
+    , m_uploadFormat(GL_RGBA)
+    , m_unpackRowLength(false)
+{
+    initializeOpenGLFunctions();
+    glGenTextures(1, &m_textureId);
+
+    // The shared bitmaps are BGRA in memory on little endian machines and can be
+    // uploaded as they are where GL accepts that format.
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) {
+        if (!context->isOpenGLES()) {
+            m_uploadFormat = GL_BGRA;
+        } else if (context->hasExtension(QByteArrayLiteral("GL_EXT_texture_format_BGRA8888"))) {
+            m_internalFormat = GL_BGRA;
+            m_uploadFormat = GL_BGRA;
+        }
+    }
+    m_unpackRowLength = !context->isOpenGLES() || context->format().majorVersion() >= 3
+            || context->hasExtension(QByteArrayLiteral("GL_EXT_unpack_subimage"));
+}
+
+SoftwareTileTexture::~SoftwareTileTexture()
+{
+    // The scene graph destroys textures on the render thread with its context current.
+    if (QOpenGLContext::currentContext())
+        glDeleteTextures(1, &m_textureId);
+}
+
+void SoftwareTileTexture::setImage(const QImage &image, const QRect &dirtyRect)
+{
+    m_pendingImage = image;
+    m_dirtyRect |= dirtyRect;
+}
+
+void SoftwareTileTexture::bind()
+{
+    glBindTexture(GL_TEXTURE_2D, m_textureId);
+    updateBindOptions(!m_allocated);
+    if (m_pendingImage.isNull())
+        return;
+
+    const QRect rect = uploadRect(m_allocated ? m_dirtyRect : QRect(QPoint(), m_textureSize));
+    if (!rect.isEmpty()) {
+        // Only the dirty part of the shared bitmap gets uploaded.
+        const uchar *dirtyBits = m_pendingImage.constScanLine(rect.y()) + rect.x() * 4;
+        const bool partialRows = rect.width() != m_pendingImage.width();
+        QImage pixels;
+        if (convertsPixels()) {
+            const QImage dirtyPart(dirtyBits, rect.width(), rect.height(), m_pendingImage.bytesPerLine(),
+                                   m_pendingImage.format());
+            pixels = dirtyPart.convertToFormat(m_hasAlpha ? QImage::Format_RGBA8888_Premultiplied
+                                                          : QImage::Format_RGBX8888);
+            dirtyBits = pixels.constBits();
+        } else if (partialRows) {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, m_pendingImage.bytesPerLine() / 4);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (m_allocated) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                            m_uploadFormat, GL_UNSIGNED_BYTE, dirtyBits);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, 0, m_internalFormat, rect.width(), rect.height(), 0,
+                         m_uploadFormat, GL_UNSIGNED_BYTE, dirtyBits);
+            m_allocated = true;
+        }
+        if (!convertsPixels() && partialRows)
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+    // Release the shared bitmap.
+    m_pendingImage = QImage();
+    m_dirtyRect = QRect();
+}
+
+QRect SoftwareTileTexture::uploadRect(const QRect &dirtyRect) const
+{
+    const QRect rect = dirtyRect & QRect(QPoint(), m_textureSize);
+    // Without a row length the unconverted pixels can only be read as whole rows.
+    if (!convertsPixels() && !m_unpackRowLength && rect.width() != m_textureSize.width())
+        return QRect(0, rect.y(), m_textureSize.width(), rect.height());
+    return rect;
+}
+
 void MailboxTexture::setTarget(GLenum target)
 {
     m_target = target;
@@ -641,6 +927,228 @@ void MailboxTexture::fetchTexture(gpu::gles2::MailboxManager *mailboxManager)
 #endif
     }
 }
+
+#if defined(USE_X11)
+// Workaround when context is not shared QTBUG-48969
+// Gives the current context its own texture for each of the mailbox textures, which
+// live in the global share context. Where EGL allows it the texture storage is shared
+// through an EGLImage, otherwise the textures are copied through one framebuffer
+// object and staging buffer reused across frames.
+class CrossContextTextureImporter {
+public:
+    CrossContextTextureImporter(QOpenGLContext *sharedContext);
+    ~CrossContextTextureImporter();
+    void importTextures(const QList<MailboxTexture *> &mailboxes);
+
+private:
+    bool importEGLImage(MailboxTexture *mailbox);
+    void copyTextures(const QList<MailboxTexture *> &mailboxes);
+    static GLuint createTexture(QOpenGLFunctions *funcs);
+
+    QOpenGLContext *m_sharedContext;
+    QOffscreenSurface m_surface;
+    // Owned by the shared context.
+    GLuint m_fbo;
+    GLuint m_pbo;
+    int m_pboSize;
+    bool m_usePbo;
+    QByteArray m_stagingBuffer;
+#if !defined(QT_NO_EGL)
+    typedef EGLImageKHR (EGLAPIENTRYP CreateImageProc)(EGLDisplay, EGLContext, EGLenum, EGLClientBuffer, const EGLint *);
+    typedef EGLBoolean (EGLAPIENTRYP DestroyImageProc)(EGLDisplay, EGLImageKHR);
+    typedef void (QOPENGLF_APIENTRYP ImageTargetTexture2DProc)(GLenum, void *);
+    EGLDisplay m_eglDisplay;
+    EGLContext m_eglContext;
+    CreateImageProc m_eglCreateImage;
+    DestroyImageProc m_eglDestroyImage;
+    ImageTargetTexture2DProc m_eglImageTargetTexture2D;
+#endif
+};
+
+CrossContextTextureImporter::CrossContextTextureImporter(QOpenGLContext *sharedContext)
+    : m_sharedContext(sharedContext)
+    , m_fbo(0)
+    , m_pbo(0)
+    , m_pboSize(0)
+    , m_usePbo(sharedContext->format().version() >= qMakePair(3, 0))
+#if !defined(QT_NO_EGL)
+    , m_eglDisplay(EGL_NO_DISPLAY)
+    , m_eglContext(EGL_NO_CONTEXT)
+    , m_eglCreateImage(0)
+    , m_eglDestroyImage(0)
+    , m_eglImageTargetTexture2D(0)
+#endif
+{
+    m_surface.setFormat(sharedContext->format());
+    m_surface.create();
+
+#if !defined(QT_NO_EGL)
+    QOpenGLContext *currentContext = QOpenGLContext::currentContext();
+    const QVariant nativeHandle = sharedContext->nativeHandle();
+    if (nativeHandle.canConvert<QEGLNativeContext>() && currentContext->hasExtension("GL_OES_EGL_image")) {
+        const QEGLNativeContext eglContext = nativeHandle.value<QEGLNativeContext>();
+        m_eglDisplay = eglContext.display();
+        m_eglContext = eglContext.context();
+        m_eglCreateImage = reinterpret_cast<CreateImageProc>(currentContext->getProcAddress("eglCreateImageKHR"));
+        m_eglDestroyImage = reinterpret_cast<DestroyImageProc>(currentContext->getProcAddress("eglDestroyImageKHR"));
+        m_eglImageTargetTexture2D = reinterpret_cast<ImageTargetTexture2DProc>(currentContext->getProcAddress("glEGLImageTargetTexture2DOES"));
+        if (!m_eglDestroyImage || !m_eglImageTargetTexture2D)
+            m_eglCreateImage = 0;
+    }
+#endif
+}
+
+CrossContextTextureImporter::~CrossContextTextureImporter()
+{
+    if (!m_fbo && !m_pbo)
+        return;
+    QOpenGLContext *currentContext = QOpenGLContext::currentContext();
+    QSurface *surface = currentContext ? currentContext->surface() : 0;
+    m_sharedContext->makeCurrent(&m_surface);
+    QOpenGLFunctions *funcs = m_sharedContext->functions();
+    if (m_fbo)
+        funcs->glDeleteFramebuffers(1, &m_fbo);
+    if (m_pbo)
+        funcs->glDeleteBuffers(1, &m_pbo);
+    if (currentContext)
+        currentContext->makeCurrent(surface);
+    else
+        m_sharedContext->doneCurrent();
+}
+
+void CrossContextTextureImporter::importTextures(const QList<MailboxTexture *> &mailboxes)
+{
+    QList<MailboxTexture *> mailboxesToCopy;
+    Q_FOREACH (MailboxTexture *mailbox, mailboxes) {
+        // The texture might already have been deleted.
+        if (!mailbox->m_textureId)
+            continue;
+        if (!importEGLImage(mailbox))
+            mailboxesToCopy.append(mailbox);
+    }
+    if (!mailboxesToCopy.isEmpty())
+        copyTextures(mailboxesToCopy);
+}
+
+bool CrossContextTextureImporter::importEGLImage(MailboxTexture *mailbox)
+{
+#if !defined(QT_NO_EGL)
+    if (!m_eglCreateImage || mailbox->m_target != GL_TEXTURE_2D)
+        return false;
+
+    const EGLint attribs[] = { EGL_IMAGE_PRESERVED_KHR, EGL_TRUE, EGL_NONE };
+    EGLImageKHR image = m_eglCreateImage(m_eglDisplay, m_eglContext, EGL_GL_TEXTURE_2D_KHR,
+                                         reinterpret_cast<EGLClientBuffer>(quintptr(mailbox->m_textureId)), attribs);
+    if (image == EGL_NO_IMAGE_KHR) {
+        qWarning("Could not share textures through EGLImages, they will be copied between contexts.");
+        m_eglCreateImage = 0;
+        return false;
+    }
+
+    GLuint texture = createTexture(QOpenGLContext::currentContext()->functions());
+    m_eglImageTargetTexture2D(GL_TEXTURE_2D, image);
+    // The texture keeps the storage alive as an EGLImage sibling.
+    m_eglDestroyImage(m_eglDisplay, image);
+    mailbox->m_textureId = texture;
+    mailbox->m_ownsTexture = true;
+    return true;
+#else
+    Q_UNUSED(mailbox);
+    return false;
+#endif
+}
+
+void CrossContextTextureImporter::copyTextures(const QList<MailboxTexture *> &mailboxes)
+{
+    QOpenGLContext *currentContext = QOpenGLContext::currentContext();
+    QSurface *surface = currentContext->surface();
+
+    // Read all textures back in one go from the shared context...
+    m_sharedContext->makeCurrent(&m_surface);
+    QOpenGLFunctions *funcs = m_sharedContext->functions();
+    if (!m_fbo)
+        funcs->glGenFramebuffers(1, &m_fbo);
+    funcs->glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+
+    QVector<int> offsets;
+    offsets.reserve(mailboxes.size());
+    int size = 0;
+    Q_FOREACH (MailboxTexture *mailbox, mailboxes) {
+        offsets.append(size);
+        size += mailbox->textureSize().width() * mailbox->textureSize().height() * 4;
+    }
+
+    if (m_usePbo) {
+        if (!m_pbo)
+            funcs->glGenBuffers(1, &m_pbo);
+        funcs->glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+        if (size > m_pboSize) {
+            funcs->glBufferData(GL_PIXEL_PACK_BUFFER, size, 0, GL_STREAM_READ);
+            m_pboSize = size;
+        }
+    } else if (m_stagingBuffer.size() < size) {
+        m_stagingBuffer.resize(size);
+    }
+
+    for (int i = 0; i < mailboxes.size(); ++i) {
+        MailboxTexture *mailbox = mailboxes.at(i);
+        funcs->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mailbox->m_textureId, 0);
+        if (funcs->glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            qWarning("fbo error, skipping slow copy...");
+            offsets[i] = -1;
+            continue;
+        }
+        void *pixels = m_usePbo ? reinterpret_cast<void *>(quintptr(offsets.at(i)))
+                                : static_cast<void *>(m_stagingBuffer.data() + offsets.at(i));
+        funcs->glReadPixels(0, 0, mailbox->textureSize().width(), mailbox->textureSize().height(),
+                            GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+    funcs->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    funcs->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    const uchar *pixels = 0;
+    if (m_usePbo)
+        pixels = static_cast<const uchar *>(m_sharedContext->extraFunctions()->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+    else
+        pixels = reinterpret_cast<const uchar *>(m_stagingBuffer.constData());
+
+    // ...and upload them in one go to the current context.
+    currentContext->makeCurrent(surface);
+    if (pixels) {
+        funcs = currentContext->functions();
+        for (int i = 0; i < mailboxes.size(); ++i) {
+            if (offsets.at(i) < 0)
+                continue;
+            MailboxTexture *mailbox = mailboxes.at(i);
+            GLuint texture = createTexture(funcs);
+            funcs->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, mailbox->textureSize().width(), mailbox->textureSize().height(), 0,
+                                GL_RGBA, GL_UNSIGNED_BYTE, pixels + offsets.at(i));
+            mailbox->m_textureId = texture;
+            mailbox->m_ownsTexture = true;
+        }
+    }
+
+    if (m_usePbo) {
+        m_sharedContext->makeCurrent(&m_surface);
+        if (pixels)
+            m_sharedContext->extraFunctions()->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        m_sharedContext->functions()->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        currentContext->makeCurrent(surface);
+    }
+}
+
+GLuint CrossContextTextureImporter::createTexture(QOpenGLFunctions *funcs)
+{
+    GLuint texture = 0;
+    funcs->glGenTextures(1, &texture);
+    funcs->glBindTexture(GL_TEXTURE_2D, texture);
+    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+#endif // USE_X11
 #endif //QT_NO_OPENGL
 
 ResourceHolder::ResourceHolder(const cc::TransferableResource &resource)
@@ -649,22 +1157,36 @@ ResourceHolder::ResourceHolder(const cc::TransferableResource &resource)
 {
 }
 
+static void releaseSharedBitmap(void *sharedBitmap)
+{
+    delete static_cast<cc::SharedBitmap *>(sharedBitmap);
+}
+
+static QImage sharedBitmapImage(const cc::TransferableResource &resource, bool quadNeedsBlending)
+{
+    std::unique_ptr<cc::SharedBitmap> sharedBitmap = content::HostSharedBitmapManager::current()->GetSharedBitmapFromId(resource.size, resource.mailbox_holder.mailbox);
+    // QSG interprets QImage::hasAlphaChannel meaning that a node should enable blending
+    // to draw it but Chromium keeps this information in the quads.
+    // The input format is currently always Format_ARGB32_Premultiplied, so assume that all
+    // alpha bytes are 0xff if quads aren't requesting blending and avoid the conversion
+    // from Format_ARGB32_Premultiplied to Format_RGB32 just to get hasAlphaChannel to
+    // return false.
+    QImage::Format format = quadNeedsBlending ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    // Let the image own the shared bitmap instead of copying its pixels, the texture
+    // is then uploaded straight from the shared memory and the bitmap released once
+    // the scene graph drops the image.
+    uchar *pixels = sharedBitmap->pixels();
+    return QImage(pixels, resource.size.width(), resource.size.height(), format,
+                  releaseSharedBitmap, sharedBitmap.release());
+}
+
 QSharedPointer<QSGTexture> ResourceHolder::initTexture(bool quadNeedsBlending, RenderWidgetHostViewQtDelegate *apiDelegate)
 {
     QSharedPointer<QSGTexture> texture = m_texture.toStrongRef();
     if (!texture) {
         if (m_resource.is_software) {
             Q_ASSERT(apiDelegate);
-            std::unique_ptr<cc::SharedBitmap> sharedBitmap = content::HostSharedBitmapManager::current()->GetSharedBitmapFromId(m_resource.size, m_resource.mailbox_holder.mailbox);
-            // QSG interprets QImage::hasAlphaChannel meaning that a node should enable blending
-            // to draw it but Chromium keeps this information in the quads.
-            // The input format is currently always Format_ARGB32_Premultiplied, so assume that all
-            // alpha bytes are 0xff if quads aren't requesting blending and avoid the conversion
-            // from Format_ARGB32_Premultiplied to Format_RGB32 just to get hasAlphaChannel to
-            // return false.
-            QImage::Format format = quadNeedsBlending ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
-            QImage image(sharedBitmap->pixels(), m_resource.size.width(), m_resource.size.height(), format);
-            texture.reset(apiDelegate->createTextureFromImage(image.copy()));
+            texture.reset(apiDelegate->createTextureFromImage(sharedBitmapImage(m_resource, quadNeedsBlending)));
         } else {
 #ifndef QT_NO_OPENGL
             texture.reset(new MailboxTexture(m_resource.mailbox_holder, toQt(m_resource.size)));
@@ -680,6 +1202,25 @@ QSharedPointer<QSGTexture> ResourceHolder::initTexture(bool quadNeedsBlending, R
     return texture;
 }
 
+void ResourceHolder::adoptTexture(const QSharedPointer<QSGTexture> &texture, bool quadNeedsBlending)
+{
+#ifndef QT_NO_OPENGL
+    Q_ASSERT(!m_resource.is_software && !m_texture);
+    static_cast<MailboxTexture *>(texture.data())->setHasAlphaChannel(quadNeedsBlending);
+    m_texture = texture;
+#else
+    Q_UNUSED(texture)
+    Q_UNUSED(quadNeedsBlending)
+    Q_UNREACHABLE();
+#endif
+}
+
+void ResourceHolder::adoptSoftwareTexture(const QSharedPointer<QSGTexture> &texture)
+{
+    Q_ASSERT(m_resource.is_software && !m_texture);
+    m_texture = texture;
+}
+
 cc::ReturnedResource ResourceHolder::returnResource()
 {
     cc::ReturnedResource returned;
@@ -699,14 +1240,93 @@ cc::ReturnedResource ResourceHolder::returnResource()
 RectClipNode::RectClipNode(const QRectF &rect)
     : m_geometry(QSGGeometry::defaultAttributes_Point2D(), 4)
 {
-    QSGGeometry::updateRectGeometry(&m_geometry, rect);
     setGeometry(&m_geometry);
-    setClipRect(rect);
     setIsRectangular(true);
+    setRect(rect);
+}
+
+void RectClipNode::setRect(const QRectF &rect)
+{
+    QSGGeometry::updateRectGeometry(&m_geometry, rect);
+    markDirty(QSGNode::DirtyGeometry);
+    setClipRect(rect);
+}
+
+// About two seconds worth of frames at 60 Hz.
+static const int kNodePoolFrameWindow = 120;
+
+DelegatedNodePool::DelegatedNodePool()
+    : m_recentNodeCounts(kNodePoolFrameWindow, 0)
+    , m_recentNodeCountsIndex(0)
+    , m_capacity(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+DelegatedNodePool::~DelegatedNodePool()
+{
+    for (int kind = 0; kind < NodeKindCount; ++kind)
+        qDeleteAll(m_freeNodes[kind]);
+}
+
+QSGNode *DelegatedNodePool::take(NodeKind kind)
+{
+    QVector<QSGNode *> &freeNodes = m_freeNodes[kind];
+    if (freeNodes.isEmpty()) {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    return freeNodes.takeLast();
+}
+
+void DelegatedNodePool::release(QSGNode *node, NodeKind kind)
+{
+    if (node->parent())
+        node->parent()->removeChildNode(node);
+    Q_ASSERT(!node->firstChild());
+    m_freeNodes[kind].append(node);
+}
+
+void DelegatedNodePool::endFrame(int nodeCount)
+{
+    m_recentNodeCounts[m_recentNodeCountsIndex] = nodeCount;
+    m_recentNodeCountsIndex = (m_recentNodeCountsIndex + 1) % m_recentNodeCounts.size();
+    m_capacity = *std::max_element(m_recentNodeCounts.constBegin(), m_recentNodeCounts.constEnd());
+
+    int pooledNodes = 0;
+    for (int kind = 0; kind < NodeKindCount; ++kind)
+        pooledNodes += m_freeNodes[kind].size();
+    // Shrink the largest free lists first.
+    while (pooledNodes > m_capacity) {
+        QVector<QSGNode *> *largest = &m_freeNodes[0];
+        for (int kind = 1; kind < NodeKindCount; ++kind)
+            if (m_freeNodes[kind].size() > largest->size())
+                largest = &m_freeNodes[kind];
+        delete largest->takeLast();
+        --pooledNodes;
+    }
+}
+
+NodePoolStats DelegatedNodePool::stats() const
+{
+    NodePoolStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.capacity = m_capacity;
+    for (int kind = 0; kind < NodeKindCount; ++kind)
+        stats.pooledNodes += m_freeNodes[kind].size();
+    return stats;
 }
 
 DelegatedFrameNode::DelegatedFrameNode()
-    : m_numPendingSyncPoints(0)
+    : m_nodePool(new DelegatedNodePool)
+    , m_numPendingSyncPoints(0)
+    , m_fetchPending(false)
+    , m_pipelinedFetch(false)
+    , m_prefetching(false)
+    , m_fetchStatsPending(false)
 #if defined(USE_X11) && !defined(QT_NO_OPENGL)
     , m_contextShared(true)
 #endif
@@ -719,21 +1339,47 @@ DelegatedFrameNode::DelegatedFrameNode()
         static bool allowNotSharedContextWarningShown = true;
         if (allowNotSharedContextWarningShown) {
             allowNotSharedContextWarningShown = false;
-            qWarning("Context is not shared, textures will be copied between contexts.");
+            qWarning("Context is not shared, textures will be imported from the shared context.");
         }
-        m_offsurface.reset(new QOffscreenSurface);
-        m_offsurface->create();
+        m_textureImporter.reset(new CrossContextTextureImporter(sharedContext));
         m_contextShared = false;
     }
 #endif
 }
 
+void DelegatedFrameNode::setPipelinedMailboxFetch(bool enabled)
+{
+#if defined(USE_X11) && !defined(QT_NO_OPENGL)
+    // The copy between contexts needs the fetched textures right away.
+    if (!m_contextShared)
+        enabled = false;
+#endif
+    m_pipelinedFetch = enabled;
+}
+
+void DelegatedFrameNode::setMailboxPrefetchCallback(const base::Closure &callback)
+{
+    QMutexLocker lock(&m_mutex);
+    m_prefetchCallback = callback;
+}
+
 DelegatedFrameNode::~DelegatedFrameNode()
 {
+#ifndef QT_NO_OPENGL
+    // The GPU thread still references the prefetched textures and this node,
+    // let it finish before they go away.
+    if (isMailboxFetchPending()) {
+        waitForMailboxFetch();
+        if (QOpenGLContext::currentContext())
+            syncFetchedMailboxes();
+    }
+#endif
 }
 
 void DelegatedFrameNode::preprocess()
 {
+    if (m_frameTimingRecorder)
+        m_frameTimingRecorder->preprocessStarted();
 #ifndef QT_NO_OPENGL
     // With the threaded render loop the GUI thread has been unlocked at this point.
     // We can now wait for the Chromium GPU thread to produce textures that will be
@@ -748,6 +1394,14 @@ void DelegatedFrameNode::preprocess()
 
     if (!mailboxesToFetch.isEmpty())
         fetchAndSyncMailboxes(mailboxesToFetch);
+    else if (!isMailboxFetchPending())
+        // Textures prefetched for the frame we just committed still need their fences to be waited on.
+        syncFetchedMailboxes();
+
+    if (m_frameTimingRecorder && m_fetchStatsPending && !isMailboxFetchPending()) {
+        m_frameTimingRecorder->mailboxesFetched(m_fetchStats);
+        m_fetchStatsPending = false;
+    }
 
     // Then render any intermediate RenderPass in order.
     typedef QPair<cc::RenderPassId, QSharedPointer<QSGLayer> > Pair;
@@ -758,6 +1412,8 @@ void DelegatedFrameNode::preprocess()
         pair.second->updateTexture();
     }
 #endif
+    if (m_frameTimingRecorder)
+        m_frameTimingRecorder->preprocessFinished();
 }
 
 static YUVVideoMaterial::ColorSpace toQt(cc::YUVVideoDrawQuad::ColorSpace color_space)
@@ -774,72 +1430,224 @@ static YUVVideoMaterial::ColorSpace toQt(cc::YUVVideoDrawQuad::ColorSpace color_
     return YUVVideoMaterial::REC_601;
 }
 
-static bool areSharedQuadStatesEqual(const cc::SharedQuadState *layerState,
-                                     const cc::SharedQuadState *prevLayerState)
+static bool isReusableMaterial(cc::DrawQuad::Material material)
 {
-    if (layerState->is_clipped != prevLayerState->is_clipped
-        || layerState->clip_rect != prevLayerState->clip_rect)
+    switch (material) {
+    case cc::DrawQuad::RENDER_PASS:
+    case cc::DrawQuad::TEXTURE_CONTENT:
+    case cc::DrawQuad::SOLID_COLOR:
+    case cc::DrawQuad::DEBUG_BORDER:
+    case cc::DrawQuad::TILED_CONTENT:
+        return true;
+    default:
         return false;
-    if (layerState->quad_to_target_transform != prevLayerState->quad_to_target_transform)
-        return false;
-    return qFuzzyCompare(layerState->opacity, prevLayerState->opacity);
+    }
 }
 
-// Compares if the frame data that we got from the Chromium Compositor is
-// *structurally* equivalent to the one of the previous frame.
-// If it is, we will just reuse and update the old nodes where necessary.
-static bool areRenderPassStructuresEqual(cc::DelegatedFrameData *frameData,
-                                         cc::DelegatedFrameData *previousFrameData)
+static QuadKey quadKey(const cc::DrawQuad *quad)
 {
-    if (!previousFrameData)
-        return false;
-
-    if (previousFrameData->render_pass_list.size() != frameData->render_pass_list.size())
-        return false;
-
-    for (unsigned i = 0; i < frameData->render_pass_list.size(); ++i) {
-        cc::RenderPass *newPass = frameData->render_pass_list.at(i).get();
-        cc::RenderPass *prevPass = previousFrameData->render_pass_list.at(i).get();
+    unsigned resourceId = 0;
+    switch (quad->material) {
+    case cc::DrawQuad::TEXTURE_CONTENT:
+        resourceId = cc::TextureDrawQuad::MaterialCast(quad)->resource_id();
+        break;
+    case cc::DrawQuad::TILED_CONTENT:
+        resourceId = cc::TileDrawQuad::MaterialCast(quad)->resource_id();
+        break;
+    default:
+        break;
+    }
+    return QuadKey(quad->material, resourceId, toQt(quad->rect));
+}
 
-        if (newPass->id != prevPass->id)
-            return false;
+static DelegatedNodePool::NodeKind nodeKind(int material)
+{
+    switch (material) {
+    case cc::DrawQuad::RENDER_PASS:
+        return DelegatedNodePool::ImageNode;
+    case cc::DrawQuad::TEXTURE_CONTENT:
+    case cc::DrawQuad::TILED_CONTENT:
+        return DelegatedNodePool::TextureNode;
+    case cc::DrawQuad::SOLID_COLOR:
+        return DelegatedNodePool::RectangleNode;
+    case cc::DrawQuad::DEBUG_BORDER:
+        return DelegatedNodePool::DebugBorderNode;
+    default:
+        // Video nodes are never recycled.
+        return DelegatedNodePool::NodeKindCount;
+    }
+}
 
-        if (newPass->quad_list.size() != prevPass->quad_list.size())
-            return false;
+static int countNodes(QSGNode *node)
+{
+    int count = 1;
+    for (QSGNode *child = node->firstChild(); child; child = child->nextSibling())
+        count += countNodes(child);
+    return count;
+}
 
-        cc::QuadList::ConstBackToFrontIterator it = newPass->quad_list.BackToFrontBegin();
-        cc::QuadList::ConstBackToFrontIterator end = newPass->quad_list.BackToFrontEnd();
-        cc::QuadList::ConstBackToFrontIterator prevIt = prevPass->quad_list.BackToFrontBegin();
-        cc::QuadList::ConstBackToFrontIterator prevEnd = prevPass->quad_list.BackToFrontEnd();
-        for (; it != end && prevIt != prevEnd; ++it, ++prevIt) {
-            const cc::DrawQuad *quad = *it;
-            const cc::DrawQuad *prevQuad = *prevIt;
-            if (!areSharedQuadStatesEqual(quad->shared_quad_state, prevQuad->shared_quad_state))
-                return false;
-            if (quad->material != prevQuad->material)
-                return false;
-#ifndef QT_NO_OPENGL
-            if (quad->material == cc::DrawQuad::YUV_VIDEO_CONTENT)
-                return false;
-#ifdef GL_OES_EGL_image_external
-            if (quad->material == cc::DrawQuad::STREAM_VIDEO_CONTENT)
-                return false;
-#endif // GL_OES_EGL_image_external
-#endif // QT_NO_OPENGL
+void DelegatedFrameNode::LayerChain::build(QSGNode *renderPassChain, const cc::SharedQuadState *layerState,
+                                           DelegatedNodePool *nodePool, NodeTreeStats *stats)
+{
+    QSGNode *layerChain = renderPassChain;
+    if (layerState->is_clipped) {
+        const QRectF clipRect = toQt(layerState->clip_rect);
+        if (RectClipNode *pooledNode = static_cast<RectClipNode *>(nodePool->take(DelegatedNodePool::ClipNode))) {
+            pooledNode->setRect(clipRect);
+            clipNode = pooledNode;
+            ++stats->nodesReused;
+        } else {
+            clipNode = new RectClipNode(clipRect);
+            ++stats->nodesCreated;
+        }
+        layerChain->appendChildNode(clipNode);
+        layerChain = clipNode;
+    }
+    if (!layerState->quad_to_target_transform.IsIdentity()) {
+        transformNode = static_cast<QSGTransformNode *>(nodePool->take(DelegatedNodePool::TransformNode));
+        if (transformNode) {
+            ++stats->nodesReused;
+        } else {
+            transformNode = new QSGTransformNode;
+            ++stats->nodesCreated;
+        }
+        transformNode->setMatrix(toQt(layerState->quad_to_target_transform.matrix()));
+        layerChain->appendChildNode(transformNode);
+        layerChain = transformNode;
+    }
+    if (layerState->opacity < 1.0) {
+        opacityNode = static_cast<QSGOpacityNode *>(nodePool->take(DelegatedNodePool::OpacityNode));
+        if (opacityNode) {
+            ++stats->nodesReused;
+        } else {
+            opacityNode = new QSGOpacityNode;
+            ++stats->nodesCreated;
+        }
+        opacityNode->setOpacity(layerState->opacity);
+        layerChain->appendChildNode(opacityNode);
+        layerChain = opacityNode;
+    }
+}
 
+int DelegatedFrameNode::LayerChain::release(DelegatedNodePool *nodePool)
+{
+    int count = 0;
+    for (int i = 0; i < contentNodes.size(); ++i) {
+        QSGNode *node = contentNodes.at(i);
+        // Already picked up by a quad of another layer chain.
+        if (!node)
+            continue;
+        ++count;
+        const DelegatedNodePool::NodeKind kind = nodeKind(quadKeys.at(i).material);
+        if (kind != DelegatedNodePool::NodeKindCount) {
+            nodePool->release(node, kind);
+        } else {
+            if (node->parent())
+                node->parent()->removeChildNode(node);
+            delete node;
         }
     }
+    contentNodes.clear();
+    // Release the chain from the inside out so that each node is childless when pooled.
+    if (opacityNode) {
+        nodePool->release(opacityNode, DelegatedNodePool::OpacityNode);
+        ++count;
+    }
+    if (transformNode) {
+        nodePool->release(transformNode, DelegatedNodePool::TransformNode);
+        ++count;
+    }
+    if (clipNode) {
+        nodePool->release(clipNode, DelegatedNodePool::ClipNode);
+        ++count;
+    }
+    clipNode = nullptr;
+    transformNode = nullptr;
+    opacityNode = nullptr;
+    return count;
+}
+
+void DelegatedFrameNode::LayerChain::update(const cc::SharedQuadState *layerState)
+{
+    if (clipNode) {
+        const QRectF clipRect = toQt(layerState->clip_rect);
+        if (clipNode->clipRect() != clipRect)
+            static_cast<RectClipNode *>(clipNode)->setRect(clipRect);
+    }
+    if (transformNode) {
+        const QMatrix4x4 matrix = toQt(layerState->quad_to_target_transform.matrix());
+        if (transformNode->matrix() != matrix)
+            transformNode->setMatrix(matrix);
+    }
+    if (opacityNode && !qFuzzyCompare(opacityNode->opacity(), qreal(layerState->opacity)))
+        opacityNode->setOpacity(layerState->opacity);
+}
+
+QSGNode *DelegatedFrameNode::LayerChain::outerNode() const
+{
+    if (clipNode)
+        return clipNode;
+    if (transformNode)
+        return transformNode;
+    return opacityNode;
+}
+
+QSGNode *DelegatedFrameNode::LayerChain::innerNode(QSGNode *renderPassChain) const
+{
+    if (opacityNode)
+        return opacityNode;
+    if (transformNode)
+        return transformNode;
+    if (clipNode)
+        return clipNode;
+    return renderPassChain;
+}
+
+bool DelegatedFrameNode::LayerChain::hasSameShape(const LayerChain &other) const
+{
+    if (shapeHash != other.shapeHash || !reusable || !other.reusable)
+        return false;
+    if (quadKeys.size() != other.quadKeys.size())
+        return false;
+    for (int i = 0; i < quadKeys.size(); ++i)
+        if (quadKeys.at(i).material != other.quadKeys.at(i).material)
+            return false;
     return true;
 }
 
-void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
+// Combines the chain nodes needed by a layer state and the materials of its quads.
+// Layer chains with the same shape only differ by the values set on their nodes.
+static uint layerShapeHash(const cc::SharedQuadState *layerState, const QVector<QuadKey> &quadKeys)
+{
+    const uint chainNodes = (layerState->is_clipped ? 1 : 0)
+        | (layerState->quad_to_target_transform.IsIdentity() ? 0 : 2)
+        | (layerState->opacity < 1.0 ? 4 : 0);
+    uint hash = 0;
+    Q_FOREACH (const QuadKey &key, quadKeys)
+        hash = hash * 31 + key.material;
+    // Keep the chain nodes in the lowest bits, equal hashes then always have the same ones.
+    return (hash << 3) | chainNodes;
+}
+
+NodePoolStats DelegatedFrameNode::nodePoolStats() const
+{
+    return m_nodePool->stats();
+}
+
+bool DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
                                 cc::ReturnedResourceArray *resourcesToRelease,
                                 RenderWidgetHostViewQtDelegate *apiDelegate)
 {
     m_chromiumCompositorData = chromiumCompositorData;
     cc::DelegatedFrameData* frameData = m_chromiumCompositorData->frameData.get();
     if (!frameData)
-        return;
+        return true;
+
+    // In pipelined mode the textures of a new frame are fetched while we keep showing
+    // the current one. Only replace the tree once the GPU thread is done with all of them,
+    // even if the mode was turned off in the meantime.
+    if ((m_pipelinedFetch || !m_prefetchedTextures.isEmpty()) && prefetchMailboxes(frameData))
+        return false;
 
     // DelegatedFrameNode is a transform node only for the purpose of
     // countering the scale of devicePixel-scaled tiles when rendering them
@@ -866,32 +1674,32 @@ void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
     }
 
     frameData->resource_list.clear();
-    QScopedPointer<DelegatedNodeTreeHandler> nodeHandler;
 
-    // We first compare if the render passes from the previous frame data are structurally
-    // equivalent to the render passes in the current frame data. If they are, we are going
-    // to reuse the old nodes. Otherwise, we will delete the old nodes and build a new tree.
-    cc::DelegatedFrameData *previousFrameData = m_chromiumCompositorData->previousFrameData.get();
-    const bool buildNewTree = !areRenderPassStructuresEqual(frameData, previousFrameData) || m_sceneGraphNodes.empty();
-
-    m_chromiumCompositorData->previousFrameData = nullptr;
+    // Keep the old objects in scope to hold a ref on layers and textures that we can re-use.
+    // Destroy the remaining objects before returning.
     SGObjects previousSGObjects;
-    QVector<QSharedPointer<QSGTexture> > textureStrongRefs;
-    if (buildNewTree) {
-        // Keep the old objects in scope to hold a ref on layers, resources and textures
-        // that we can re-use. Destroy the remaining objects before returning.
-        qSwap(m_sgObjects, previousSGObjects);
-        // Discard the scene graph nodes from the previous frame.
-        while (QSGNode *oldChain = firstChild())
-            delete oldChain;
-        m_sceneGraphNodes.clear();
-        nodeHandler.reset(new DelegatedNodeTreeCreator(&m_sceneGraphNodes, apiDelegate));
-    } else {
-        // Save the texture strong refs so they only go out of scope when the method returns and
-        // the new vector of texture strong refs has been filled.
-        qSwap(m_sgObjects.textureStrongRefs, textureStrongRefs);
-        nodeHandler.reset(new DelegatedNodeTreeUpdater(&m_sceneGraphNodes));
+    qSwap(m_sgObjects, previousSGObjects);
+    // The nodes of the previous frame are matched by render pass and layer chain, only the
+    // parts of the tree that changed structurally get rebuilt.
+    QVector<RenderPassNodes> previousRenderPassNodes;
+    qSwap(m_renderPassNodes, previousRenderPassNodes);
+    m_renderPassNodes.reserve(frameData->render_pass_list.size());
+    m_treeStats = NodeTreeStats();
+    m_softwareTextureStats = SoftwareTextureStats();
+    // Tile textures can only be handed over to a new resource at the same place once
+    // no quad of this frame draws the resource they were last uploaded from.
+    qSwap(m_tileSlots, m_previousTileSlots);
+    m_tileSlots.clear();
+    m_frameTileResourceIds.clear();
+    if (!m_previousTileSlots.isEmpty()) {
+        for (unsigned i = 0; i < frameData->render_pass_list.size(); ++i) {
+            for (const cc::DrawQuad *quad : frameData->render_pass_list.at(i)->quad_list) {
+                if (quad->material == cc::DrawQuad::TILED_CONTENT)
+                    m_frameTileResourceIds.insert(cc::TileDrawQuad::MaterialCast(quad)->resource_id());
+            }
+        }
     }
+
     // The RenderPasses list is actually a tree where a parent RenderPass is connected
     // to its dependencies through a RenderPassId reference in one or more RenderPassQuads.
     // The list is already ordered with intermediate RenderPasses placed before their
@@ -902,192 +1710,349 @@ void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
 
     for (unsigned i = 0; i < frameData->render_pass_list.size(); ++i) {
         cc::RenderPass *pass = frameData->render_pass_list.at(i).get();
+        const bool isRootRenderPass = pass == rootRenderPass;
+
+        RenderPassNodes *previousPassNodes = nullptr;
+        for (int j = 0; j < previousRenderPassNodes.size(); ++j) {
+            RenderPassNodes &candidate = previousRenderPassNodes[j];
+            if (candidate.renderPassChain && candidate.id == pass->id
+                    && candidate.rootNode.isNull() == isRootRenderPass) {
+                previousPassNodes = &candidate;
+                break;
+            }
+        }
 
-        QSGNode *renderPassParent = 0;
-        if (pass != rootRenderPass) {
-            QSharedPointer<QSGLayer> rpLayer;
-            if (buildNewTree) {
-                rpLayer = findRenderPassLayer(pass->id, previousSGObjects.renderPassLayers);
-                if (!rpLayer) {
-                    rpLayer = QSharedPointer<QSGLayer>(apiDelegate->createLayer());
-                    // Avoid any premature texture update since we need to wait
-                    // for the GPU thread to produce the dependent resources first.
-                    rpLayer->setLive(false);
-                }
-                QSharedPointer<QSGRootNode> rootNode(new QSGRootNode);
-                rpLayer->setItem(rootNode.data());
-                m_sgObjects.renderPassLayers.append(QPair<cc::RenderPassId,
-                                                    QSharedPointer<QSGLayer> >(pass->id, rpLayer));
-                m_sgObjects.renderPassRootNodes.append(rootNode);
-                renderPassParent = rootNode.data();
-            } else
-                rpLayer = findRenderPassLayer(pass->id, m_sgObjects.renderPassLayers);
+        QSharedPointer<QSGLayer> rpLayer;
+        if (!isRootRenderPass) {
+            rpLayer = findRenderPassLayer(pass->id, previousSGObjects.renderPassLayers);
+            if (!rpLayer) {
+                rpLayer = QSharedPointer<QSGLayer>(apiDelegate->createLayer());
+                // Avoid any premature texture update since we need to wait
+                // for the GPU thread to produce the dependent resources first.
+                rpLayer->setLive(false);
+            }
+            m_sgObjects.renderPassLayers.append(QPair<cc::RenderPassId,
+                                                QSharedPointer<QSGLayer> >(pass->id, rpLayer));
+        }
 
+        RenderPassNodes passNodes;
+        passNodes.id = pass->id;
+        if (previousPassNodes) {
+            passNodes.rootNode = previousPassNodes->rootNode;
+            passNodes.renderPassChain = previousPassNodes->renderPassChain;
+            // Mark the previous nodes as taken.
+            previousPassNodes->renderPassChain = nullptr;
+            m_treeStats.nodesReused += isRootRenderPass ? 1 : 2;
+        } else {
+            QSGNode *renderPassParent = this;
+            if (!isRootRenderPass) {
+                passNodes.rootNode = QSharedPointer<QSGRootNode>(new QSGRootNode);
+                rpLayer->setItem(passNodes.rootNode.data());
+                renderPassParent = passNodes.rootNode.data();
+                ++m_treeStats.nodesCreated;
+            }
+            passNodes.renderPassChain = buildRenderPassChain(renderPassParent);
+            ++m_treeStats.nodesCreated;
+        }
+        if (rpLayer) {
             rpLayer->setRect(toQt(pass->output_rect));
             rpLayer->setSize(toQt(pass->output_rect.size()));
             rpLayer->setFormat(pass->has_transparent_background ? GL_RGBA : GL_RGB);
-        } else
-            renderPassParent = this;
+        }
 
-        const cc::SharedQuadState *currentLayerState = nullptr;
-        QSGNode *currentLayerChain = nullptr;
+        commitRenderPass(pass, &passNodes, previousPassNodes ? &previousPassNodes->layerChains : nullptr,
+                         resourceCandidates, apiDelegate);
+        m_renderPassNodes.append(passNodes);
+    }
 
-        QSGNode *renderPassChain = nullptr;
-        if (buildNewTree)
-            renderPassChain = buildRenderPassChain(renderPassParent);
+    // Recycle the scene graph nodes of the render passes that are gone.
+    for (int i = 0; i < previousRenderPassNodes.size(); ++i) {
+        RenderPassNodes &passNodes = previousRenderPassNodes[i];
+        if (!passNodes.renderPassChain)
+            continue;
+        for (int j = 0; j < passNodes.layerChains.size(); ++j)
+            m_treeStats.nodesDeleted += passNodes.layerChains[j].release(m_nodePool.data());
+        m_treeStats.nodesDeleted += countNodes(passNodes.renderPassChain) + !passNodes.rootNode.isNull();
+        delete passNodes.renderPassChain;
+    }
+    m_nodePool->endFrame(m_treeStats.nodesCreated + m_treeStats.nodesReused);
 
-        cc::QuadList::ConstBackToFrontIterator it = pass->quad_list.BackToFrontBegin();
-        cc::QuadList::ConstBackToFrontIterator end = pass->quad_list.BackToFrontEnd();
-        for (; it != end; ++it) {
-            const cc::DrawQuad *quad = *it;
+    // Send resources of remaining candidates back to the child compositors so that
+    // they can be freed or reused.
+    typedef QHash<unsigned, QSharedPointer<ResourceHolder> >::const_iterator
+            ResourceHolderIterator;
 
-            if (buildNewTree && currentLayerState != quad->shared_quad_state) {
-                currentLayerState = quad->shared_quad_state;
-                currentLayerChain = buildLayerChain(renderPassChain, currentLayerState);
-            }
-            switch (quad->material) {
-            case cc::DrawQuad::RENDER_PASS: {
-                const cc::RenderPassDrawQuad *renderPassQuad
-                        = cc::RenderPassDrawQuad::MaterialCast(quad);
-                QSGTexture *layer = findRenderPassLayer(renderPassQuad->render_pass_id,
-                                                        m_sgObjects.renderPassLayers).data();
-
-                nodeHandler->setupRenderPassNode(layer, toQt(quad->rect), currentLayerChain);
-                break;
-            } case cc::DrawQuad::TEXTURE_CONTENT: {
-                const cc::TextureDrawQuad *tquad = cc::TextureDrawQuad::MaterialCast(quad);
-                ResourceHolder *resource = findAndHoldResource(tquad->resource_id(),
-                                                               resourceCandidates);
-                QSGTexture *texture = initAndHoldTexture(resource,
-                                                         quad->ShouldDrawWithBlending(),
-                                                         apiDelegate);
-                QSizeF textureSize;
-                if (texture)
-                    textureSize = texture->textureSize();
-                gfx::RectF uv_rect = gfx::ScaleRect(
-                    gfx::BoundingRect(tquad->uv_top_left, tquad->uv_bottom_right),
-                    textureSize.width(), textureSize.height());
-
-                nodeHandler->setupTextureContentNode(
-                                              texture,
-                                              toQt(quad->rect), toQt(uv_rect),
-                                              resource->transferableResource().filter == GL_LINEAR
-                                                               ? QSGTexture::Linear
-                                                               : QSGTexture::Nearest,
-                                              tquad->y_flipped ? QSGTextureNode::MirrorVertically
-                                                               : QSGTextureNode::NoTransform,
-                                              currentLayerChain);
-                break;
-            } case cc::DrawQuad::SOLID_COLOR: {
-                const cc::SolidColorDrawQuad *scquad = cc::SolidColorDrawQuad::MaterialCast(quad);
-                // Qt only supports MSAA and this flag shouldn't be needed.
-                // If we ever want to use QSGRectangleNode::setAntialiasing for this we should
-                // try to see if we can do something similar for tile quads first.
-                Q_UNUSED(scquad->force_anti_aliasing_off);
-                nodeHandler->setupSolidColorNode(toQt(quad->rect), toQt(scquad->color),
-                                                 currentLayerChain);
+    ResourceHolderIterator end = resourceCandidates.constEnd();
+    for (ResourceHolderIterator it = resourceCandidates.constBegin(); it != end ; ++it)
+        resourcesToRelease->push_back((*it)->returnResource());
+
+    // Prefetched textures that no quad picked up can be released along with their resources.
+    m_prefetchedTextures.clear();
+    // Same for the tile textures of places where no tile got drawn this time.
+    m_previousTileSlots.clear();
+    return true;
+}
+
+void DelegatedFrameNode::commitRenderPass(cc::RenderPass *pass, RenderPassNodes *passNodes,
+                                          QVector<LayerChain> *previousLayerChains,
+                                          QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates,
+                                          RenderWidgetHostViewQtDelegate *apiDelegate)
+{
+    // Split the quads into runs sharing the same SharedQuadState,
+    // each of them gets its own layer chain.
+    QVector<const cc::DrawQuad *> quads;
+    QVector<int> runStarts;
+    quads.reserve(pass->quad_list.size());
+    const cc::SharedQuadState *currentLayerState = nullptr;
+    cc::QuadList::ConstBackToFrontIterator it = pass->quad_list.BackToFrontBegin();
+    cc::QuadList::ConstBackToFrontIterator end = pass->quad_list.BackToFrontEnd();
+    for (; it != end; ++it) {
+        const cc::DrawQuad *quad = *it;
+        if (currentLayerState != quad->shared_quad_state) {
+            currentLayerState = quad->shared_quad_state;
+            runStarts.append(quads.size());
+        }
+        quads.append(quad);
+    }
+    runStarts.append(quads.size());
+
+    QVector<LayerChain> &layerChains = passNodes->layerChains;
+    layerChains.resize(runStarts.size() - 1);
+
+    // Insert in reverse order, QMultiHash::find returns the last inserted value first.
+    QMultiHash<uint, int> previousChainsByShape;
+    if (previousLayerChains) {
+        for (int i = previousLayerChains->size() - 1; i >= 0; --i) {
+            const LayerChain &chain = previousLayerChains->at(i);
+            if (chain.reusable)
+                previousChainsByShape.insert(chain.shapeHash, i);
+        }
+    }
+
+    // Match every run with an unused layer chain of the previous frame having the same shape.
+    // Its nodes will only need their values to be updated.
+    QVector<int> matches(layerChains.size(), -1);
+    QVector<bool> previousChainTaken(previousLayerChains ? previousLayerChains->size() : 0, false);
+    for (int run = 0; run < layerChains.size(); ++run) {
+        LayerChain &chain = layerChains[run];
+        const cc::SharedQuadState *layerState = quads.at(runStarts.at(run))->shared_quad_state;
+        chain.quadKeys.reserve(runStarts.at(run + 1) - runStarts.at(run));
+        for (int i = runStarts.at(run); i < runStarts.at(run + 1); ++i) {
+            chain.quadKeys.append(quadKey(quads.at(i)));
+            chain.reusable = chain.reusable && isReusableMaterial(quads.at(i)->material);
+        }
+        chain.shapeHash = layerShapeHash(layerState, chain.quadKeys);
+
+        QMultiHash<uint, int>::iterator candidate = previousChainsByShape.find(chain.shapeHash);
+        for (; candidate != previousChainsByShape.end() && candidate.key() == chain.shapeHash; ++candidate) {
+            if (chain.hasSameShape(previousLayerChains->at(*candidate))) {
+                matches[run] = *candidate;
+                previousChainTaken[*candidate] = true;
+                previousChainsByShape.erase(candidate);
                 break;
+            }
+        }
+    }
+
+    // The nodes of previous layer chains that weren't matched can still be picked up
+    // individually by quads of new layer chains with the same key.
+    QMultiHash<QuadKey, QSGNode**> reusableNodes;
+    for (int i = 0; i < previousChainTaken.size(); ++i) {
+        LayerChain &chain = (*previousLayerChains)[i];
+        if (previousChainTaken.at(i) || !chain.reusable)
+            continue;
+        for (int j = 0; j < chain.contentNodes.size(); ++j)
+            reusableNodes.insert(chain.quadKeys.at(j), &chain.contentNodes[j]);
+    }
+
+    for (int run = 0; run < layerChains.size(); ++run) {
+        LayerChain &chain = layerChains[run];
+        const cc::SharedQuadState *layerState = quads.at(runStarts.at(run))->shared_quad_state;
+        if (matches.at(run) != -1) {
+            LayerChain &previousChain = (*previousLayerChains)[matches.at(run)];
+            chain.clipNode = previousChain.clipNode;
+            chain.transformNode = previousChain.transformNode;
+            chain.opacityNode = previousChain.opacityNode;
+            qSwap(chain.contentNodes, previousChain.contentNodes);
+            chain.update(layerState);
+
+            QSGNode *layerChain = chain.innerNode(passNodes->renderPassChain);
+            DelegatedNodeTreeUpdater nodeHandler(&chain.contentNodes);
+            for (int i = runStarts.at(run); i < runStarts.at(run + 1); ++i)
+                handleQuad(quads.at(i), pass, layerChain, &nodeHandler, resourceCandidates, apiDelegate);
+            m_treeStats.nodesReused += !!chain.clipNode + !!chain.transformNode + !!chain.opacityNode
+                + chain.contentNodes.size();
+        } else {
+            chain.build(passNodes->renderPassChain, layerState, m_nodePool.data(), &m_treeStats);
+
+            QSGNode *layerChain = chain.innerNode(passNodes->renderPassChain);
+            DelegatedNodeTreeCreator nodeHandler(&chain.contentNodes, apiDelegate, m_nodePool.data(),
+                                                 chain.reusable ? &reusableNodes : nullptr);
+            for (int i = runStarts.at(run); i < runStarts.at(run + 1); ++i) {
+                nodeHandler.setQuadKey(chain.quadKeys.at(i - runStarts.at(run)));
+                handleQuad(quads.at(i), pass, layerChain, &nodeHandler, resourceCandidates, apiDelegate);
+            }
+            m_treeStats.nodesCreated += nodeHandler.createdNodeCount();
+            m_treeStats.nodesReused += nodeHandler.reusedNodeCount();
+        }
+    }
+
+    // Recycle what remains of the unmatched layer chains.
+    for (int i = 0; i < previousChainTaken.size(); ++i) {
+        if (!previousChainTaken.at(i))
+            m_treeStats.nodesDeleted += (*previousLayerChains)[i].release(m_nodePool.data());
+    }
+
+    // New layer chains have been appended after the reused ones,
+    // restore Chromium's back to front order if needed.
+    QSGNode *renderPassChain = passNodes->renderPassChain;
+    bool inOrder = true;
+    QSGNode *child = renderPassChain->firstChild();
+    for (int run = 0; run < layerChains.size() && inOrder; ++run) {
+        const LayerChain &chain = layerChains.at(run);
+        if (QSGNode *outerNode = chain.outerNode()) {
+            inOrder = child == outerNode;
+            child = child ? child->nextSibling() : nullptr;
+        } else {
+            for (int i = 0; i < chain.contentNodes.size() && inOrder; ++i) {
+                inOrder = child == chain.contentNodes.at(i);
+                child = child ? child->nextSibling() : nullptr;
+            }
+        }
+    }
+    if (inOrder && !child)
+        return;
+    renderPassChain->removeAllChildNodes();
+    Q_FOREACH (const LayerChain &chain, layerChains) {
+        if (QSGNode *outerNode = chain.outerNode()) {
+            renderPassChain->appendChildNode(outerNode);
+        } else {
+            Q_FOREACH (QSGNode *node, chain.contentNodes)
+                renderPassChain->appendChildNode(node);
+        }
+    }
+}
+
+void DelegatedFrameNode::handleQuad(const cc::DrawQuad *quad, const cc::RenderPass *pass,
+                                    QSGNode *currentLayerChain, DelegatedNodeTreeHandler *nodeHandler,
+                                    QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates,
+                                    RenderWidgetHostViewQtDelegate *apiDelegate)
+{
+    switch (quad->material) {
+    case cc::DrawQuad::RENDER_PASS: {
+        const cc::RenderPassDrawQuad *renderPassQuad
+                = cc::RenderPassDrawQuad::MaterialCast(quad);
+        QSGTexture *layer = findRenderPassLayer(renderPassQuad->render_pass_id,
+                                                m_sgObjects.renderPassLayers).data();
+
+        nodeHandler->setupRenderPassNode(layer, toQt(quad->rect), currentLayerChain);
+        break;
+    } case cc::DrawQuad::TEXTURE_CONTENT: {
+        const cc::TextureDrawQuad *tquad = cc::TextureDrawQuad::MaterialCast(quad);
+        ResourceHolder *resource = findAndHoldResource(tquad->resource_id(),
+                                                       resourceCandidates);
+        QSGTexture *texture = initAndHoldTexture(resource,
+                                                 quad->ShouldDrawWithBlending(),
+                                                 apiDelegate);
+        QSizeF textureSize;
+        if (texture)
+            textureSize = texture->textureSize();
+        gfx::RectF uv_rect = gfx::ScaleRect(
+            gfx::BoundingRect(tquad->uv_top_left, tquad->uv_bottom_right),
+            textureSize.width(), textureSize.height());
+
+        nodeHandler->setupTextureContentNode(
+                                      texture,
+                                      toQt(quad->rect), toQt(uv_rect),
+                                      resource->transferableResource().filter == GL_LINEAR
+                                                       ? QSGTexture::Linear
+                                                       : QSGTexture::Nearest,
+                                      tquad->y_flipped ? QSGTextureNode::MirrorVertically
+                                                       : QSGTextureNode::NoTransform,
+                                      currentLayerChain);
+        break;
+    } case cc::DrawQuad::SOLID_COLOR: {
+        const cc::SolidColorDrawQuad *scquad = cc::SolidColorDrawQuad::MaterialCast(quad);
+        // Qt only supports MSAA and this flag shouldn't be needed.
+        // If we ever want to use QSGRectangleNode::setAntialiasing for this we should
+        // try to see if we can do something similar for tile quads first.
+        Q_UNUSED(scquad->force_anti_aliasing_off);
+        nodeHandler->setupSolidColorNode(toQt(quad->rect), toQt(scquad->color),
+                                         currentLayerChain);
+        break;
 #ifndef QT_NO_OPENGL
-            } case cc::DrawQuad::DEBUG_BORDER: {
-                const cc::DebugBorderDrawQuad *dbquad
-                        = cc::DebugBorderDrawQuad::MaterialCast(quad);
-
-                QSGGeometry *geometry
-                        = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 4);
-                geometry->setDrawingMode(GL_LINE_LOOP);
-                geometry->setLineWidth(dbquad->width);
-                // QSGGeometry::updateRectGeometry would actually set the
-                // corners in the following order:
-                // top-left, bottom-left, top-right, bottom-right, leading to a nice criss cross,
-                // instead of having a closed loop.
-                const gfx::Rect &r(dbquad->rect);
-                geometry->vertexDataAsPoint2D()[0].set(r.x(), r.y());
-                geometry->vertexDataAsPoint2D()[1].set(r.x() + r.width(), r.y());
-                geometry->vertexDataAsPoint2D()[2].set(r.x() + r.width(), r.y() + r.height());
-                geometry->vertexDataAsPoint2D()[3].set(r.x(), r.y() + r.height());
-
-                QSGFlatColorMaterial *material = new QSGFlatColorMaterial;
-                material->setColor(toQt(dbquad->color));
-
-                nodeHandler->setupDebugBorderNode(geometry, material, currentLayerChain);
-                break;
+    } case cc::DrawQuad::DEBUG_BORDER: {
+        const cc::DebugBorderDrawQuad *dbquad
+                = cc::DebugBorderDrawQuad::MaterialCast(quad);
+
+        nodeHandler->setupDebugBorderNode(toQt(dbquad->rect), toQt(dbquad->color), dbquad->width,
+                                          currentLayerChain);
+        break;
 #endif
-            } case cc::DrawQuad::TILED_CONTENT: {
-                const cc::TileDrawQuad *tquad = cc::TileDrawQuad::MaterialCast(quad);
-                ResourceHolder *resource
-                        = findAndHoldResource(tquad->resource_id(), resourceCandidates);
-                nodeHandler->setupTiledContentNode(
-                                    initAndHoldTexture(resource,
-                                                       quad->ShouldDrawWithBlending(),
-                                                       apiDelegate),
-                                    toQt(quad->rect), toQt(tquad->tex_coord_rect),
-                                    resource->transferableResource().filter
-                                            == GL_LINEAR ? QSGTexture::Linear
-                                                         : QSGTexture::Nearest,
-                                    currentLayerChain);
-                break;
-#ifndef QT_NO_OPENGL
-            } case cc::DrawQuad::YUV_VIDEO_CONTENT: {
-                const cc::YUVVideoDrawQuad *vquad = cc::YUVVideoDrawQuad::MaterialCast(quad);
-                ResourceHolder *yResource
-                        = findAndHoldResource(vquad->y_plane_resource_id(), resourceCandidates);
-                ResourceHolder *uResource
-                        = findAndHoldResource(vquad->u_plane_resource_id(), resourceCandidates);
-                ResourceHolder *vResource
-                        = findAndHoldResource(vquad->v_plane_resource_id(), resourceCandidates);
-                ResourceHolder *aResource = 0;
-                // This currently requires --enable-vp8-alpha-playback and
-                // needs a video with alpha data to be triggered.
-                if (vquad->a_plane_resource_id())
-                    aResource = findAndHoldResource(vquad->a_plane_resource_id(),
-                                                    resourceCandidates);
-
-                nodeHandler->setupYUVVideoNode(
-                            initAndHoldTexture(yResource, quad->ShouldDrawWithBlending()),
-                            initAndHoldTexture(uResource, quad->ShouldDrawWithBlending()),
-                            initAndHoldTexture(vResource, quad->ShouldDrawWithBlending()),
-                            aResource
-                                ? initAndHoldTexture(aResource, quad->ShouldDrawWithBlending())
-                                : 0,
-                            toQt(vquad->ya_tex_coord_rect), toQt(vquad->uv_tex_coord_rect),
-                            toQt(vquad->ya_tex_size), toQt(vquad->uv_tex_size),
-                            toQt(vquad->color_space),
-                            vquad->resource_multiplier, vquad->resource_offset,
-                            toQt(quad->rect),
+    } case cc::DrawQuad::TILED_CONTENT: {
+        const cc::TileDrawQuad *tquad = cc::TileDrawQuad::MaterialCast(quad);
+        ResourceHolder *resource
+                = findAndHoldResource(tquad->resource_id(), resourceCandidates);
+        nodeHandler->setupTiledContentNode(
+                            initAndHoldTileTexture(resource, tquad, pass, apiDelegate),
+                            toQt(quad->rect), toQt(tquad->tex_coord_rect),
+                            resource->transferableResource().filter
+                                    == GL_LINEAR ? QSGTexture::Linear
+                                                 : QSGTexture::Nearest,
                             currentLayerChain);
-                break;
+        break;
+#ifndef QT_NO_OPENGL
+    } case cc::DrawQuad::YUV_VIDEO_CONTENT: {
+        const cc::YUVVideoDrawQuad *vquad = cc::YUVVideoDrawQuad::MaterialCast(quad);
+        ResourceHolder *yResource
+                = findAndHoldResource(vquad->y_plane_resource_id(), resourceCandidates);
+        ResourceHolder *uResource
+                = findAndHoldResource(vquad->u_plane_resource_id(), resourceCandidates);
+        ResourceHolder *vResource
+                = findAndHoldResource(vquad->v_plane_resource_id(), resourceCandidates);
+        ResourceHolder *aResource = 0;
+        // This currently requires --enable-vp8-alpha-playback and
+        // needs a video with alpha data to be triggered.
+        if (vquad->a_plane_resource_id())
+            aResource = findAndHoldResource(vquad->a_plane_resource_id(),
+                                            resourceCandidates);
+
+        nodeHandler->setupYUVVideoNode(
+                    initAndHoldTexture(yResource, quad->ShouldDrawWithBlending()),
+                    initAndHoldTexture(uResource, quad->ShouldDrawWithBlending()),
+                    initAndHoldTexture(vResource, quad->ShouldDrawWithBlending()),
+                    aResource
+                        ? initAndHoldTexture(aResource, quad->ShouldDrawWithBlending())
+                        : 0,
+                    toQt(vquad->ya_tex_coord_rect), toQt(vquad->uv_tex_coord_rect),
+                    toQt(vquad->ya_tex_size), toQt(vquad->uv_tex_size),
+                    toQt(vquad->color_space),
+                    vquad->resource_multiplier, vquad->resource_offset,
+                    toQt(quad->rect),
+                    currentLayerChain);
+        break;
 #ifdef GL_OES_EGL_image_external
-            } case cc::DrawQuad::STREAM_VIDEO_CONTENT: {
-                const cc::StreamVideoDrawQuad *squad = cc::StreamVideoDrawQuad::MaterialCast(quad);
-                ResourceHolder *resource = findAndHoldResource(squad->resource_id(),
-                                                               resourceCandidates);
-                MailboxTexture *texture
-                        = static_cast<MailboxTexture *>(
-                            initAndHoldTexture(resource, quad->ShouldDrawWithBlending())
-                            );
-                // since this is not default TEXTURE_2D type
-                texture->setTarget(GL_TEXTURE_EXTERNAL_OES);
-
-                nodeHandler->setupStreamVideoNode(texture, toQt(squad->rect),
-                                                  toQt(squad->matrix.matrix()), currentLayerChain);
-                break;
+    } case cc::DrawQuad::STREAM_VIDEO_CONTENT: {
+        const cc::StreamVideoDrawQuad *squad = cc::StreamVideoDrawQuad::MaterialCast(quad);
+        ResourceHolder *resource = findAndHoldResource(squad->resource_id(),
+                                                       resourceCandidates);
+        MailboxTexture *texture
+                = static_cast<MailboxTexture *>(
+                    initAndHoldTexture(resource, quad->ShouldDrawWithBlending())
+                    );
+        // since this is not default TEXTURE_2D type
+        texture->setTarget(GL_TEXTURE_EXTERNAL_OES);
+
+        nodeHandler->setupStreamVideoNode(texture, toQt(squad->rect),
+                                          toQt(squad->matrix.matrix()), currentLayerChain);
+        break;
 #endif // GL_OES_EGL_image_external
 #endif // QT_NO_OPENGL
-            } case cc::DrawQuad::SURFACE_CONTENT:
-                Q_UNREACHABLE();
-            default:
-                qWarning("Unimplemented quad material: %d", quad->material);
-            }
-        }
+    } case cc::DrawQuad::SURFACE_CONTENT:
+        Q_UNREACHABLE();
+    default:
+        qWarning("Unimplemented quad material: %d", quad->material);
     }
-    // Send resources of remaining candidates back to the child compositors so that
-    // they can be freed or reused.
-    typedef QHash<unsigned, QSharedPointer<ResourceHolder> >::const_iterator
-            ResourceHolderIterator;
-
-    ResourceHolderIterator end = resourceCandidates.constEnd();
-    for (ResourceHolderIterator it = resourceCandidates.constBegin(); it != end ; ++it)
-        resourcesToRelease->push_back((*it)->returnResource());
 }
 
 ResourceHolder *DelegatedFrameNode::findAndHoldResource(unsigned resourceId, QHash<unsigned, QSharedPointer<ResourceHolder> > &candidates)
@@ -1102,46 +2067,250 @@ ResourceHolder *DelegatedFrameNode::findAndHoldResource(unsigned resourceId, QHa
 
 QSGTexture *DelegatedFrameNode::initAndHoldTexture(ResourceHolder *resource, bool quadIsAllOpaque, RenderWidgetHostViewQtDelegate *apiDelegate)
 {
+    // Hand over a texture that was fetched ahead of this commit, initTexture will then pick it up.
+    QSharedPointer<QSGTexture> prefetchedTexture;
+    if (!resource->texture() && !m_prefetchedTextures.isEmpty()) {
+        prefetchedTexture = m_prefetchedTextures.take(resource->transferableResource().id);
+        if (prefetchedTexture)
+            resource->adoptTexture(prefetchedTexture, quadIsAllOpaque);
+    }
+
     // QSGTextures must be destroyed in the scene graph thread as part of the QSGNode tree,
     // so we can't store them with the ResourceHolder in m_chromiumCompositorData.
     // Hold them through a QSharedPointer solely on the root DelegatedFrameNode of the web view
     // and access them through a QWeakPointer from the resource holder to find them later.
+    const bool isNewTexture = !resource->texture();
     m_sgObjects.textureStrongRefs.append(resource->initTexture(quadIsAllOpaque, apiDelegate));
+    const cc::TransferableResource &transferableResource = resource->transferableResource();
+    if (isNewTexture && transferableResource.is_software) {
+        ++m_softwareTextureStats.texturesCreated;
+        m_softwareTextureStats.bytesShared += qint64(transferableResource.size.width()) * transferableResource.size.height() * 4;
+    }
     return m_sgObjects.textureStrongRefs.last().data();
 }
 
+#ifndef QT_NO_OPENGL
+// Maps the damage of a render pass to the texels of a tile quad drawn in it.
+// The tile got a new bitmap, so damage that misses it or lies outside of the pass
+// can't be trusted and the whole texture gets uploaded instead.
+static QRect tileDamageRect(const cc::TileDrawQuad *quad, const cc::RenderPass *pass, const QSize &textureSize)
+{
+    const QRect textureRect(QPoint(), textureSize);
+    if (!pass->output_rect.Contains(pass->damage_rect))
+        return textureRect;
+    gfx::RectF damage(pass->damage_rect);
+    if (!quad->shared_quad_state->quad_to_target_transform.TransformRectReverse(&damage))
+        return textureRect;
+    damage.Intersect(gfx::RectF(quad->rect));
+    if (damage.IsEmpty())
+        return textureRect;
+
+    const gfx::RectF &texCoords = quad->tex_coord_rect;
+    const float scaleX = texCoords.width() / quad->rect.width();
+    const float scaleY = texCoords.height() / quad->rect.height();
+    damage.Offset(-quad->rect.x(), -quad->rect.y());
+    damage.Scale(scaleX, scaleY);
+    damage.Offset(texCoords.x(), texCoords.y());
+    // Linear filtering samples one texel beyond the damage.
+    return toQt(gfx::ToEnclosingRect(damage)).adjusted(-1, -1, 1, 1) & textureRect;
+}
+#endif
+
+// Software tiles get a texture per place on screen instead of one per resource,
+// a new bitmap for the same place then only needs its damaged part to be uploaded.
+QSGTexture *DelegatedFrameNode::initAndHoldTileTexture(ResourceHolder *resource, const cc::TileDrawQuad *quad,
+                                                       const cc::RenderPass *pass,
+                                                       RenderWidgetHostViewQtDelegate *apiDelegate)
+{
+    const bool quadNeedsBlending = quad->ShouldDrawWithBlending();
+#ifndef QT_NO_OPENGL
+    const cc::TransferableResource &transferableResource = resource->transferableResource();
+    // Without an OpenGL context the scene graph uploads the bitmaps itself.
+    if (!transferableResource.is_software || !QOpenGLContext::currentContext())
+        return initAndHoldTexture(resource, quadNeedsBlending, apiDelegate);
+
+    TileSlotKey key;
+    key.passLayerId = pass->id.layer_id;
+    key.passIndex = pass->id.index;
+    key.targetRect = toQt(cc::MathUtil::MapEnclosingClippedRect(quad->shared_quad_state->quad_to_target_transform,
+                                                                quad->rect));
+    key.texCoordRect = toQt(quad->tex_coord_rect).toAlignedRect();
+    key.textureSize = toQt(transferableResource.size);
+
+    QHash<TileSlotKey, TileSlot>::iterator slot = m_tileSlots.find(key);
+    if (slot != m_tileSlots.end()) {
+        slot->ambiguous = true;
+        return initAndHoldTexture(resource, quadNeedsBlending, apiDelegate);
+    }
+    slot = m_tileSlots.insert(key, TileSlot());
+    slot->resourceId = transferableResource.id;
+
+    if (resource->texture()) {
+        // The resource was already drawn in a previous frame, keep using its texture.
+        QSGTexture *texture = initAndHoldTexture(resource, quadNeedsBlending, apiDelegate);
+        const TileSlot previous = m_previousTileSlots.take(key);
+        if (!previous.ambiguous && previous.texture.data() == texture)
+            slot->texture = previous.texture;
+        return texture;
+    }
+
+    const QImage image = sharedBitmapImage(transferableResource, quadNeedsBlending);
+    QSharedPointer<SoftwareTileTexture> texture;
+    const TileSlot previous = m_previousTileSlots.take(key);
+    if (previous.texture && !previous.ambiguous
+            && previous.texture->hasAlphaChannel() == quadNeedsBlending
+            && !m_frameTileResourceIds.contains(previous.resourceId)) {
+        texture = previous.texture;
+        const QRect dirtyRect = tileDamageRect(quad, pass, key.textureSize);
+        texture->setImage(image, dirtyRect);
+        const QRect uploadRect = texture->uploadRect(dirtyRect);
+        const qint64 bytes = qint64(uploadRect.width()) * uploadRect.height() * 4;
+        ++m_softwareTextureStats.texturesUpdated;
+        m_softwareTextureStats.bytesUpdated += bytes;
+        if (texture->convertsPixels())
+            m_softwareTextureStats.bytesConverted += bytes;
+    } else {
+        texture = QSharedPointer<SoftwareTileTexture>(new SoftwareTileTexture(key.textureSize, quadNeedsBlending));
+        texture->setImage(image, QRect(QPoint(), key.textureSize));
+        const qint64 bytes = qint64(key.textureSize.width()) * key.textureSize.height() * 4;
+        ++m_softwareTextureStats.texturesCreated;
+        m_softwareTextureStats.bytesShared += bytes;
+        if (texture->convertsPixels())
+            m_softwareTextureStats.bytesConverted += bytes;
+    }
+    slot->texture = texture;
+    resource->adoptSoftwareTexture(texture);
+    m_sgObjects.textureStrongRefs.append(texture);
+    return texture.data();
+#else
+    Q_UNUSED(pass);
+    return initAndHoldTexture(resource, quadNeedsBlending, apiDelegate);
+#endif
+}
+
+// Starts fetching the textures of all new GPU resources of a frame before it gets committed.
+// Returns true as long as those textures aren't ready and the frame has to be held back.
+bool DelegatedFrameNode::prefetchMailboxes(cc::DelegatedFrameData *frameData)
+{
+#ifndef QT_NO_OPENGL
+    if (isMailboxFetchPending()) {
+        ++m_fetchStats.deferredCommits;
+        return true;
+    }
+    // The previous batch completed, the frame waiting for it can now be committed.
+    if (!m_prefetchedTextures.isEmpty())
+        return false;
+
+    QList<MailboxTexture *> mailboxesToFetch;
+    for (unsigned i = 0; i < frameData->resource_list.size(); ++i) {
+        const cc::TransferableResource &res = frameData->resource_list.at(i);
+        if (res.is_software || m_chromiumCompositorData->resourceHolders.contains(res.id))
+            continue;
+        MailboxTexture *texture = new MailboxTexture(res.mailbox_holder, toQt(res.size));
+        m_prefetchedTextures.insert(res.id, QSharedPointer<QSGTexture>(texture));
+        mailboxesToFetch.append(texture);
+    }
+    if (mailboxesToFetch.isEmpty())
+        return false;
+
+    m_fetchStats = MailboxFetchStats();
+    submitMailboxFetch(mailboxesToFetch, true);
+    return true;
+#else
+    Q_UNUSED(frameData)
+    return false;
+#endif
+}
+
 void DelegatedFrameNode::fetchAndSyncMailboxes(QList<MailboxTexture *> &mailboxesToFetch)
 {
 #ifndef QT_NO_OPENGL
-    QList<gl::TransferableFence> transferredFences;
-    {
-        QMutexLocker lock(&m_mutex);
+    // Let any batch started ahead of time complete first, it shares our fences and counters.
+    waitForMailboxFetch();
+    m_fetchStats = MailboxFetchStats();
+    submitMailboxFetch(mailboxesToFetch, false);
+    waitForMailboxFetch();
+    syncFetchedMailboxes();
 
-        gpu::SyncPointManager *syncPointManager = sync_point_manager();
-        if (!m_syncPointClient)
-            m_syncPointClient = syncPointManager->CreateSyncPointClientWaiter();
-        base::MessageLoop *gpuMessageLoop = gpu_message_loop();
-        Q_ASSERT(m_numPendingSyncPoints == 0);
-        m_numPendingSyncPoints = mailboxesToFetch.count();
-        auto it = mailboxesToFetch.constBegin();
-        auto end = mailboxesToFetch.constEnd();
-        for (; it != end; ++it) {
-            MailboxTexture *mailboxTexture = *it;
-            gpu::SyncToken &syncToken = mailboxTexture->mailboxHolder().sync_token;
-            if (syncToken.HasData()) {
-                scoped_refptr<gpu::SyncPointClientState> release_state =
-                    syncPointManager->GetSyncPointClientState(syncToken.namespace_id(), syncToken.command_buffer_id());
-                if (release_state && !release_state->IsFenceSyncReleased(syncToken.release_count())) {
-                    m_syncPointClient->WaitOutOfOrderNonThreadSafe(
-                                release_state.get(), syncToken.release_count(),
-                                gpuMessageLoop->task_runner(), base::Bind(&DelegatedFrameNode::pullTexture, this, mailboxTexture));
-                    continue;
-                }
+#if defined(USE_X11)
+    if (!m_contextShared)
+        m_textureImporter->importTextures(mailboxesToFetch);
+#endif
+#else
+    Q_UNUSED(mailboxesToFetch)
+#endif //QT_NO_OPENGL
+}
+
+void DelegatedFrameNode::submitMailboxFetch(const QList<MailboxTexture *> &mailboxesToFetch, bool prefetch)
+{
+#ifndef QT_NO_OPENGL
+    QMutexLocker lock(&m_mutex);
+
+    gpu::SyncPointManager *syncPointManager = sync_point_manager();
+    if (!m_syncPointClient)
+        m_syncPointClient = syncPointManager->CreateSyncPointClientWaiter();
+    base::MessageLoop *gpuMessageLoop = gpu_message_loop();
+    Q_ASSERT(m_numPendingSyncPoints == 0);
+    m_numPendingSyncPoints = mailboxesToFetch.count();
+    m_fetchPending = true;
+    m_prefetching = prefetch;
+    m_fetchStatsPending = true;
+    m_fetchStats.mailboxCount = mailboxesToFetch.count();
+    m_fetchTimer.start();
+
+    // Mailboxes whose producer still has to reach their sync point get pulled individually
+    // once it does, all the others are pulled together in a single GPU thread task.
+    QVector<MailboxTexture *> readyMailboxes;
+    readyMailboxes.reserve(mailboxesToFetch.count());
+    auto it = mailboxesToFetch.constBegin();
+    auto end = mailboxesToFetch.constEnd();
+    for (; it != end; ++it) {
+        MailboxTexture *mailboxTexture = *it;
+        gpu::SyncToken &syncToken = mailboxTexture->mailboxHolder().sync_token;
+        if (syncToken.HasData()) {
+            scoped_refptr<gpu::SyncPointClientState> release_state =
+                syncPointManager->GetSyncPointClientState(syncToken.namespace_id(), syncToken.command_buffer_id());
+            if (release_state && !release_state->IsFenceSyncReleased(syncToken.release_count())) {
+                m_syncPointClient->WaitOutOfOrderNonThreadSafe(
+                            release_state.get(), syncToken.release_count(),
+                            gpuMessageLoop->task_runner(), base::Bind(&DelegatedFrameNode::pullTexture, this, mailboxTexture));
+                continue;
             }
-            gpuMessageLoop->task_runner()->PostTask(FROM_HERE, base::Bind(&DelegatedFrameNode::pullTexture, this, mailboxTexture));
         }
+        readyMailboxes.append(mailboxTexture);
+    }
+    if (!readyMailboxes.isEmpty())
+        gpuMessageLoop->task_runner()->PostTask(FROM_HERE, base::Bind(&DelegatedFrameNode::pullTextures, this, readyMailboxes));
+#else
+    Q_UNUSED(mailboxesToFetch)
+    Q_UNUSED(prefetch)
+#endif
+}
 
+void DelegatedFrameNode::waitForMailboxFetch()
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_fetchPending)
+        return;
+    QElapsedTimer blockedTimer;
+    blockedTimer.start();
+    while (m_fetchPending)
         m_mailboxesFetchedWaitCond.wait(&m_mutex);
+    m_fetchStats.blockedTime = blockedTimer.nsecsElapsed();
+}
+
+bool DelegatedFrameNode::isMailboxFetchPending()
+{
+    QMutexLocker lock(&m_mutex);
+    return m_fetchPending;
+}
+
+void DelegatedFrameNode::syncFetchedMailboxes()
+{
+#ifndef QT_NO_OPENGL
+    QList<gl::TransferableFence> transferredFences;
+    {
+        QMutexLocker lock(&m_mutex);
         m_textureFences.swap(transferredFences);
     }
 
@@ -1152,96 +2321,54 @@ void DelegatedFrameNode::fetchAndSyncMailboxes(QList<MailboxTexture *> &mailboxe
         waitChromiumSync(&sync);
         deleteChromiumSync(&sync);
     }
-
-#if defined(USE_X11)
-    // Workaround when context is not shared QTBUG-48969
-    // Make slow copy between two contexts.
-    if (!m_contextShared) {
-        QOpenGLContext *currentContext = QOpenGLContext::currentContext() ;
-        QOpenGLContext *sharedContext = qt_gl_global_share_context();
-
-        QSurface *surface = currentContext->surface();
-        Q_ASSERT(m_offsurface);
-        sharedContext->makeCurrent(m_offsurface.data());
-        QOpenGLFunctions *funcs = sharedContext->functions();
-
-        GLuint fbo = 0;
-        funcs->glGenFramebuffers(1, &fbo);
-
-        Q_FOREACH (MailboxTexture *mailboxTexture, mailboxesToFetch) {
-            // Read texture into QImage from shared context.
-            // Switch to shared context.
-            sharedContext->makeCurrent(m_offsurface.data());
-            funcs = sharedContext->functions();
-            QImage img(mailboxTexture->textureSize(), QImage::Format_RGBA8888_Premultiplied);
-            funcs->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-            funcs->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mailboxTexture->m_textureId, 0);
-            GLenum status = funcs->glCheckFramebufferStatus(GL_FRAMEBUFFER);
-            if (status != GL_FRAMEBUFFER_COMPLETE) {
-                qWarning("fbo error, skipping slow copy...");
-                continue;
-            }
-            funcs->glReadPixels(0, 0, mailboxTexture->textureSize().width(), mailboxTexture->textureSize().height(),
-                                GL_RGBA, GL_UNSIGNED_BYTE, img.bits());
-
-            // Restore current context.
-            // Create texture from QImage in current context.
-            currentContext->makeCurrent(surface);
-            GLuint texture = 0;
-            funcs = currentContext->functions();
-            funcs->glGenTextures(1, &texture);
-            funcs->glBindTexture(GL_TEXTURE_2D, texture);
-            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            funcs->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, mailboxTexture->textureSize().width(), mailboxTexture->textureSize().height(), 0,
-                                GL_RGBA, GL_UNSIGNED_BYTE, img.bits());
-            mailboxTexture->m_textureId = texture;
-            mailboxTexture->m_ownsTexture = true;
-        }
-        // Cleanup allocated resources
-        sharedContext->makeCurrent(m_offsurface.data());
-        funcs = sharedContext->functions();
-        funcs->glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        funcs->glDeleteFramebuffers(1, &fbo);
-        currentContext->makeCurrent(surface);
-    }
 #endif
-#else
-    Q_UNUSED(mailboxesToFetch)
-#endif //QT_NO_OPENGL
 }
 
-
 void DelegatedFrameNode::pullTexture(DelegatedFrameNode *frameNode, MailboxTexture *texture)
+{
+    pullTextures(frameNode, QVector<MailboxTexture *>() << texture);
+}
+
+void DelegatedFrameNode::pullTextures(DelegatedFrameNode *frameNode, const QVector<MailboxTexture *> &textures)
 {
 #ifndef QT_NO_OPENGL
     gpu::gles2::MailboxManager *mailboxManager = mailbox_manager();
-    gpu::SyncToken &syncToken = texture->mailboxHolder().sync_token;
-    if (syncToken.HasData())
-        mailboxManager->PullTextureUpdates(syncToken);
-    texture->fetchTexture(mailboxManager);
+    Q_FOREACH (MailboxTexture *texture, textures) {
+        gpu::SyncToken &syncToken = texture->mailboxHolder().sync_token;
+        if (syncToken.HasData())
+            mailboxManager->PullTextureUpdates(syncToken);
+        texture->fetchTexture(mailboxManager);
+    }
+
+    QMutexLocker lock(&frameNode->m_mutex);
     if (!!gl::GLContext::GetCurrent() && gl::GLFence::IsSupported()) {
-        // Create a fence on the Chromium GPU-thread and context
+        // Create a fence on the Chromium GPU-thread and context.
+        // A single one covers all the textures pulled above.
         gl::GLFence *fence = gl::GLFence::Create();
         // But transfer it to something generic since we need to read it using Qt's OpenGL.
         frameNode->m_textureFences.append(fence->Transfer());
         delete fence;
     }
-    if (--frameNode->m_numPendingSyncPoints == 0)
+    frameNode->m_numPendingSyncPoints -= textures.count();
+    if (frameNode->m_numPendingSyncPoints == 0)
         base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(&DelegatedFrameNode::fenceAndUnlockQt, frameNode));
 #else
     Q_UNUSED(frameNode)
-    Q_UNUSED(texture)
+    Q_UNUSED(textures)
 #endif
 }
 
 void DelegatedFrameNode::fenceAndUnlockQt(DelegatedFrameNode *frameNode)
 {
     QMutexLocker lock(&frameNode->m_mutex);
+    frameNode->m_fetchPending = false;
+    frameNode->m_fetchStats.latency = frameNode->m_fetchTimer.nsecsElapsed();
     // Signal preprocess() the textures are ready
     frameNode->m_mailboxesFetchedWaitCond.wakeOne();
+    // Nothing waits on a prefetch, the held back frame can be committed on the next update.
+    if (frameNode->m_prefetching && !frameNode->m_prefetchCallback.is_null())
+        frameNode->m_prefetchCallback.Run();
+    frameNode->m_prefetching = false;
 }
 
 } // namespace QtWebEngineCore
@@ -40,16 +40,19 @@
 #ifndef DELEGATED_FRAME_NODE_H
 #define DELEGATED_FRAME_NODE_H
 
+#include "base/callback.h"
 #include "cc/quads/render_pass.h"
 #include "cc/resources/transferable_resource.h"
 #include "gpu/command_buffer/service/sync_point_manager.h"
 #include "ui/gl/gl_fence.h"
+#include <QElapsedTimer>
 #include <QMutex>
+#include <QRect>
+#include <QSet>
 #include <QSGNode>
 #include <QSharedData>
 #include <QSharedPointer>
 #include <QWaitCondition>
-#include <QtGui/QOffscreenSurface>
 
 #include "chromium_gpu_helper.h"
 #include "render_widget_host_view_qt_delegate.h"
@@ -60,12 +63,20 @@ QT_END_NAMESPACE
 
 namespace cc {
 class DelegatedFrameData;
+class TileDrawQuad;
 }
 
 namespace QtWebEngineCore {
 
+#if defined(USE_X11)
+class CrossContextTextureImporter;
+#endif
+class DelegatedNodePool;
+class DelegatedNodeTreeHandler;
+class FrameTimingRecorder;
 class MailboxTexture;
 class ResourceHolder;
+class SoftwareTileTexture;
 
 // Separating this data allows another DelegatedFrameNode to reconstruct the QSGNode tree from the mailbox textures
 // and render pass information.
@@ -74,42 +85,220 @@ public:
     ChromiumCompositorData() : frameDevicePixelRatio(1) { }
     QHash<unsigned, QSharedPointer<ResourceHolder> > resourceHolders;
     std::unique_ptr<cc::DelegatedFrameData> frameData;
-    std::unique_ptr<cc::DelegatedFrameData> previousFrameData;
     qreal frameDevicePixelRatio;
 };
 
+// Timing of the last mailbox fetch round trip to the Chromium GPU thread.
+// All durations are in nanoseconds.
+struct MailboxFetchStats {
+    MailboxFetchStats() : mailboxCount(0), latency(0), blockedTime(0), deferredCommits(0) { }
+    int mailboxCount;
+    // Time from submitting the batch until all textures were pulled and fenced.
+    qint64 latency;
+    // Time the render thread spent blocked waiting for the batch.
+    qint64 blockedTime;
+    // Number of commits that kept the previous frame while the batch was in flight.
+    int deferredCommits;
+};
+
+// Number of scene graph nodes touched by the last commit.
+// Reused nodes include the ones taken from the node pool, deleted ones
+// the nodes removed from the tree, whether they went to the pool or not.
+struct NodeTreeStats {
+    NodeTreeStats() : nodesCreated(0), nodesReused(0), nodesDeleted(0) { }
+    int nodesCreated;
+    int nodesReused;
+    int nodesDeleted;
+};
+
+// Software compositor bitmaps turned into textures by the last commit.
+// The pixels are handed to the scene graph straight from the shared memory,
+// bytesShared is the amount of pixel data that doesn't get copied on the way.
+// Tiles drawn at the same place as in the previous frame keep their texture
+// and only get the damaged part of their new bitmap uploaded, bytesUpdated.
+// bytesConverted is the part of both that gets copied to another pixel format
+// before being uploaded.
+struct SoftwareTextureStats {
+    SoftwareTextureStats() : texturesCreated(0), bytesShared(0), texturesUpdated(0), bytesUpdated(0), bytesConverted(0) { }
+    int texturesCreated;
+    qint64 bytesShared;
+    int texturesUpdated;
+    qint64 bytesUpdated;
+    qint64 bytesConverted;
+};
+
+struct NodePoolStats {
+    NodePoolStats() : hits(0), misses(0), pooledNodes(0), capacity(0) { }
+    qreal hitRate() const { return hits + misses ? qreal(hits) / (hits + misses) : 0; }
+    quint64 hits;
+    quint64 misses;
+    int pooledNodes;
+    // Peak number of nodes used by recent frames, the pool never holds more.
+    int capacity;
+};
+
+// Identifies a quad across frames to let its node be reused by a quad with the same key.
+struct QuadKey {
+    QuadKey() : material(0), resourceId(0) { }
+    QuadKey(int material, unsigned resourceId, const QRect &rect)
+        : material(material), resourceId(resourceId), rect(rect) { }
+    int material;
+    unsigned resourceId;
+    QRect rect;
+};
+
+inline bool operator==(const QuadKey &a, const QuadKey &b)
+{
+    return a.material == b.material && a.resourceId == b.resourceId && a.rect == b.rect;
+}
+
+inline uint qHash(const QuadKey &key, uint seed = 0)
+{
+    return qHash(key.material, seed) ^ qHash(key.resourceId, seed)
+        ^ qHash(key.rect.x() ^ (key.rect.y() << 16), seed) ^ qHash(key.rect.width() ^ (key.rect.height() << 16), seed);
+}
+
+// Identifies the place of a software compositor tile in its render pass across frames.
+struct TileSlotKey {
+    TileSlotKey() : passLayerId(0), passIndex(0) { }
+    int passLayerId;
+    uint passIndex;
+    // The quad rect mapped to the render pass and the texels it samples.
+    QRect targetRect;
+    QRect texCoordRect;
+    QSize textureSize;
+};
+
+inline bool operator==(const TileSlotKey &a, const TileSlotKey &b)
+{
+    return a.passLayerId == b.passLayerId && a.passIndex == b.passIndex && a.targetRect == b.targetRect
+        && a.texCoordRect == b.texCoordRect && a.textureSize == b.textureSize;
+}
+
+inline uint qHash(const TileSlotKey &key, uint seed = 0)
+{
+    return qHash(key.passLayerId, seed) ^ qHash(key.passIndex, seed)
+        ^ qHash(key.targetRect.x() ^ (key.targetRect.y() << 16), seed)
+        ^ qHash(key.targetRect.width() ^ (key.targetRect.height() << 16), seed)
+        ^ qHash(key.texCoordRect.x() ^ (key.texCoordRect.y() << 16), seed);
+}
+
 class DelegatedFrameNode : public QSGTransformNode {
 public:
     DelegatedFrameNode();
     ~DelegatedFrameNode();
     void preprocess();
-    void commit(ChromiumCompositorData *chromiumCompositorData, cc::ReturnedResourceArray *resourcesToRelease, RenderWidgetHostViewQtDelegate *apiDelegate);
+    // Returns false if the frame couldn't be applied yet because its textures are still being
+    // fetched in pipelined mode. The previous frame stays on screen and the caller must
+    // hold the frame ack and commit again on a later update.
+    bool commit(ChromiumCompositorData *chromiumCompositorData, cc::ReturnedResourceArray *resourcesToRelease, RenderWidgetHostViewQtDelegate *apiDelegate);
+
+    // Fetches the textures of new frames ahead of their commit. Ignored when the Qt
+    // context isn't shared with Chromium's.
+    void setPipelinedMailboxFetch(bool enabled);
+    // Run on the Chromium GPU thread once textures fetched ahead of a commit are ready.
+    void setMailboxPrefetchCallback(const base::Closure &callback);
+    const MailboxFetchStats &lastMailboxFetchStats() const { return m_fetchStats; }
+    const NodeTreeStats &lastNodeTreeStats() const { return m_treeStats; }
+    const SoftwareTextureStats &lastSoftwareTextureStats() const { return m_softwareTextureStats; }
+    NodePoolStats nodePoolStats() const;
+    void setFrameTimingRecorder(const QSharedPointer<FrameTimingRecorder> &recorder) { m_frameTimingRecorder = recorder; }
 
 private:
+    // The nodes built for a run of quads sharing the same SharedQuadState.
+    struct LayerChain {
+        LayerChain() : clipNode(0), transformNode(0), opacityNode(0), shapeHash(0), reusable(true) { }
+        // Creates the clip, transform and opacity nodes needed by layerState under renderPassChain.
+        void build(QSGNode *renderPassChain, const cc::SharedQuadState *layerState,
+                   DelegatedNodePool *nodePool, NodeTreeStats *stats);
+        void update(const cc::SharedQuadState *layerState);
+        // Hands all remaining nodes over to the pool and returns how many there were.
+        int release(DelegatedNodePool *nodePool);
+        QSGNode *outerNode() const;
+        QSGNode *innerNode(QSGNode *renderPassChain) const;
+        bool hasSameShape(const LayerChain &other) const;
+        QSGClipNode *clipNode;
+        QSGTransformNode *transformNode;
+        QSGOpacityNode *opacityNode;
+        QVector<QSGNode *> contentNodes;
+        QVector<QuadKey> quadKeys;
+        uint shapeHash;
+        // Video quads always get new nodes.
+        bool reusable;
+    };
+    struct RenderPassNodes {
+        RenderPassNodes() : renderPassChain(0) { }
+        cc::RenderPassId id;
+        QSharedPointer<QSGRootNode> rootNode;
+        QSGNode *renderPassChain;
+        QVector<LayerChain> layerChains;
+    };
+
+    void commitRenderPass(cc::RenderPass *pass, RenderPassNodes *passNodes, QVector<LayerChain> *previousLayerChains,
+                          QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates,
+                          RenderWidgetHostViewQtDelegate *apiDelegate);
+    void handleQuad(const cc::DrawQuad *quad, const cc::RenderPass *pass, QSGNode *layerChain,
+                    DelegatedNodeTreeHandler *nodeHandler,
+                    QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates,
+                    RenderWidgetHostViewQtDelegate *apiDelegate);
+    bool prefetchMailboxes(cc::DelegatedFrameData *frameData);
     void fetchAndSyncMailboxes(QList<MailboxTexture *> &mailboxesToFetch);
+    void submitMailboxFetch(const QList<MailboxTexture *> &mailboxesToFetch, bool prefetch);
+    void waitForMailboxFetch();
+    bool isMailboxFetchPending();
+    void syncFetchedMailboxes();
     // Making those callbacks static bypasses base::Bind's ref-counting requirement
     // of the this pointer when the callback is a method.
     static void pullTexture(DelegatedFrameNode *frameNode, MailboxTexture *mailbox);
+    static void pullTextures(DelegatedFrameNode *frameNode, const QVector<MailboxTexture *> &mailboxes);
     static void fenceAndUnlockQt(DelegatedFrameNode *frameNode);
 
     ResourceHolder *findAndHoldResource(unsigned resourceId, QHash<unsigned, QSharedPointer<ResourceHolder> > &candidates);
     QSGTexture *initAndHoldTexture(ResourceHolder *resource, bool quadIsAllOpaque, RenderWidgetHostViewQtDelegate *apiDelegate = 0);
+    QSGTexture *initAndHoldTileTexture(ResourceHolder *resource, const cc::TileDrawQuad *quad, const cc::RenderPass *pass,
+                                       RenderWidgetHostViewQtDelegate *apiDelegate);
 
     QExplicitlySharedDataPointer<ChromiumCompositorData> m_chromiumCompositorData;
     struct SGObjects {
         QVector<QPair<cc::RenderPassId, QSharedPointer<QSGLayer> > > renderPassLayers;
-        QVector<QSharedPointer<QSGRootNode> > renderPassRootNodes;
         QVector<QSharedPointer<QSGTexture> > textureStrongRefs;
     } m_sgObjects;
-    QVector<QSGNode*> m_sceneGraphNodes;
+    QVector<RenderPassNodes> m_renderPassNodes;
+    NodeTreeStats m_treeStats;
+    SoftwareTextureStats m_softwareTextureStats;
+    struct TileSlot {
+        TileSlot() : resourceId(0), ambiguous(false) { }
+        QSharedPointer<SoftwareTileTexture> texture;
+        unsigned resourceId;
+        // More than one tile was found at this place, none of them can inherit the texture.
+        bool ambiguous;
+    };
+    // Software tile textures by their place in the current and previous frame.
+    QHash<TileSlotKey, TileSlot> m_tileSlots;
+    QHash<TileSlotKey, TileSlot> m_previousTileSlots;
+    // Resources drawn by tile quads of the frame being committed.
+    QSet<unsigned> m_frameTileResourceIds;
+    QScopedPointer<DelegatedNodePool> m_nodePool;
+    QSharedPointer<FrameTimingRecorder> m_frameTimingRecorder;
     int m_numPendingSyncPoints;
+    bool m_fetchPending;
     QWaitCondition m_mailboxesFetchedWaitCond;
     QMutex m_mutex;
     QList<gl::TransferableFence> m_textureFences;
     std::unique_ptr<gpu::SyncPointClient> m_syncPointClient;
+    // Textures of the next frame being fetched ahead of time in pipelined mode, by resource ID.
+    QHash<unsigned, QSharedPointer<QSGTexture> > m_prefetchedTextures;
+    bool m_pipelinedFetch;
+    // Whether the batch in flight was started ahead of a commit.
+    bool m_prefetching;
+    base::Closure m_prefetchCallback;
+    QElapsedTimer m_fetchTimer;
+    MailboxFetchStats m_fetchStats;
+    // The stats of the last batch haven't been given to the frame timing recorder yet.
+    bool m_fetchStatsPending;
 #if defined(USE_X11)
     bool m_contextShared;
-    QScopedPointer<QOffscreenSurface> m_offsurface;
+    QScopedPointer<CrossContextTextureImporter> m_textureImporter;
 #endif
 };
 
@@ -0,0 +1,299 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "frame_timing_recorder.h"
+
+#include "delegated_frame_node.h"
+
+#include "base/process/process_handle.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+namespace QtWebEngineCore {
+
+// About 16 seconds at 60 frames per second.
+static const int kMaxRecordedFrames = 1000;
+
+static qint64 now()
+{
+    return (base::TimeTicks::Now() - base::TimeTicks()).InMicroseconds();
+}
+
+static qint64 currentThreadId()
+{
+    return base::PlatformThread::CurrentId();
+}
+
+FrameTiming::FrameTiming()
+    : frameId(0)
+    , swapTime(0)
+    , commitStartTime(0)
+    , commitEndTime(0)
+    , preprocessStartTime(0)
+    , preprocessEndTime(0)
+    , ackTime(0)
+    , renderPassCount(0)
+    , quadCount(0)
+    , resourcesImported(0)
+    , resourcesReturned(0)
+    , deferredCommits(0)
+    , mailboxesFetched(0)
+    , mailboxFetchLatency(0)
+    , mailboxFetchBlockedTime(0)
+    , nodesCreated(0)
+    , nodesReused(0)
+    , softwareBytesUploaded(0)
+    , softwareBytesConverted(0)
+    , treeRebuilt(false)
+{
+}
+
+FrameTimingRecorder::FrameTimingRecorder()
+    : m_nextFrameId(1)
+    , m_swappedFrameId(0)
+    , m_committedFrameId(0)
+    , m_uiThreadId(0)
+    , m_renderThreadId(0)
+{
+}
+
+FrameTiming *FrameTimingRecorder::findFrame(quint64 frameId)
+{
+    // Stages always concern one of the last few frames.
+    for (int i = m_frames.size() - 1; i >= 0; --i) {
+        if (m_frames.at(i).frameId == frameId)
+            return &m_frames[i];
+        if (m_frames.at(i).frameId < frameId)
+            break;
+    }
+    return nullptr;
+}
+
+void FrameTimingRecorder::frameSwapped(int renderPassCount, int quadCount, int resourcesImported)
+{
+    QMutexLocker locker(&m_mutex);
+    m_uiThreadId = currentThreadId();
+    if (m_frames.size() == kMaxRecordedFrames)
+        m_frames.removeFirst();
+    FrameTiming frame;
+    frame.frameId = m_nextFrameId++;
+    frame.swapTime = now();
+    frame.renderPassCount = renderPassCount;
+    frame.quadCount = quadCount;
+    frame.resourcesImported = resourcesImported;
+    m_frames.append(frame);
+    m_swappedFrameId = frame.frameId;
+}
+
+void FrameTimingRecorder::commitStarted()
+{
+    QMutexLocker locker(&m_mutex);
+    m_renderThreadId = currentThreadId();
+    if (FrameTiming *frame = findFrame(m_swappedFrameId))
+        frame->commitStartTime = now();
+}
+
+void FrameTimingRecorder::commitFinished(bool applied, int resourcesReturned, const NodeTreeStats &stats,
+                                         const SoftwareTextureStats &softwareTextureStats)
+{
+    QMutexLocker locker(&m_mutex);
+    FrameTiming *frame = findFrame(m_swappedFrameId);
+    if (!frame)
+        return;
+    frame->commitEndTime = now();
+    if (!applied) {
+        ++frame->deferredCommits;
+        return;
+    }
+    frame->resourcesReturned = resourcesReturned;
+    frame->nodesCreated = stats.nodesCreated;
+    frame->nodesReused = stats.nodesReused;
+    frame->softwareBytesUploaded = softwareTextureStats.bytesShared + softwareTextureStats.bytesUpdated;
+    frame->softwareBytesConverted = softwareTextureStats.bytesConverted;
+    frame->treeRebuilt = !stats.nodesReused;
+    m_committedFrameId = frame->frameId;
+}
+
+void FrameTimingRecorder::preprocessStarted()
+{
+    QMutexLocker locker(&m_mutex);
+    // Every scene graph render preprocesses the node, only the first one after a commit counts.
+    FrameTiming *frame = findFrame(m_committedFrameId);
+    if (frame && !frame->preprocessStartTime)
+        frame->preprocessStartTime = now();
+}
+
+void FrameTimingRecorder::preprocessFinished()
+{
+    QMutexLocker locker(&m_mutex);
+    FrameTiming *frame = findFrame(m_committedFrameId);
+    if (frame && frame->preprocessStartTime && !frame->preprocessEndTime)
+        frame->preprocessEndTime = now();
+}
+
+void FrameTimingRecorder::mailboxesFetched(const MailboxFetchStats &stats)
+{
+    QMutexLocker locker(&m_mutex);
+    if (FrameTiming *frame = findFrame(m_committedFrameId)) {
+        frame->mailboxesFetched = stats.mailboxCount;
+        frame->mailboxFetchLatency = stats.latency / 1000;
+        frame->mailboxFetchBlockedTime = stats.blockedTime / 1000;
+    }
+}
+
+void FrameTimingRecorder::frameAcked()
+{
+    QMutexLocker locker(&m_mutex);
+    if (FrameTiming *frame = findFrame(m_swappedFrameId))
+        frame->ackTime = now();
+}
+
+QList<FrameTiming> FrameTimingRecorder::frames() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frames;
+}
+
+void FrameTimingRecorder::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_frames.clear();
+}
+
+static QVariantMap frameCounters(const FrameTiming &frame)
+{
+    QVariantMap counters;
+    counters.insert(QStringLiteral("frameId"), qint64(frame.frameId));
+    counters.insert(QStringLiteral("renderPasses"), frame.renderPassCount);
+    counters.insert(QStringLiteral("quads"), frame.quadCount);
+    counters.insert(QStringLiteral("resourcesImported"), frame.resourcesImported);
+    counters.insert(QStringLiteral("resourcesReturned"), frame.resourcesReturned);
+    counters.insert(QStringLiteral("deferredCommits"), frame.deferredCommits);
+    counters.insert(QStringLiteral("mailboxesFetched"), frame.mailboxesFetched);
+    counters.insert(QStringLiteral("mailboxFetchLatency"), frame.mailboxFetchLatency);
+    counters.insert(QStringLiteral("mailboxFetchBlockedTime"), frame.mailboxFetchBlockedTime);
+    counters.insert(QStringLiteral("nodesCreated"), frame.nodesCreated);
+    counters.insert(QStringLiteral("nodesReused"), frame.nodesReused);
+    counters.insert(QStringLiteral("softwareBytesUploaded"), frame.softwareBytesUploaded);
+    counters.insert(QStringLiteral("softwareBytesConverted"), frame.softwareBytesConverted);
+    counters.insert(QStringLiteral("treeRebuilt"), frame.treeRebuilt);
+    counters.insert(QStringLiteral("acked"), frame.ackTime != 0);
+    return counters;
+}
+
+QVariantList FrameTimingRecorder::toVariantList() const
+{
+    QMutexLocker locker(&m_mutex);
+    QVariantList frames;
+    Q_FOREACH (const FrameTiming &frame, m_frames) {
+        QVariantMap timing = frameCounters(frame);
+        timing.insert(QStringLiteral("swapTime"), frame.swapTime);
+        timing.insert(QStringLiteral("commitStartTime"), frame.commitStartTime);
+        timing.insert(QStringLiteral("commitEndTime"), frame.commitEndTime);
+        timing.insert(QStringLiteral("preprocessStartTime"), frame.preprocessStartTime);
+        timing.insert(QStringLiteral("preprocessEndTime"), frame.preprocessEndTime);
+        timing.insert(QStringLiteral("ackTime"), frame.ackTime);
+        frames.append(timing);
+    }
+    return frames;
+}
+
+static QJsonObject traceEvent(const char *name, qint64 pid, qint64 tid, qint64 start, qint64 end)
+{
+    QJsonObject event;
+    event.insert(QStringLiteral("name"), QLatin1String(name));
+    event.insert(QStringLiteral("cat"), QStringLiteral("qtwebengine"));
+    event.insert(QStringLiteral("ph"), QStringLiteral("X"));
+    event.insert(QStringLiteral("pid"), pid);
+    event.insert(QStringLiteral("tid"), tid);
+    event.insert(QStringLiteral("ts"), start);
+    event.insert(QStringLiteral("dur"), end - start);
+    return event;
+}
+
+static QJsonObject threadNameEvent(qint64 pid, qint64 tid, const char *name)
+{
+    QJsonObject args;
+    args.insert(QStringLiteral("name"), QLatin1String(name));
+    QJsonObject event;
+    event.insert(QStringLiteral("name"), QStringLiteral("thread_name"));
+    event.insert(QStringLiteral("ph"), QStringLiteral("M"));
+    event.insert(QStringLiteral("pid"), pid);
+    event.insert(QStringLiteral("tid"), tid);
+    event.insert(QStringLiteral("args"), args);
+    return event;
+}
+
+QByteArray FrameTimingRecorder::toTraceEventJson() const
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 pid = base::GetCurrentProcId();
+    QJsonArray events;
+    if (m_uiThreadId)
+        events.append(threadNameEvent(pid, m_uiThreadId, "CrBrowserMain"));
+    if (m_renderThreadId && m_renderThreadId != m_uiThreadId)
+        events.append(threadNameEvent(pid, m_renderThreadId, "QSGRenderThread"));
+
+    Q_FOREACH (const FrameTiming &frame, m_frames) {
+        // A frame spans from its swap to its ack, or to the end of its last recorded stage.
+        const qint64 end = qMax(qMax(frame.ackTime, frame.commitEndTime), qMax(frame.preprocessEndTime, frame.swapTime));
+        QJsonObject frameEvent = traceEvent("CompositorFrame", pid, m_uiThreadId, frame.swapTime, end);
+        frameEvent.insert(QStringLiteral("args"), QJsonObject::fromVariantMap(frameCounters(frame)));
+        events.append(frameEvent);
+
+        if (frame.commitEndTime)
+            events.append(traceEvent("DelegatedFrameNode::commit", pid, m_renderThreadId,
+                                     frame.commitStartTime, frame.commitEndTime));
+        if (frame.preprocessEndTime)
+            events.append(traceEvent("DelegatedFrameNode::preprocess", pid, m_renderThreadId,
+                                     frame.preprocessStartTime, frame.preprocessEndTime));
+    }
+
+    QJsonObject trace;
+    trace.insert(QStringLiteral("traceEvents"), events);
+    trace.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,129 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef FRAME_TIMING_RECORDER_H
+#define FRAME_TIMING_RECORDER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QVariant>
+
+namespace QtWebEngineCore {
+
+struct MailboxFetchStats;
+struct NodeTreeStats;
+struct SoftwareTextureStats;
+
+// Timestamps and counters of a compositor frame on its way from the child compositor
+// to the scene graph. Timestamps are in microseconds on the same clock as Chromium's
+// trace events, 0 for the stages that didn't run (yet).
+struct FrameTiming {
+    FrameTiming();
+    quint64 frameId;
+    // RenderWidgetHostViewQt::OnSwapCompositorFrame, UI thread.
+    qint64 swapTime;
+    // DelegatedFrameNode::commit called from updatePaintNode, render thread.
+    qint64 commitStartTime;
+    qint64 commitEndTime;
+    // DelegatedFrameNode::preprocess, includes waiting for the mailbox textures.
+    qint64 preprocessStartTime;
+    qint64 preprocessEndTime;
+    // RenderWidgetHostViewQt::sendDelegatedFrameAck, UI thread.
+    qint64 ackTime;
+    int renderPassCount;
+    int quadCount;
+    int resourcesImported;
+    int resourcesReturned;
+    // Commits that kept the previous frame while textures were fetched ahead.
+    int deferredCommits;
+    // GPU textures fetched for the frame, and the time it took in microseconds.
+    int mailboxesFetched;
+    qint64 mailboxFetchLatency;
+    // Part of the fetch the render thread spent blocked on, in microseconds.
+    qint64 mailboxFetchBlockedTime;
+    int nodesCreated;
+    int nodesReused;
+    // Software compositor bitmaps uploaded to textures for the frame, in bytes, and the
+    // part of them that had to be converted to another pixel format first.
+    qint64 softwareBytesUploaded;
+    qint64 softwareBytesConverted;
+    // True if no node of the previous tree could be updated in place.
+    bool treeRebuilt;
+};
+
+// Records the FrameTiming of the last frames of a view. Stages are reported from both
+// the UI and the scene graph render thread.
+class FrameTimingRecorder {
+public:
+    FrameTimingRecorder();
+
+    void frameSwapped(int renderPassCount, int quadCount, int resourcesImported);
+    void commitStarted();
+    void commitFinished(bool applied, int resourcesReturned, const NodeTreeStats &stats,
+                        const SoftwareTextureStats &softwareTextureStats);
+    void preprocessStarted();
+    void preprocessFinished();
+    void mailboxesFetched(const MailboxFetchStats &stats);
+    void frameAcked();
+
+    QList<FrameTiming> frames() const;
+    void clear();
+    // The recorded frames as maps of their timestamps and counters, with the keys used
+    // for the arguments of the CompositorFrame trace events.
+    QVariantList toVariantList() const;
+    // The recorded frames in the Chrome trace event format, as loaded by chrome://tracing.
+    QByteArray toTraceEventJson() const;
+
+private:
+    FrameTiming *findFrame(quint64 frameId);
+
+    mutable QMutex m_mutex;
+    QList<FrameTiming> m_frames;
+    quint64 m_nextFrameId;
+    // The frame last swapped in, and the last one committed to the scene graph.
+    quint64 m_swappedFrameId;
+    quint64 m_committedFrameId;
+    qint64 m_uiThreadId;
+    qint64 m_renderThreadId;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // FRAME_TIMING_RECORDER_H
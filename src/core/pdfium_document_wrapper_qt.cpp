@@ -40,15 +40,23 @@
 #include "pdfium_document_wrapper_qt.h"
 
 #include <QtCore/qhash.h>
+#include <QtCore/qrunnable.h>
 #include <QtGui/qimage.h>
 #include <QtGui/qpainter.h>
 
+#include <climits>
+
 #include "third_party/pdfium/public/fpdf_doc.h"
 #include "third_party/pdfium/public/fpdfview.h"
 
 namespace QtWebEngineCore {
 int PdfiumDocumentWrapperQt::m_libraryUsers = 0;
 
+static const int kDefaultCacheBudget = 128 * 1024 * 1024;
+
+// PDFium is not thread safe, every call into it has to hold this lock.
+Q_GLOBAL_STATIC(QMutex, pdfiumMutex)
+
 class QWEBENGINE_EXPORT PdfiumPageWrapperQt {
 public:
     PdfiumPageWrapperQt(void *data, int pageIndex, int targetWidth, int targetHeight)
@@ -89,7 +97,12 @@ private:
         if (targetHeight <= 0)
             targetHeight = m_height;
 
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        // ARGB32 is laid out as BGRA in memory, so PDFium can render straight into it.
+        QImage image(targetWidth, targetHeight, QImage::Format_ARGB32);
+#else
         QImage image(targetWidth, targetHeight, QImage::Format_RGBA8888);
+#endif
         Q_ASSERT(!image.isNull());
         image.fill(0xFFFFFFFF);
 
@@ -104,6 +117,7 @@ private:
         FPDFBitmap_Destroy(bitmap);
         bitmap = nullptr;
 
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
         // Map BGRA to RGBA as PDFium currently does not support RGBA bitmaps directly
         for (int i = 0; i < image.height(); i++) {
             uchar *pixels = image.scanLine(i);
@@ -112,6 +126,7 @@ private:
                 pixels += 4;
             }
         }
+#endif
         return image;
     }
 
@@ -123,12 +138,54 @@ private:
     QImage m_image;
 };
 
+class PdfiumPrefetchTask : public QRunnable {
+public:
+    PdfiumPrefetchTask(PdfiumDocumentWrapperQt *wrapper, int first, int last)
+        : m_wrapper(wrapper)
+        , m_first(first)
+        , m_last(last)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        const int step = m_first <= m_last ? 1 : -1;
+        for (int index = m_first; index != m_last + step; index += step) {
+            {
+                QMutexLocker lock(&m_wrapper->m_cacheMutex);
+                // Don't get so far ahead that the cache evicts pages that were not consumed yet.
+                while (!m_wrapper->m_cancelPrefetch && m_wrapper->m_prefetchedBytes > 0
+                       && m_wrapper->m_prefetchedBytes >= m_wrapper->m_cachedPages.maxCost() / 2)
+                    m_wrapper->m_pageConsumed.wait(&m_wrapper->m_cacheMutex);
+                if (m_wrapper->m_cancelPrefetch)
+                    return;
+            }
+            m_wrapper->page(index, true);
+        }
+    }
+
+private:
+    PdfiumDocumentWrapperQt *m_wrapper;
+    int m_first;
+    int m_last;
+};
+
 
 PdfiumDocumentWrapperQt::PdfiumDocumentWrapperQt(const void *pdfData, size_t size, const QSize& imageSize, const char *password)
-    : m_imageSize(imageSize * 2.0)
+    : m_requestedImageSize(imageSize)
+    , m_imageSize(imageSize * 2.0)
+    , m_imageScale(2.0)
+    , m_cachedPages(kDefaultCacheBudget)
+    , m_prefetchedBytes(0)
+    , m_cancelPrefetch(false)
 {
     Q_ASSERT(pdfData);
     Q_ASSERT(size);
+    // Rendering is serialized by the PDFium lock anyway, one prefetching thread is enough
+    // to overlap it with the work of the caller.
+    m_prefetchPool.setMaxThreadCount(1);
+
+    QMutexLocker lock(pdfiumMutex());
     if (m_libraryUsers++ == 0)
         FPDF_InitLibrary();
 
@@ -148,21 +205,113 @@ QImage PdfiumDocumentWrapperQt::pageAsQImage(size_t index)
         return QImage();
     }
 
-    PdfiumPageWrapperQt *pageWrapper = nullptr;
-    if (!m_cachedPages.contains(index)) {
-        pageWrapper = new PdfiumPageWrapperQt(m_documentHandle, index,
-                                              m_imageSize.width(), m_imageSize.height());
-        m_cachedPages.insert(index, pageWrapper);
-    } else {
-        pageWrapper = m_cachedPages.value(index);
+    return page(index, false);
+}
+
+void PdfiumDocumentWrapperQt::setImageScale(qreal scale)
+{
+    QMutexLocker lock(&m_cacheMutex);
+    if (scale == m_imageScale)
+        return;
+    m_imageScale = scale;
+    m_imageSize = m_requestedImageSize * scale;
+    m_cachedPages.clear();
+    m_prefetchedPages.clear();
+    m_prefetchedBytes = 0;
+    m_pageConsumed.wakeAll();
+}
+
+void PdfiumDocumentWrapperQt::setCacheBudget(qint64 bytes)
+{
+    QMutexLocker lock(&m_cacheMutex);
+    m_cachedPages.setMaxCost(int(qBound<qint64>(0, bytes, INT_MAX)));
+    m_pageConsumed.wakeAll();
+}
+
+PdfiumCacheStats PdfiumDocumentWrapperQt::cacheStats() const
+{
+    QMutexLocker lock(&m_cacheMutex);
+    PdfiumCacheStats stats = m_cacheStats;
+    stats.cachedPages = m_cachedPages.count();
+    stats.cachedBytes = m_cachedPages.totalCost();
+    stats.budget = m_cachedPages.maxCost();
+    return stats;
+}
+
+void PdfiumDocumentWrapperQt::prefetchPages(int first, int last)
+{
+    if (!m_documentHandle || !m_pageCount)
+        return;
+    {
+        QMutexLocker lock(&m_cacheMutex);
+        if (!m_cachedPages.maxCost())
+            return;
+    }
+    first = qBound(0, first, m_pageCount - 1);
+    last = qBound(0, last, m_pageCount - 1);
+    m_prefetchPool.start(new PdfiumPrefetchTask(this, first, last));
+}
+
+QImage PdfiumDocumentWrapperQt::page(int index, bool prefetching)
+{
+    QMutexLocker lock(&m_cacheMutex);
+    // Wait for the page if it is being rendered by the other thread.
+    while (m_pagesInFlight.contains(index))
+        m_pageRendered.wait(&m_cacheMutex);
+
+    if (!prefetching) {
+        QHash<int, int>::iterator it = m_prefetchedPages.find(index);
+        if (it != m_prefetchedPages.end()) {
+            m_prefetchedBytes -= it.value();
+            m_prefetchedPages.erase(it);
+            m_pageConsumed.wakeAll();
+        }
+    }
+    if (QImage *cachedImage = m_cachedPages.object(index)) {
+        if (!prefetching)
+            ++m_cacheStats.hits;
+        return *cachedImage;
+    }
+    if (!prefetching)
+        ++m_cacheStats.misses;
+
+    const QSize imageSize = m_imageSize;
+    m_pagesInFlight.insert(index);
+    lock.unlock();
+    QImage image = renderPage(index, imageSize);
+    lock.relock();
+    m_pagesInFlight.remove(index);
+    m_pageRendered.wakeAll();
+    // Drop the page if the scale changed while it was rendered.
+    if (imageSize != m_imageSize)
+        return image;
+    const int cost = image.bytesPerLine() * image.height();
+    if (prefetching) {
+        m_prefetchedPages.insert(index, cost);
+        m_prefetchedBytes += cost;
     }
+    // Least recently used pages are evicted to stay within the budget.
+    m_cachedPages.insert(index, new QImage(image), cost);
+    return image;
+}
 
-    return pageWrapper->image();
+QImage PdfiumDocumentWrapperQt::renderPage(int index, const QSize &imageSize)
+{
+    QMutexLocker lock(pdfiumMutex());
+    PdfiumPageWrapperQt pageWrapper(m_documentHandle, index, imageSize.width(), imageSize.height());
+    return pageWrapper.image();
 }
 
 PdfiumDocumentWrapperQt::~PdfiumDocumentWrapperQt()
 {
-    qDeleteAll(m_cachedPages);
+    {
+        QMutexLocker lock(&m_cacheMutex);
+        m_cancelPrefetch = true;
+        m_pageConsumed.wakeAll();
+    }
+    m_prefetchPool.waitForDone();
+
+    QMutexLocker lock(pdfiumMutex());
     FPDF_CloseDocument(m_documentHandle);
     if (--m_libraryUsers == 0)
         FPDF_DestroyLibrary();
@@ -43,12 +43,27 @@
 #if defined(ENABLE_PDF)
 #include "qtwebenginecoreglobal.h"
 
+#include <QtCore/qcache.h>
 #include <QtCore/qglobal.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qset.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
 #include <QtGui/qimage.h>
 
 namespace QtWebEngineCore {
 class PdfiumPageWrapperQt;
+class PdfiumPrefetchTask;
+
+struct PdfiumCacheStats {
+    PdfiumCacheStats() : hits(0), misses(0), cachedPages(0), cachedBytes(0), budget(0) { }
+    quint64 hits;
+    quint64 misses;
+    int cachedPages;
+    qint64 cachedBytes;
+    qint64 budget;
+};
 
 class QWEBENGINE_EXPORT PdfiumDocumentWrapperQt
 {
@@ -56,14 +71,41 @@ public:
     PdfiumDocumentWrapperQt(const void *pdfData, size_t size, const QSize &imageSize, const char *password = nullptr);
     virtual ~PdfiumDocumentWrapperQt();
     QImage pageAsQImage(size_t index);
+    // Renders the pages from first to last in the background, in that order,
+    // so that pageAsQImage() finds them ready.
+    void prefetchPages(int first, int last);
     int pageCount() const { return m_pageCount; }
 
+    // Pages are rendered at twice the requested image size by default, 1.0 renders
+    // and caches them at the requested resolution.
+    void setImageScale(qreal scale);
+    // Rendered pages are kept up to this many bytes, least recently used first out.
+    void setCacheBudget(qint64 bytes);
+    PdfiumCacheStats cacheStats() const;
+
 private:
+    QImage page(int index, bool prefetching);
+    QImage renderPage(int index, const QSize &imageSize);
+
     static int m_libraryUsers;
     int m_pageCount;
     void *m_documentHandle;
+    QSize m_requestedImageSize;
     QSize m_imageSize;
-    QHash<int, PdfiumPageWrapperQt*> m_cachedPages;
+    qreal m_imageScale;
+    mutable QMutex m_cacheMutex;
+    QWaitCondition m_pageRendered;
+    QWaitCondition m_pageConsumed;
+    QCache<int, QImage> m_cachedPages;
+    QSet<int> m_pagesInFlight;
+    // Pages rendered ahead that pageAsQImage() has not asked for yet, with their size in bytes.
+    QHash<int, int> m_prefetchedPages;
+    qint64 m_prefetchedBytes;
+    PdfiumCacheStats m_cacheStats;
+    bool m_cancelPrefetch;
+    QThreadPool m_prefetchPool;
+
+    friend class PdfiumPrefetchTask;
 };
 
 } // namespace QtWebEngineCore
@@ -0,0 +1,115 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "print_job_scheduler_qt.h"
+
+#include "print_view_manager_qt.h"
+
+#include "base/memory/singleton.h"
+#include "base/sys_info.h"
+#include "content/public/browser/browser_thread.h"
+
+#include <algorithm>
+
+namespace QtWebEngineCore {
+
+PrintJobSchedulerQt *PrintJobSchedulerQt::GetInstance()
+{
+    return base::Singleton<PrintJobSchedulerQt>::get();
+}
+
+PrintJobSchedulerQt::PrintJobSchedulerQt()
+    : m_maxActiveJobs(std::max(1, base::SysInfo::NumberOfProcessors()))
+    , m_lastPreviewRequestId(0)
+{
+}
+
+PrintJobSchedulerQt::~PrintJobSchedulerQt()
+{
+}
+
+void PrintJobSchedulerQt::requestSlot(PrintViewManagerQt *manager)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    if (m_activeManagers.count(manager)
+            || std::find(m_waitingManagers.begin(), m_waitingManagers.end(), manager) != m_waitingManagers.end())
+        return;
+    m_waitingManagers.push_back(manager);
+    startWaitingJobs();
+}
+
+void PrintJobSchedulerQt::releaseSlot(PrintViewManagerQt *manager)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    m_waitingManagers.erase(std::remove(m_waitingManagers.begin(), m_waitingManagers.end(), manager),
+                            m_waitingManagers.end());
+    if (m_activeManagers.erase(manager))
+        startWaitingJobs();
+}
+
+void PrintJobSchedulerQt::startWaitingJobs()
+{
+    while (!m_waitingManagers.empty() && int(m_activeManagers.size()) < m_maxActiveJobs) {
+        PrintViewManagerQt *manager = m_waitingManagers.front();
+        m_waitingManagers.pop_front();
+        m_activeManagers.insert(manager);
+        // This may release the slot again right away if the job fails to start.
+        manager->startNextPdfJob();
+    }
+}
+
+void PrintJobSchedulerQt::cancelPreviewRequest(int previewRequestId)
+{
+    base::AutoLock lock(m_cancelledRequestsLock);
+    m_cancelledRequests.insert(previewRequestId);
+}
+
+void PrintJobSchedulerQt::forgetPreviewRequest(int previewRequestId)
+{
+    base::AutoLock lock(m_cancelledRequestsLock);
+    m_cancelledRequests.erase(previewRequestId);
+}
+
+bool PrintJobSchedulerQt::isPreviewRequestCancelled(int previewRequestId)
+{
+    base::AutoLock lock(m_cancelledRequestsLock);
+    return m_cancelledRequests.count(previewRequestId);
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,96 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef PRINT_JOB_SCHEDULER_QT_H
+#define PRINT_JOB_SCHEDULER_QT_H
+
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+
+#include <deque>
+#include <set>
+
+namespace base {
+template <typename T> struct DefaultSingletonTraits;
+}
+
+namespace QtWebEngineCore {
+
+class PrintViewManagerQt;
+
+// Hands out print to PDF slots to the PrintViewManagerQt instances of all pages, so that
+// no more documents than there are cores are rendered at the same time.
+// Lives on the UI thread, except for isPreviewRequestCancelled().
+class PrintJobSchedulerQt {
+public:
+    static PrintJobSchedulerQt *GetInstance();
+
+    // Calls PrintViewManagerQt::startNextPdfJob() once a slot is free, possibly right away.
+    void requestSlot(PrintViewManagerQt *manager);
+    // Gives back the slot of |manager|, or removes it from the waiting list.
+    void releaseSlot(PrintViewManagerQt *manager);
+
+    // Print preview request ids are shared by all pages, so that the renderers can be told
+    // about cancelled requests from the IO thread.
+    int nextPreviewRequestId() { return ++m_lastPreviewRequestId; }
+    void cancelPreviewRequest(int previewRequestId);
+    void forgetPreviewRequest(int previewRequestId);
+    bool isPreviewRequestCancelled(int previewRequestId);
+
+private:
+    friend struct base::DefaultSingletonTraits<PrintJobSchedulerQt>;
+    PrintJobSchedulerQt();
+    ~PrintJobSchedulerQt();
+
+    void startWaitingJobs();
+
+    int m_maxActiveJobs;
+    int m_lastPreviewRequestId;
+    std::set<PrintViewManagerQt *> m_activeManagers;
+    std::deque<PrintViewManagerQt *> m_waitingManagers;
+
+    base::Lock m_cancelledRequestsLock;
+    std::set<int> m_cancelledRequests;
+
+    DISALLOW_COPY_AND_ASSIGN(PrintJobSchedulerQt);
+};
+
+} // namespace QtWebEngineCore
+
+#endif // PRINT_JOB_SCHEDULER_QT_H
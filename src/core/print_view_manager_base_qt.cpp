@@ -70,7 +70,7 @@ PrintViewManagerBaseQt::PrintViewManagerBaseQt(content::WebContents *contents)
     , m_isInsideInnerMessageLoop(false)
     , m_isExpectingFirstPage(false)
     , m_didPrintingSucceed(false)
-    , m_printerQueriesQueue(WebEngineContext::current()->getPrintJobManager()->queue())
+    , m_printerQueriesQueue(WebEngineContext::current()->getPrintQueriesQueue())
 {
     // FIXME: Check if this needs to be executed async:
     PrintViewManagerBaseQt::UpdatePrintingEnabled();
@@ -347,6 +347,9 @@ bool PrintViewManagerBaseQt::CreateNewPrintJob(printing::PrintJobWorkerOwner* jo
     if (!job)
         return false;
 
+    // The PrintJobManager tracks the print jobs through their notifications,
+    // make sure it exists before the first one is created.
+    WebEngineContext::current()->getPrintJobManager();
     m_printJob = new printing::PrintJob();
     m_printJob->Initialize(job, this, number_pages_);
     m_registrar.Add(this, chrome::NOTIFICATION_PRINT_JOB_EVENT,
@@ -497,11 +500,6 @@ void PrintViewManagerBaseQt::ReleasePrinterQuery()
     int cookie = cookie_;
     cookie_ = 0;
 
-    printing::PrintJobManager* printJobManager = WebEngineContext::current()->getPrintJobManager();
-    // May be NULL in tests.
-    if (!printJobManager)
-        return;
-
     scoped_refptr<printing::PrinterQuery> printerQuery;
     printerQuery = m_printerQueriesQueue->PopPrinterQuery(cookie);
     if (!printerQuery.get())
@@ -40,22 +40,25 @@
 
 #include "print_view_manager_qt.h"
 
+#include "print_job_scheduler_qt.h"
 #include "type_conversion.h"
 #include "web_engine_context.h"
 
+#include <QtCore/qbytearray.h>
 #include <QtGui/qpagelayout.h>
 #include <QtGui/qpagesize.h>
 
+#include "base/files/file.h"
+#include "base/memory/shared_memory.h"
 #include "base/values.h"
-#include "base/memory/ref_counted_memory.h"
 #include "chrome/browser/printing/print_job_manager.h"
 #include "chrome/browser/printing/printer_query.h"
 #include "components/printing/common/print_messages.h"
 #include "content/browser/renderer_host/render_view_host_impl.h"
 #include "content/public/browser/browser_thread.h"
+#include "content/public/browser/navigation_details.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/common/web_preferences.h"
-#include "printing/pdf_metafile_skia.h"
 #include "printing/print_job_constants.h"
 
 DEFINE_WEB_CONTENTS_USER_DATA_KEY(QtWebEngineCore::PrintViewManagerQt);
@@ -63,50 +66,43 @@ DEFINE_WEB_CONTENTS_USER_DATA_KEY(QtWebEngineCore::PrintViewManagerQt);
 namespace {
 static const qreal kMicronsToMillimeter = 1000.0f;
 
-static std::vector<char>
-GetStdVectorFromHandle(base::SharedMemoryHandle handle, uint32_t data_size)
+static std::unique_ptr<base::SharedMemory>
+MapSharedMemoryHandle(base::SharedMemoryHandle handle, uint32_t data_size)
 {
     std::unique_ptr<base::SharedMemory> shared_buf(
                 new base::SharedMemory(handle, true));
 
-    if (!shared_buf->Map(data_size)) {
-        return std::vector<char>();
-    }
-
-    char* data = static_cast<char*>(shared_buf->memory());
-    return std::vector<char>(data, data + data_size);
+    if (!shared_buf->Map(data_size))
+        return nullptr;
+    return shared_buf;
 }
 
-static scoped_refptr<base::RefCountedBytes>
-GetBytesFromHandle(base::SharedMemoryHandle handle, uint32_t data_size)
+// Copy the PDF straight from the renderer's shared memory into the buffer handed to the client.
+static QByteArray CopyPdfData(std::unique_ptr<base::SharedMemory> shared_buf, uint32_t data_size)
 {
-     std::unique_ptr<base::SharedMemory> shared_buf(
-                 new base::SharedMemory(handle, true));
-
-    if (!shared_buf->Map(data_size)) {
-       return NULL;
-    }
-
-    unsigned char* data = static_cast<unsigned char*>(shared_buf->memory());
-    std::vector<unsigned char> dataVector(data, data + data_size);
-    return base::RefCountedBytes::TakeVector(&dataVector);
+    DCHECK_CURRENTLY_ON(content::BrowserThread::FILE);
+    if (!shared_buf)
+        return QByteArray();
+    return QByteArray(static_cast<const char*>(shared_buf->memory()), data_size);
 }
 
-// Write the PDF file to disk.
-static void SavePdfFile(scoped_refptr<base::RefCountedBytes> data,
+// Write the PDF file to disk, without parsing or copying the mapped data.
+static void SavePdfFile(std::unique_ptr<base::SharedMemory> shared_buf,
+                        uint32_t data_size,
                         const base::FilePath& path,
                         const QtWebEngineCore::PrintViewManagerQt::PrintToPDFFileCallback
                                 &saveCallback)
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::FILE);
-    DCHECK_GT(data->size(), 0U);
-
-    printing::PdfMetafileSkia metafile(printing::PDF_SKIA_DOCUMENT_TYPE);
-    metafile.InitFromData(static_cast<const void*>(data->front()), data->size());
-
-    base::File file(path,
-                    base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
-    bool success = file.IsValid() && metafile.SaveTo(&file);
+    DCHECK_GT(data_size, 0U);
+
+    bool success = false;
+    if (shared_buf) {
+        base::File file(path,
+                        base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+        success = file.IsValid()
+                && file.WriteAtCurrentPos(static_cast<const char*>(shared_buf->memory()), data_size) == int(data_size);
+    }
     content::BrowserThread::PostTask(content::BrowserThread::UI,
                                      FROM_HERE,
                                      base::Bind(saveCallback, success));
@@ -115,11 +111,6 @@ static void SavePdfFile(scoped_refptr<base::RefCountedBytes> data,
 static base::DictionaryValue *createPrintSettings()
 {
     base::DictionaryValue *printSettings = new base::DictionaryValue();
-    // TO DO: Check if we can use the request ID from Qt here somehow.
-    static int internalRequestId = 0;
-
-    printSettings->SetBoolean(printing::kIsFirstRequest, internalRequestId++ == 0);
-    printSettings->SetInteger(printing::kPreviewRequestID, internalRequestId);
 
     // The following are standard settings that Chromium expects to be set.
     printSettings->SetBoolean(printing::kSettingPrintToPDF, true);
@@ -176,75 +167,189 @@ static base::DictionaryValue *createPrintSettingsFromQPageLayout(const QPageLayo
 
 namespace QtWebEngineCore {
 
+struct PrintViewManagerQt::PdfJob {
+    PdfJob() : previewRequestId(0), pageCount(0), renderFrameHost(nullptr), previewRequested(false) { }
+
+    // Reports the job as failed, its callbacks are not run again afterwards.
+    void fail()
+    {
+        if (!printCallback.is_null())
+            content::BrowserThread::PostTask(content::BrowserThread::UI,
+                                             FROM_HERE,
+                                             base::Bind(printCallback, QByteArray()));
+        if (!saveCallback.is_null())
+            content::BrowserThread::PostTask(content::BrowserThread::UI,
+                                             FROM_HERE,
+                                             base::Bind(saveCallback, false));
+        printCallback.Reset();
+        saveCallback.Reset();
+        pageCallback.Reset();
+    }
+
+    std::unique_ptr<base::DictionaryValue> printSettings;
+    base::FilePath outputPath;
+    PrintToPDFCallback printCallback;
+    PrintToPDFFileCallback saveCallback;
+    PrintToPDFPageCallback pageCallback;
+    int previewRequestId;
+    int pageCount;
+    // The frame that was asked to render the document.
+    content::RenderFrameHost *renderFrameHost;
+    bool previewRequested;
+};
+
 PrintViewManagerQt::~PrintViewManagerQt()
 {
+    PrintJobSchedulerQt::GetInstance()->releaseSlot(this);
+    if (m_currentPdfJob)
+        PrintJobSchedulerQt::GetInstance()->forgetPreviewRequest(m_currentPdfJob->previewRequestId);
+    forgetAbandonedPdfJobs(nullptr);
 }
 
 #if BUILDFLAG(ENABLE_BASIC_PRINTING)
 void PrintViewManagerQt::PrintToPDFFileWithCallback(const QPageLayout &pageLayout,
                                                     bool printInColor, const QString &filePath,
-                                                    const PrintToPDFFileCallback& callback)
+                                                    const PrintToPDFFileCallback& callback,
+                                                    const PrintToPDFPageCallback &pageCallback)
 {
     if (callback.is_null())
         return;
 
-    if (m_printSettings || !filePath.length()) {
-                content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                         FROM_HERE,
-                                         base::Bind(callback, false));
+    std::unique_ptr<PdfJob> job(new PdfJob);
+    job->outputPath = toFilePath(filePath);
+    job->saveCallback = callback;
+    job->pageCallback = pageCallback;
+    if (!filePath.length()) {
+        job->fail();
         return;
     }
-
-    m_pdfOutputPath = toFilePath(filePath);
-    m_pdfSaveCallback = callback;
-    if (!PrintToPDFInternal(pageLayout, printInColor)) {
-        content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                         FROM_HERE,
-                                         base::Bind(callback, false));
-        resetPdfState();
-    }
+    enqueuePdfJob(std::move(job), pageLayout, printInColor);
 }
 
 void PrintViewManagerQt::PrintToPDFWithCallback(const QPageLayout &pageLayout,
                                                 bool printInColor,
-                                                const PrintToPDFCallback& callback)
+                                                const PrintToPDFCallback& callback,
+                                                const PrintToPDFPageCallback &pageCallback)
 {
     if (callback.is_null())
         return;
 
-    // If there already is a pending print in progress, don't try starting another one.
-    if (m_printSettings) {
-            content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                             FROM_HERE,
-                                             base::Bind(callback, std::vector<char>()));
+    std::unique_ptr<PdfJob> job(new PdfJob);
+    job->printCallback = callback;
+    job->pageCallback = pageCallback;
+    enqueuePdfJob(std::move(job), pageLayout, printInColor);
+}
+
+void PrintViewManagerQt::enqueuePdfJob(std::unique_ptr<PdfJob> job, const QPageLayout &pageLayout, bool printInColor)
+{
+    if (!pageLayout.isValid()) {
+        job->fail();
         return;
     }
 
-    m_pdfPrintCallback = callback;
-    if (!PrintToPDFInternal(pageLayout, printInColor)) {
-        content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                         FROM_HERE,
-                                         base::Bind(callback, std::vector<char>()));
+    job->printSettings.reset(createPrintSettingsFromQPageLayout(pageLayout));
+    job->printSettings->SetBoolean(printing::kSettingShouldPrintBackgrounds
+        , web_contents()->GetRenderViewHost()->GetWebkitPreferences().should_print_backgrounds);
+    job->printSettings->SetInteger(printing::kSettingColor,
+                                   printInColor ? printing::COLOR : printing::GRAYSCALE);
+    // Draft data is what the renderer sends for every single page.
+    job->printSettings->SetBoolean(printing::kSettingGenerateDraftData, !job->pageCallback.is_null());
+
+    m_pendingPdfJobs.push_back(std::move(job));
+    // A page renders one document at a time, the scheduler limits how many pages do so at once.
+    if (!m_currentPdfJob)
+        PrintJobSchedulerQt::GetInstance()->requestSlot(this);
+}
 
-        resetPdfState();
+#endif // BUILDFLAG(ENABLE_BASIC_PRINTING)
+
+void PrintViewManagerQt::CancelPDFJobs()
+{
+    for (const std::unique_ptr<PdfJob> &job : m_pendingPdfJobs)
+        job->fail();
+    m_pendingPdfJobs.clear();
+
+    if (m_currentPdfJob) {
+        // The renderer asks whether to continue after every page and gives up on the document
+        // in between. Its reply is dropped when it arrives, the slot is released right away.
+        PrintJobSchedulerQt *scheduler = PrintJobSchedulerQt::GetInstance();
+        m_currentPdfJob->fail();
+        m_currentPdfJob->printSettings = std::move(m_printSettings);
+        scheduler->cancelPreviewRequest(m_currentPdfJob->previewRequestId);
+        m_abandonedPdfJobs.push_back(std::move(m_currentPdfJob));
+        scheduler->releaseSlot(this);
     }
 }
 
-bool PrintViewManagerQt::PrintToPDFInternal(const QPageLayout &pageLayout, bool printInColor)
+void PrintViewManagerQt::startNextPdfJob()
 {
-    if (!pageLayout.isValid())
-        return false;
+    DCHECK(!m_currentPdfJob);
+    PrintJobSchedulerQt *scheduler = PrintJobSchedulerQt::GetInstance();
+    while (!m_pendingPdfJobs.empty()) {
+        m_currentPdfJob = std::move(m_pendingPdfJobs.front());
+        m_pendingPdfJobs.pop_front();
+
+        m_currentPdfJob->previewRequestId = scheduler->nextPreviewRequestId();
+        m_printSettings = std::move(m_currentPdfJob->printSettings);
+        m_printSettings->SetBoolean(printing::kIsFirstRequest, m_currentPdfJob->previewRequestId == 1);
+        m_printSettings->SetInteger(printing::kPreviewRequestID, m_currentPdfJob->previewRequestId);
+        m_currentPdfJob->renderFrameHost = web_contents()->GetMainFrame();
+        if (Send(new PrintMsg_InitiatePrintPreview(web_contents()->GetMainFrame()->GetRoutingID(), false)))
+            return;
+
+        m_currentPdfJob->fail();
+        m_currentPdfJob.reset();
+        m_printSettings.reset();
+    }
+    scheduler->releaseSlot(this);
+}
 
-    m_printSettings.reset(createPrintSettingsFromQPageLayout(pageLayout));
-    m_printSettings->SetBoolean(printing::kSettingShouldPrintBackgrounds
-        , web_contents()->GetRenderViewHost()->GetWebkitPreferences().should_print_backgrounds);
-    m_printSettings->SetInteger(printing::kSettingColor,
-                                printInColor ? printing::COLOR : printing::GRAYSCALE);
-    return Send(new PrintMsg_InitiatePrintPreview(
-                    web_contents()->GetMainFrame()->GetRoutingID(), false));
+void PrintViewManagerQt::finishCurrentPdfJob()
+{
+    if (!m_currentPdfJob)
+        return;
+    PrintJobSchedulerQt *scheduler = PrintJobSchedulerQt::GetInstance();
+    scheduler->forgetPreviewRequest(m_currentPdfJob->previewRequestId);
+    m_currentPdfJob.reset();
+    m_printSettings.reset();
+    scheduler->releaseSlot(this);
+    if (!m_pendingPdfJobs.empty())
+        scheduler->requestSlot(this);
 }
 
-#endif // BUILDFLAG(ENABLE_BASIC_PRINTING)
+bool PrintViewManagerQt::isCurrentPdfJob(int previewRequestId) const
+{
+    return m_currentPdfJob && m_currentPdfJob->previewRequestId == previewRequestId;
+}
+
+// The renderer handles one document after the other, so its replies for cancelled documents
+// arrive before those for the current one. A \a previewRequestId of 0 matches any document.
+bool PrintViewManagerQt::finishAbandonedPdfJob(int previewRequestId)
+{
+    if (m_abandonedPdfJobs.empty())
+        return false;
+    const std::unique_ptr<PdfJob> &job = m_abandonedPdfJobs.front();
+    if (previewRequestId && job->previewRequestId != previewRequestId)
+        return false;
+    PrintJobSchedulerQt::GetInstance()->forgetPreviewRequest(job->previewRequestId);
+    m_abandonedPdfJobs.pop_front();
+    return true;
+}
+
+// Drops the cancelled documents rendered by \a renderFrameHost, or all of them if it is null.
+void PrintViewManagerQt::forgetAbandonedPdfJobs(content::RenderFrameHost *renderFrameHost)
+{
+    PrintJobSchedulerQt *scheduler = PrintJobSchedulerQt::GetInstance();
+    auto it = m_abandonedPdfJobs.begin();
+    while (it != m_abandonedPdfJobs.end()) {
+        if (renderFrameHost && (*it)->renderFrameHost != renderFrameHost) {
+            ++it;
+            continue;
+        }
+        scheduler->forgetPreviewRequest((*it)->previewRequestId);
+        it = m_abandonedPdfJobs.erase(it);
+    }
+}
 
 // PrintedPagesSource implementation.
 base::string16 PrintViewManagerQt::RenderSourceName()
@@ -266,55 +371,105 @@ bool PrintViewManagerQt::OnMessageReceived(const IPC::Message& message, content:
       IPC_MESSAGE_HANDLER(PrintHostMsg_DidShowPrintDialog, OnDidShowPrintDialog)
       IPC_MESSAGE_HANDLER(PrintHostMsg_RequestPrintPreview,
                                  OnRequestPrintPreview)
+      IPC_MESSAGE_HANDLER(PrintHostMsg_DidGetPreviewPageCount,
+                                 OnDidGetPreviewPageCount)
+      IPC_MESSAGE_HANDLER(PrintHostMsg_DidPreviewPage,
+                                 OnDidPreviewPage)
       IPC_MESSAGE_HANDLER(PrintHostMsg_MetafileReadyForPrinting,
                                  OnMetafileReadyForPrinting);
+      IPC_MESSAGE_HANDLER(PrintHostMsg_PrintPreviewFailed,
+                                 OnPrintPreviewFailed)
+      IPC_MESSAGE_HANDLER(PrintHostMsg_PrintPreviewCancelled,
+                                 OnPrintPreviewCancelled)
       IPC_MESSAGE_UNHANDLED(handled = false)
     IPC_END_MESSAGE_MAP()
     return handled || PrintManager::OnMessageReceived(message, render_frame_host);
 }
 
-void PrintViewManagerQt::resetPdfState()
-{
-    m_pdfOutputPath.clear();
-    m_pdfPrintCallback.Reset();
-    m_pdfSaveCallback.Reset();
-    m_printSettings.reset();
-}
-
 // IPC handlers
 
 void PrintViewManagerQt::OnRequestPrintPreview(
     const PrintHostMsg_RequestPrintPreview_Params& params)
 {
+    // A cancelled document the renderer has not asked for yet is still rendered, the
+    // renderer then notices the cancellation after the first page.
+    const base::DictionaryValue *printSettings = m_printSettings.get();
+    PdfJob *job = m_currentPdfJob.get();
+    for (const std::unique_ptr<PdfJob> &abandonedJob : m_abandonedPdfJobs) {
+        if (!abandonedJob->previewRequested) {
+            printSettings = abandonedJob->printSettings.get();
+            job = abandonedJob.get();
+            break;
+        }
+    }
+    if (!printSettings)
+        return;
+    job->previewRequested = true;
     Send(new PrintMsg_PrintPreview(
-             web_contents()->GetMainFrame()->GetRoutingID(), *m_printSettings));
+             web_contents()->GetMainFrame()->GetRoutingID(), *printSettings));
+}
+
+void PrintViewManagerQt::OnDidGetPreviewPageCount(
+    const PrintHostMsg_DidGetPreviewPageCount_Params& params)
+{
+    if (isCurrentPdfJob(params.preview_request_id))
+        m_currentPdfJob->pageCount = params.page_count;
+}
+
+void PrintViewManagerQt::OnDidPreviewPage(const PrintHostMsg_DidPreviewPage_Params& params)
+{
+    if (!isCurrentPdfJob(params.preview_request_id) || m_currentPdfJob->pageCallback.is_null())
+        return;
+
+    // Single pages are small, unlike the whole document they can be copied right here.
+    QByteArray pageData;
+    if (std::unique_ptr<base::SharedMemory> shared_buf
+            = MapSharedMemoryHandle(params.metafile_data_handle, params.data_size))
+        pageData = QByteArray(static_cast<const char*>(shared_buf->memory()), params.data_size);
+    content::BrowserThread::PostTask(content::BrowserThread::UI,
+                                     FROM_HERE,
+                                     base::Bind(m_currentPdfJob->pageCallback, params.page_number,
+                                                m_currentPdfJob->pageCount, pageData));
 }
 
 void PrintViewManagerQt::OnMetafileReadyForPrinting(
     const PrintHostMsg_DidPreviewDocument_Params& params)
 {
     StopWorker(params.document_cookie);
+    if (finishAbandonedPdfJob(params.preview_request_id) || !isCurrentPdfJob(params.preview_request_id))
+        return;
 
-    // Create local copies so we can reset the state and take a new pdf print job.
-    base::Callback<void(const std::vector<char>&)> pdf_print_callback = m_pdfPrintCallback;
-    base::Callback<void(bool)> pdf_save_callback = m_pdfSaveCallback;
-    base::FilePath pdfOutputPath = m_pdfOutputPath;
-
-    resetPdfState();
-
-    if (!pdf_print_callback.is_null()) {
-        std::vector<char> data_vector = GetStdVectorFromHandle(params.metafile_data_handle,
-                                                               params.data_size);
-        content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                         FROM_HERE,
-                                         base::Bind(pdf_print_callback, data_vector));
-    } else {
-        scoped_refptr<base::RefCountedBytes> data_bytes
-                = GetBytesFromHandle(params.metafile_data_handle, params.data_size);
+    // Only map the document here, the possibly very large data is touched on the FILE thread.
+    std::unique_ptr<base::SharedMemory> shared_buf
+            = MapSharedMemoryHandle(params.metafile_data_handle, params.data_size);
+
+    if (!m_currentPdfJob->printCallback.is_null()) {
+        content::BrowserThread::PostTaskAndReplyWithResult(
+                    content::BrowserThread::FILE,
+                    FROM_HERE,
+                    base::Bind(&CopyPdfData, base::Passed(&shared_buf), params.data_size),
+                    m_currentPdfJob->printCallback);
+    } else if (!m_currentPdfJob->saveCallback.is_null()) {
         content::BrowserThread::PostTask(content::BrowserThread::FILE,
                FROM_HERE,
-               base::Bind(&SavePdfFile, data_bytes, pdfOutputPath, pdf_save_callback));
+               base::Bind(&SavePdfFile, base::Passed(&shared_buf), params.data_size,
+                          m_currentPdfJob->outputPath, m_currentPdfJob->saveCallback));
     }
+    finishCurrentPdfJob();
+}
+
+void PrintViewManagerQt::OnPrintPreviewFailed(int documentCookie)
+{
+    StopWorker(documentCookie);
+    if (finishAbandonedPdfJob(0) || !m_currentPdfJob)
+        return;
+    m_currentPdfJob->fail();
+    finishCurrentPdfJob();
+}
+
+void PrintViewManagerQt::OnPrintPreviewCancelled(int documentCookie)
+{
+    OnPrintPreviewFailed(documentCookie);
 }
 
 void PrintViewManagerQt::OnDidShowPrintDialog()
@@ -327,26 +482,36 @@ void PrintViewManagerQt::DidStartLoading()
 }
 
 // content::WebContentsObserver implementation.
-// Cancels the print job.
+// Cancels the print jobs.
 void PrintViewManagerQt::NavigationStopped()
 {
-    if (!m_pdfPrintCallback.is_null()) {
-        content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                         FROM_HERE,
-                                         base::Bind(m_pdfPrintCallback, std::vector<char>()));
-    }
-    resetPdfState();
+    CancelPDFJobs();
+}
+
+void PrintViewManagerQt::DidNavigateMainFrame(const content::LoadCommittedDetails &details,
+                                              const content::FrameNavigateParams &params)
+{
+    Q_UNUSED(params);
+    if (!details.is_in_page)
+        CancelPDFJobs();
 }
 
 void PrintViewManagerQt::RenderProcessGone(base::TerminationStatus status)
 {
     PrintViewManagerBaseQt::RenderProcessGone(status);
-    if (!m_pdfPrintCallback.is_null()) {
-        content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                         FROM_HERE,
-                                         base::Bind(m_pdfPrintCallback, std::vector<char>()));
+    CancelPDFJobs();
+    // Nobody is left to answer for the cancelled documents.
+    forgetAbandonedPdfJobs(nullptr);
+}
+
+void PrintViewManagerQt::RenderFrameDeleted(content::RenderFrameHost *render_frame_host)
+{
+    PrintViewManagerBaseQt::RenderFrameDeleted(render_frame_host);
+    if (m_currentPdfJob && m_currentPdfJob->renderFrameHost == render_frame_host) {
+        m_currentPdfJob->fail();
+        finishCurrentPdfJob();
     }
-    resetPdfState();
+    forgetAbandonedPdfJobs(render_frame_host);
 }
 
 
@@ -54,10 +54,18 @@
 #include "printing/features/features.h"
 #include "printing/printed_pages_source.h"
 
-struct PrintHostMsg_RequestPrintPreview_Params;
+#include <deque>
+#include <memory>
+
+struct PrintHostMsg_DidGetPreviewPageCount_Params;
 struct PrintHostMsg_DidPreviewDocument_Params;
+struct PrintHostMsg_DidPreviewPage_Params;
+struct PrintHostMsg_RequestPrintPreview_Params;
 
 namespace content {
+struct FrameNavigateParams;
+struct LoadCommittedDetails;
+class RenderFrameHost;
 class RenderViewHost;
 }
 
@@ -70,6 +78,7 @@ class PrintQueriesQueue;
 }
 
 QT_BEGIN_NAMESPACE
+class QByteArray;
 class QPageLayout;
 class QString;
 QT_END_NAMESPACE
@@ -81,18 +90,25 @@ class PrintViewManagerQt
 {
 public:
     ~PrintViewManagerQt() override;
-    typedef base::Callback<void(const std::vector<char> &result)> PrintToPDFCallback;
+    typedef base::Callback<void(const QByteArray &result)> PrintToPDFCallback;
     typedef base::Callback<void(bool success)> PrintToPDFFileCallback;
+    // Receives every page as a PDF document of its own, as soon as it has been rendered.
+    typedef base::Callback<void(int pageIndex, int pageCount, const QByteArray &pageData)> PrintToPDFPageCallback;
 #if BUILDFLAG(ENABLE_BASIC_PRINTING)
     // Method to print a page to a Pdf document with page size \a pageSize in location \a filePath.
+    // Requests are queued and run one after the other.
     void PrintToPDFFileWithCallback(const QPageLayout &pageLayout,
                                     bool printInColor,
                                     const QString &filePath,
-                                    const PrintToPDFFileCallback& callback);
+                                    const PrintToPDFFileCallback& callback,
+                                    const PrintToPDFPageCallback &pageCallback = PrintToPDFPageCallback());
     void PrintToPDFWithCallback(const QPageLayout &pageLayout,
                                 bool printInColor,
-                                const PrintToPDFCallback &callback);
+                                const PrintToPDFCallback &callback,
+                                const PrintToPDFPageCallback &pageCallback = PrintToPDFPageCallback());
 #endif  // ENABLE_BASIC_PRINTING
+    // Fails the running and all queued print to PDF requests.
+    void CancelPDFJobs();
 
     // PrintedPagesSource implementation.
     base::string16 RenderSourceName() override;
@@ -104,9 +120,16 @@ protected:
     // Cancels the print job.
     void NavigationStopped() override;
 
+    // Cancels the print jobs when the main frame navigates to another document.
+    void DidNavigateMainFrame(const content::LoadCommittedDetails &details,
+                              const content::FrameNavigateParams &params) override;
+
     // Terminates or cancels the print job if one was pending.
     void RenderProcessGone(base::TerminationStatus status) override;
 
+    // Ends the running print job if the frame rendering it goes away.
+    void RenderFrameDeleted(content::RenderFrameHost *render_frame_host) override;
+
     // content::WebContentsObserver implementation.
     bool OnMessageReceived(const IPC::Message& message,
                            content::RenderFrameHost* render_frame_host) override;
@@ -115,19 +138,30 @@ protected:
     void OnDidShowPrintDialog();
     void OnRequestPrintPreview(const PrintHostMsg_RequestPrintPreview_Params&);
     void OnMetafileReadyForPrinting(const PrintHostMsg_DidPreviewDocument_Params& params);
-
-#if BUILDFLAG(ENABLE_BASIC_PRINTING)
-    bool PrintToPDFInternal(const QPageLayout &, bool printInColor);
-#endif // BUILDFLAG(ENABLE_BASIC_PRINTING)
-
-    base::FilePath m_pdfOutputPath;
-    PrintToPDFCallback m_pdfPrintCallback;
-    PrintToPDFFileCallback m_pdfSaveCallback;
+    void OnDidGetPreviewPageCount(const PrintHostMsg_DidGetPreviewPageCount_Params& params);
+    void OnDidPreviewPage(const PrintHostMsg_DidPreviewPage_Params& params);
+    void OnPrintPreviewFailed(int documentCookie);
+    void OnPrintPreviewCancelled(int documentCookie);
 
 private:
     friend class content::WebContentsUserData<PrintViewManagerQt>;
+    friend class PrintJobSchedulerQt;
+    struct PdfJob;
 
-    void resetPdfState();
+#if BUILDFLAG(ENABLE_BASIC_PRINTING)
+    void enqueuePdfJob(std::unique_ptr<PdfJob> job, const QPageLayout &pageLayout, bool printInColor);
+#endif // BUILDFLAG(ENABLE_BASIC_PRINTING)
+    // Called by PrintJobSchedulerQt once this page may render a document.
+    void startNextPdfJob();
+    void finishCurrentPdfJob();
+    bool isCurrentPdfJob(int previewRequestId) const;
+    bool finishAbandonedPdfJob(int previewRequestId);
+    void forgetAbandonedPdfJobs(content::RenderFrameHost *renderFrameHost);
+
+    std::deque<std::unique_ptr<PdfJob> > m_pendingPdfJobs;
+    std::unique_ptr<PdfJob> m_currentPdfJob;
+    // Cancelled documents the renderer may still be working on, oldest first.
+    std::deque<std::unique_ptr<PdfJob> > m_abandonedPdfJobs;
 
     // content::WebContentsObserver implementation.
     void DidStartLoading() override;
@@ -41,6 +41,7 @@
 
 #include "printing_message_filter_qt.h"
 
+#include "print_job_scheduler_qt.h"
 #include "web_engine_context.h"
 
 #include <string>
@@ -62,7 +63,7 @@ namespace QtWebEngineCore {
 PrintingMessageFilterQt::PrintingMessageFilterQt(int render_process_id)
     : BrowserMessageFilter(PrintMsgStart),
       render_process_id_(render_process_id),
-      queue_(WebEngineContext::current()->getPrintJobManager()->queue()) {
+      queue_(WebEngineContext::current()->getPrintQueriesQueue()) {
   DCHECK(queue_.get());
 }
 
@@ -237,7 +238,7 @@ void PrintingMessageFilterQt::OnUpdatePrintSettingsReply(
 void PrintingMessageFilterQt::OnCheckForCancel(int32_t preview_ui_id,
                                              int preview_request_id,
                                              bool* cancel) {
-  *cancel = false;
+  *cancel = PrintJobSchedulerQt::GetInstance()->isPreviewRequestCancelled(preview_request_id);
 }
 
 }  // namespace printing
@@ -45,6 +45,10 @@
 #include "type_conversion.h"
 #include "web_contents_adapter_client.h"
 
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStringList>
+
 namespace QtWebEngineCore {
 
 RenderViewObserverHostQt::RenderViewObserverHostQt(content::WebContents *webContents, WebContentsAdapterClient *adapterClient)
@@ -63,6 +67,31 @@ void RenderViewObserverHostQt::fetchDocumentInnerText(quint64 requestId)
     Send(new RenderViewObserverQt_FetchDocumentInnerText(routing_id(), requestId));
 }
 
+void RenderViewObserverHostQt::streamDocumentMarkup(quint64 requestId, quint64 maxLength)
+{
+    Send(new RenderViewObserverQt_StreamDocumentMarkup(routing_id(), requestId, maxLength));
+}
+
+void RenderViewObserverHostQt::streamDocumentInnerText(quint64 requestId, quint64 maxLength)
+{
+    Send(new RenderViewObserverQt_StreamDocumentInnerText(routing_id(), requestId, maxLength));
+}
+
+void RenderViewObserverHostQt::executeJavaScript(quint64 requestId, const QString &javaScript, quint32 worldId)
+{
+    Send(new RenderViewObserverQt_ExecuteJavaScript(routing_id(), requestId, toString16(javaScript), worldId));
+}
+
+void RenderViewObserverHostQt::executeJavaScriptBatch(quint64 requestId, const QStringList &scripts, quint32 worldId,
+                                                      const QString &frameName)
+{
+    std::vector<base::string16> sources;
+    sources.reserve(scripts.size());
+    for (const QString &script : scripts)
+        sources.push_back(toString16(script));
+    Send(new RenderViewObserverQt_ExecuteJavaScriptBatch(routing_id(), requestId, sources, worldId, toString16(frameName)));
+}
+
 bool RenderViewObserverHostQt::OnMessageReceived(const IPC::Message& message)
 {
     bool handled = true;
@@ -71,6 +100,12 @@ bool RenderViewObserverHostQt::OnMessageReceived(const IPC::Message& message)
                             onDidFetchDocumentMarkup)
         IPC_MESSAGE_HANDLER(RenderViewObserverHostQt_DidFetchDocumentInnerText,
                             onDidFetchDocumentInnerText)
+        IPC_MESSAGE_HANDLER(RenderViewObserverHostQt_DidStreamDocumentChunk,
+                            onDidStreamDocumentChunk)
+        IPC_MESSAGE_HANDLER(RenderViewObserverHostQt_DidExecuteJavaScript,
+                            onDidExecuteJavaScript)
+        IPC_MESSAGE_HANDLER(RenderViewObserverHostQt_DidExecuteJavaScriptBatch,
+                            onDidExecuteJavaScriptBatch)
         IPC_MESSAGE_UNHANDLED(handled = false)
     IPC_END_MESSAGE_MAP()
     return handled;
@@ -87,4 +122,23 @@ void RenderViewObserverHostQt::onDidFetchDocumentInnerText(quint64 requestId, co
     m_adapterClient->didFetchDocumentInnerText(requestId, toQt(innerText));
 }
 
+void RenderViewObserverHostQt::onDidStreamDocumentChunk(quint64 requestId, const base::string16 &chunk, bool last)
+{
+    m_adapterClient->didFetchDocumentChunk(requestId, toQt(chunk), last);
+}
+
+void RenderViewObserverHostQt::onDidExecuteJavaScript(quint64 requestId, const QByteArray &binaryJSON)
+{
+    // The renderer isn't trusted, validate the buffer. Values are then only decoded
+    // when the client reads them.
+    const QJsonDocument doc = QJsonDocument::fromBinaryData(binaryJSON);
+    m_adapterClient->didRunJavaScriptAsJson(requestId, doc.array().at(0));
+}
+
+void RenderViewObserverHostQt::onDidExecuteJavaScriptBatch(quint64 requestId, const QByteArray &binaryJSON)
+{
+    const QJsonDocument doc = QJsonDocument::fromBinaryData(binaryJSON);
+    m_adapterClient->didRunJavaScriptAsJson(requestId, doc.array());
+}
+
 } // namespace QtWebEngineCore
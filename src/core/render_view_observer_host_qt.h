@@ -44,6 +44,10 @@
 
 #include <QtGlobal>
 
+QT_FORWARD_DECLARE_CLASS(QByteArray)
+QT_FORWARD_DECLARE_CLASS(QString)
+QT_FORWARD_DECLARE_CLASS(QStringList)
+
 namespace content {
     class WebContents;
 }
@@ -58,11 +62,18 @@ public:
     RenderViewObserverHostQt(content::WebContents*, WebContentsAdapterClient *adapterClient);
     void fetchDocumentMarkup(quint64 requestId);
     void fetchDocumentInnerText(quint64 requestId);
+    void streamDocumentMarkup(quint64 requestId, quint64 maxLength);
+    void streamDocumentInnerText(quint64 requestId, quint64 maxLength);
+    void executeJavaScript(quint64 requestId, const QString &javaScript, quint32 worldId);
+    void executeJavaScriptBatch(quint64 requestId, const QStringList &scripts, quint32 worldId, const QString &frameName);
 
 private:
     bool OnMessageReceived(const IPC::Message& message) Q_DECL_OVERRIDE;
     void onDidFetchDocumentMarkup(quint64 requestId, const base::string16& markup);
     void onDidFetchDocumentInnerText(quint64 requestId, const base::string16& innerText);
+    void onDidStreamDocumentChunk(quint64 requestId, const base::string16 &chunk, bool last);
+    void onDidExecuteJavaScript(quint64 requestId, const QByteArray &binaryJSON);
+    void onDidExecuteJavaScriptBatch(quint64 requestId, const QByteArray &binaryJSON);
 
     WebContentsAdapterClient *m_adapterClient;
 };
@@ -44,11 +44,13 @@
 #include "browser_accessibility_qt.h"
 #include "chromium_overrides.h"
 #include "delegated_frame_node.h"
+#include "frame_timing_recorder.h"
 #include "qtwebenginecoreglobal_p.h"
 #include "render_widget_host_view_qt_delegate.h"
 #include "type_conversion.h"
 #include "web_contents_adapter.h"
 #include "web_contents_adapter_client.h"
+#include "web_engine_settings.h"
 #include "web_event_factory.h"
 
 #include "base/command_line.h"
@@ -60,6 +62,9 @@
 #include "content/public/browser/browser_accessibility_state.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/common/content_switches.h"
+#include "media/base/video_frame.h"
+#include "media/base/video_util.h"
+#include "third_party/libyuv/include/libyuv/convert.h"
 #include "third_party/skia/include/core/SkColor.h"
 #include "third_party/WebKit/public/platform/WebColor.h"
 #include "third_party/WebKit/public/platform/WebCursorInfo.h"
@@ -69,6 +74,7 @@
 #include "ui/events/event.h"
 #include "ui/events/gesture_detection/gesture_provider_config_helper.h"
 #include "ui/events/gesture_detection/motion_event.h"
+#include "ui/gfx/geometry/dip_util.h"
 #include "ui/gfx/geometry/size_conversions.h"
 
 #if defined(USE_AURA)
@@ -83,6 +89,7 @@
 #include <QKeyEvent>
 #include <QMouseEvent>
 #include <QPixmap>
+#include <QQuickItemGrabResult>
 #include <QScreen>
 #include <QStyleHints>
 #include <QVariant>
@@ -234,8 +241,12 @@ RenderWidgetHostViewQt::RenderWidgetHostViewQt(content::RenderWidgetHost* widget
     , m_gestureProvider(QtGestureProviderConfig(), this)
     , m_sendMotionActionDown(false)
     , m_touchMotionStarted(false)
+    , m_frameCaptureDirty(false)
+    , m_frameCaptureInFlight(false)
+    , m_frameCaptureScheduled(false)
     , m_chromiumCompositorData(new ChromiumCompositorData)
     , m_needsDelegatedFrameAck(false)
+    , m_pipelinedMailboxFetch(false)
     , m_loadVisuallyCommittedState(NotCommitted)
     , m_adapterClient(0)
     , m_currentInputType(ui::TEXT_INPUT_TYPE_NONE)
@@ -614,24 +625,185 @@ void RenderWidgetHostViewQt::SetTooltipText(const base::string16 &tooltip_text)
     m_adapterClient->setToolTip(toQt(tooltip_text));
 }
 
+// Grabs are rendered into textures no larger than this, which every GPU we run on supports.
+static const int kMaxGrabTextureSize = 4096;
+
+static void deliverReadbackBitmap(const content::ReadbackRequestCallback &callback, const QImage &grabbedImage)
+{
+    if (grabbedImage.isNull()) {
+        callback.Run(SkBitmap(), content::READBACK_FAILED);
+        return;
+    }
+    const QImage image = grabbedImage.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocN32Pixels(image.width(), image.height())) {
+        callback.Run(SkBitmap(), content::READBACK_BITMAP_ALLOCATION_FAILURE);
+        return;
+    }
+    // Format_ARGB32_Premultiplied has the same memory layout as kN32_SkColorType.
+    for (int y = 0; y < image.height(); ++y)
+        memcpy(bitmap.getAddr32(0, y), image.constScanLine(y), image.width() * 4);
+    callback.Run(bitmap, content::READBACK_SUCCESS);
+}
+
+static void deliverVideoFrame(const scoped_refptr<media::VideoFrame> &target, const gfx::Rect &region,
+                              const base::Callback<void(const gfx::Rect&, bool)> &callback, const QImage &grabbedImage)
+{
+    if (grabbedImage.isNull()) {
+        callback.Run(gfx::Rect(), false);
+        return;
+    }
+    const QImage image = grabbedImage.convertToFormat(QImage::Format_ARGB32);
+
+    media::LetterboxYUV(target.get(), region);
+    // The region is in frame coordinates, it already includes the origin of the visible rect.
+    const int yStride = target->stride(media::VideoFrame::kYPlane);
+    const int uStride = target->stride(media::VideoFrame::kUPlane);
+    const int vStride = target->stride(media::VideoFrame::kVPlane);
+    libyuv::ARGBToI420(image.constBits(), image.bytesPerLine(),
+                       target->data(media::VideoFrame::kYPlane) + region.y() * yStride + region.x(), yStride,
+                       target->data(media::VideoFrame::kUPlane) + region.y() / 2 * uStride + region.x() / 2, uStride,
+                       target->data(media::VideoFrame::kVPlane) + region.y() / 2 * vStride + region.x() / 2, vStride,
+                       region.width(), region.height());
+    callback.Run(region, true);
+}
+
 void RenderWidgetHostViewQt::CopyFromCompositingSurface(const gfx::Rect& src_subrect, const gfx::Size& dst_size, const content::ReadbackRequestCallback& callback, const SkColorType color_type)
 {
-    NOTIMPLEMENTED();
-    Q_UNUSED(src_subrect);
-    Q_UNUSED(dst_size);
-    Q_UNUSED(color_type);
-    callback.Run(SkBitmap(), content::READBACK_FAILED);
+    if (color_type != kN32_SkColorType) {
+        callback.Run(SkBitmap(), content::READBACK_FAILED);
+        return;
+    }
+    if (!grabContents(src_subrect, toQt(dst_size), base::Bind(&deliverReadbackBitmap, callback)))
+        callback.Run(SkBitmap(), content::READBACK_SURFACE_UNAVAILABLE);
 }
 
 void RenderWidgetHostViewQt::CopyFromCompositingSurfaceToVideoFrame(const gfx::Rect& src_subrect, const scoped_refptr<media::VideoFrame>& target, const base::Callback<void(const gfx::Rect&, bool)>& callback)
 {
-    NOTIMPLEMENTED();
-    callback.Run(gfx::Rect(), false);
+    if (!target || target->format() != media::PIXEL_FORMAT_I420) {
+        callback.Run(gfx::Rect(), false);
+        return;
+    }
+    const QRect sourceRect = grabSourceRect(src_subrect);
+    gfx::Rect region = media::ComputeLetterboxRegion(target->visible_rect(), toGfx(sourceRect.size()));
+    // The chroma planes are subsampled, keep the region on even coordinates.
+    region = gfx::Rect(region.x() & ~1, region.y() & ~1, region.width() & ~1, region.height() & ~1);
+    if (region.IsEmpty()
+            || !grabContents(src_subrect, toQt(region.size()), base::Bind(&deliverVideoFrame, target, region, callback)))
+        callback.Run(gfx::Rect(), false);
 }
 
 bool RenderWidgetHostViewQt::CanCopyToVideoFrame() const
 {
-    return false;
+    return true;
+}
+
+void RenderWidgetHostViewQt::BeginFrameSubscription(std::unique_ptr<content::RenderWidgetHostViewFrameSubscriber> subscriber)
+{
+    m_frameSubscriber = std::move(subscriber);
+}
+
+void RenderWidgetHostViewQt::EndFrameSubscription()
+{
+    m_frameSubscriber.reset();
+}
+
+QRect RenderWidgetHostViewQt::grabSourceRect(const gfx::Rect &src_subrect) const
+{
+    QRect sourceRect(QPoint(), m_delegate->contentsRect().size().toSize());
+    if (!src_subrect.IsEmpty())
+        sourceRect &= toQt(src_subrect);
+    return sourceRect;
+}
+
+bool RenderWidgetHostViewQt::grabContents(const gfx::Rect &src_subrect, const QSize &targetSize, const GrabCallback &callback)
+{
+    const QRect sourceRect = grabSourceRect(src_subrect);
+    if (sourceRect.isEmpty())
+        return false;
+    const QSize scaledSize = targetSize.isEmpty() ? sourceRect.size() : targetSize;
+
+    // Let the scene graph render only the source rect, scaled to the target size. This
+    // happens on the render thread and is delivered asynchronously so the UI thread doesn't
+    // wait for the GPU. The texture it is rendered into is kept to a size every GPU
+    // supports, larger images are scaled up afterwards.
+    QSize grabSize = scaledSize;
+    if (grabSize.width() > kMaxGrabTextureSize || grabSize.height() > kMaxGrabTextureSize)
+        grabSize.scale(kMaxGrabTextureSize, kMaxGrabTextureSize, Qt::KeepAspectRatio);
+
+    QSharedPointer<QQuickItemGrabResult> grab = m_delegate->grabContents(sourceRect, grabSize.expandedTo(QSize(1, 1)));
+    if (!grab)
+        return false;
+    m_pendingGrabs.append(grab);
+    QQuickItemGrabResult *grabPtr = grab.data();
+    QObject::connect(grabPtr, &QQuickItemGrabResult::ready, [this, grabPtr, scaledSize, callback] {
+        // Don't release the grab result from within its own signal.
+        content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
+            base::Bind(&RenderWidgetHostViewQt::finishGrab, AsWeakPtr(), grabPtr, scaledSize, callback));
+    });
+    return true;
+}
+
+void RenderWidgetHostViewQt::finishGrab(QQuickItemGrabResult *grabPtr, const QSize &targetSize, const GrabCallback &callback)
+{
+    QSharedPointer<QQuickItemGrabResult> grab;
+    for (int i = 0; i < m_pendingGrabs.size(); ++i) {
+        if (m_pendingGrabs.at(i).data() == grabPtr) {
+            grab = m_pendingGrabs.takeAt(i);
+            break;
+        }
+    }
+    Q_ASSERT(grab);
+
+    QImage image = grab->image();
+    if (!image.isNull() && image.size() != targetSize)
+        image = image.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    callback.Run(image);
+}
+
+void RenderWidgetHostViewQt::frameCaptureRateChanged()
+{
+    m_frameCaptureDirty = true;
+    captureFrame();
+}
+
+void RenderWidgetHostViewQt::captureFrame()
+{
+    WebContentsAdapter *adapter = m_adapterClient ? m_adapterClient->webContentsAdapter() : nullptr;
+    const int framesPerSecond = adapter ? adapter->frameCaptureRate() : 0;
+    if (framesPerSecond <= 0 || !m_frameCaptureDirty || m_frameCaptureInFlight || m_frameCaptureScheduled)
+        return;
+
+    const base::TimeTicks now = base::TimeTicks::Now();
+    const base::TimeDelta delay = m_lastFrameCaptureTime + base::TimeDelta::FromSeconds(1) / framesPerSecond - now;
+    if (delay > base::TimeDelta()) {
+        // Too early, capture whatever frame is the latest once the interval has passed.
+        m_frameCaptureScheduled = true;
+        content::BrowserThread::PostDelayedTask(content::BrowserThread::UI, FROM_HERE,
+            base::Bind(&RenderWidgetHostViewQt::frameCaptureTimeout, AsWeakPtr()), delay);
+        return;
+    }
+    // Only one capture is in flight at a time, frames swapped meanwhile are coalesced.
+    if (!grabContents(gfx::Rect(), QSize(), base::Bind(&RenderWidgetHostViewQt::didCaptureFrame, AsWeakPtr())))
+        return;
+    m_frameCaptureDirty = false;
+    m_frameCaptureInFlight = true;
+    m_lastFrameCaptureTime = now;
+}
+
+void RenderWidgetHostViewQt::frameCaptureTimeout()
+{
+    m_frameCaptureScheduled = false;
+    captureFrame();
+}
+
+void RenderWidgetHostViewQt::didCaptureFrame(const QImage &frame)
+{
+    m_frameCaptureInFlight = false;
+    if (!frame.isNull() && m_adapterClient)
+        m_adapterClient->didCaptureFrame(frame);
+    captureFrame();
 }
 
 bool RenderWidgetHostViewQt::HasAcceleratedSurface(const gfx::Size&)
@@ -658,8 +830,23 @@ void RenderWidgetHostViewQt::OnSwapCompositorFrame(uint32_t output_surface_id, c
     m_pendingOutputSurfaceId = output_surface_id;
     Q_ASSERT(frame.delegated_frame_data);
     Q_ASSERT(!m_chromiumCompositorData->frameData || m_chromiumCompositorData->frameData->resource_list.empty());
-    if (m_chromiumCompositorData->frameData.get())
-        m_chromiumCompositorData->previousFrameData = std::move(m_chromiumCompositorData->frameData);
+    gfx::Rect damageRect;
+    if (!frame.delegated_frame_data->render_pass_list.empty())
+        damageRect = gfx::ConvertRectToDIP(frame.metadata.device_scale_factor,
+                                           frame.delegated_frame_data->render_pass_list.back()->damage_rect);
+
+    WebContentsAdapter *adapter = m_adapterClient ? m_adapterClient->webContentsAdapter() : nullptr;
+    m_frameTimingRecorder = adapter ? adapter->frameTimingRecorder() : QSharedPointer<FrameTimingRecorder>();
+    m_pipelinedMailboxFetch = m_adapterClient
+            && m_adapterClient->webEngineSettings()->testAttribute(WebEngineSettings::PipelinedTextureFetchEnabled);
+    if (m_frameTimingRecorder) {
+        const cc::RenderPassList &renderPasses = frame.delegated_frame_data->render_pass_list;
+        int quadCount = 0;
+        for (unsigned i = 0; i < renderPasses.size(); ++i)
+            quadCount += renderPasses.at(i)->quad_list.size();
+        m_frameTimingRecorder->frameSwapped(renderPasses.size(), quadCount,
+                                            frame.delegated_frame_data->resource_list.size());
+    }
     m_chromiumCompositorData->frameData = std::move(frame.delegated_frame_data);
     m_chromiumCompositorData->frameDevicePixelRatio = frame.metadata.device_scale_factor;
 
@@ -681,6 +868,16 @@ void RenderWidgetHostViewQt::OnSwapCompositorFrame(uint32_t output_surface_id, c
         m_adapterClient->updateScrollPosition(toQt(m_lastScrollOffset));
     if (contentsSizeChanged)
         m_adapterClient->updateContentsSize(toQt(m_lastContentsSize));
+
+    if (m_frameSubscriber) {
+        const base::TimeTicks presentTime = base::TimeTicks::Now();
+        scoped_refptr<media::VideoFrame> videoFrame;
+        content::RenderWidgetHostViewFrameSubscriber::DeliverFrameCallback deliverCallback;
+        if (m_frameSubscriber->ShouldCaptureFrame(damageRect, presentTime, &videoFrame, &deliverCallback))
+            CopyFromCompositingSurfaceToVideoFrame(gfx::Rect(), videoFrame, base::Bind(deliverCallback, presentTime));
+    }
+    m_frameCaptureDirty = true;
+    captureFrame();
 }
 
 void RenderWidgetHostViewQt::GetScreenInfo(content::ScreenInfo* results)
@@ -727,10 +924,33 @@ void RenderWidgetHostViewQt::OnGestureEvent(const ui::GestureEventData& gesture)
 QSGNode *RenderWidgetHostViewQt::updatePaintNode(QSGNode *oldNode)
 {
     DelegatedFrameNode *frameNode = static_cast<DelegatedFrameNode *>(oldNode);
-    if (!frameNode)
+    if (!frameNode) {
         frameNode = new DelegatedFrameNode;
-
-    frameNode->commit(m_chromiumCompositorData.data(), &m_resourcesToRelease, m_delegate.get());
+        // Run on the GPU thread, schedule the update committing the frame that was held back.
+        frameNode->setMailboxPrefetchCallback(base::Bind(base::IgnoreResult(&content::BrowserThread::PostTask),
+                                                         content::BrowserThread::UI, FROM_HERE,
+                                                         base::Bind(&RenderWidgetHostViewQt::requestPaintNodeUpdate, AsWeakPtr())));
+    }
+    frameNode->setPipelinedMailboxFetch(m_pipelinedMailboxFetch);
+
+    // Only the first updates following a swap concern the new frame.
+    QSharedPointer<FrameTimingRecorder> frameTimingRecorder;
+    if (m_needsDelegatedFrameAck)
+        frameTimingRecorder = m_frameTimingRecorder;
+    frameNode->setFrameTimingRecorder(frameTimingRecorder);
+    if (frameTimingRecorder)
+        frameTimingRecorder->commitStarted();
+    const bool committed = frameNode->commit(m_chromiumCompositorData.data(), &m_resourcesToRelease, m_delegate.get());
+    if (frameTimingRecorder)
+        frameTimingRecorder->commitFinished(committed, m_resourcesToRelease.size(), frameNode->lastNodeTreeStats(),
+                                            frameNode->lastSoftwareTextureStats());
+
+    if (!committed) {
+        // The frame's textures are still being fetched, keep showing the previous frame and
+        // hold the ack so that the child compositor doesn't send a new one in the meantime.
+        // The node asks for another update once the textures are ready.
+        return frameNode;
+    }
 
     // This is possibly called from the Qt render thread, post the ack back to the UI
     // to tell the child compositors to release resources and trigger a new frame.
@@ -859,9 +1079,16 @@ void RenderWidgetHostViewQt::ProcessAckedTouchEvent(const content::TouchEventWit
     m_gestureProvider.OnTouchEventAck(touch.event.uniqueTouchEventId, eventConsumed);
 }
 
+void RenderWidgetHostViewQt::requestPaintNodeUpdate()
+{
+    m_delegate->update();
+}
+
 void RenderWidgetHostViewQt::sendDelegatedFrameAck()
 {
     m_beginFrameSource->DidFinishFrame(this, 0);
+    if (m_frameTimingRecorder)
+        m_frameTimingRecorder->frameAcked();
     cc::ReturnedResourceArray resources;
     m_resourcesToRelease.swap(resources);
     content::RenderWidgetHostImpl::SendReclaimCompositorResources(
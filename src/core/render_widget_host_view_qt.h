@@ -47,10 +47,12 @@
 #include "cc/resources/transferable_resource.h"
 #include "content/browser/accessibility/browser_accessibility_manager.h"
 #include "content/browser/renderer_host/render_widget_host_view_base.h"
+#include "content/browser/renderer_host/render_widget_host_view_frame_subscriber.h"
 #include "content/common/view_messages.h"
 #include "gpu/ipc/common/gpu_messages.h"
 #include "ui/events/gesture_detection/filtered_gesture_provider.h"
 #include "qtwebenginecoreglobal_p.h"
+#include <QList>
 #include <QMap>
 #include <QPoint>
 #include <QRect>
@@ -69,6 +71,7 @@ class QMouseEvent;
 class QVariant;
 class QWheelEvent;
 class QAccessibleInterface;
+class QQuickItemGrabResult;
 QT_END_NAMESPACE
 
 class WebContentsAdapterClient;
@@ -150,6 +153,8 @@ public:
     virtual void CopyFromCompositingSurfaceToVideoFrame(const gfx::Rect& src_subrect, const scoped_refptr<media::VideoFrame>& target, const base::Callback<void(const gfx::Rect&, bool)>& callback) Q_DECL_OVERRIDE;
 
     virtual bool CanCopyToVideoFrame() const Q_DECL_OVERRIDE;
+    virtual void BeginFrameSubscription(std::unique_ptr<content::RenderWidgetHostViewFrameSubscriber> subscriber) Q_DECL_OVERRIDE;
+    virtual void EndFrameSubscription() Q_DECL_OVERRIDE;
     virtual bool HasAcceleratedSurface(const gfx::Size&) Q_DECL_OVERRIDE;
     virtual void OnSwapCompositorFrame(uint32_t output_surface_id, cc::CompositorFrame frame)  Q_DECL_OVERRIDE;
 
@@ -209,14 +214,23 @@ public:
     void setLoadVisuallyCommittedState(LoadVisuallyCommittedState state) { m_loadVisuallyCommittedState = state; }
 
     gfx::SizeF lastContentsSize() const { return m_lastContentsSize; }
+    void frameCaptureRateChanged();
 
 private:
+    void requestPaintNodeUpdate();
     void sendDelegatedFrameAck();
     void processMotionEvent(const ui::MotionEvent &motionEvent);
     void clearPreviousTouchMotionState();
     QList<QTouchEvent::TouchPoint> mapTouchPointIds(const QList<QTouchEvent::TouchPoint> &inputPoints);
     float dpiScale() const;
     void updateNeedsBeginFramesInternal();
+    typedef base::Callback<void(const QImage &)> GrabCallback;
+    QRect grabSourceRect(const gfx::Rect &src_subrect) const;
+    bool grabContents(const gfx::Rect &src_subrect, const QSize &targetSize, const GrabCallback &callback);
+    void finishGrab(QQuickItemGrabResult *grab, const QSize &targetSize, const GrabCallback &callback);
+    void captureFrame();
+    void frameCaptureTimeout();
+    void didCaptureFrame(const QImage &frame);
 
     bool IsPopup() const;
 
@@ -228,10 +242,20 @@ private:
     QMap<int, int> m_touchIdMapping;
     QList<QTouchEvent::TouchPoint> m_previousTouchPoints;
     std::unique_ptr<RenderWidgetHostViewQtDelegate> m_delegate;
+    QList<QSharedPointer<QQuickItemGrabResult> > m_pendingGrabs;
+    std::unique_ptr<content::RenderWidgetHostViewFrameSubscriber> m_frameSubscriber;
+    base::TimeTicks m_lastFrameCaptureTime;
+    bool m_frameCaptureDirty;
+    bool m_frameCaptureInFlight;
+    bool m_frameCaptureScheduled;
 
     QExplicitlySharedDataPointer<ChromiumCompositorData> m_chromiumCompositorData;
+    // Set while the adapter records frame timings, taken over with each swapped frame.
+    QSharedPointer<FrameTimingRecorder> m_frameTimingRecorder;
     cc::ReturnedResourceArray m_resourcesToRelease;
     bool m_needsDelegatedFrameAck;
+    // Taken from the page settings with each swapped frame.
+    bool m_pipelinedMailboxFetch;
     LoadVisuallyCommittedState m_loadVisuallyCommittedState;
     uint32_t m_pendingOutputSurfaceId;
 
@@ -43,12 +43,14 @@
 #include "qtwebenginecoreglobal.h"
 
 #include <QRect>
+#include <QSharedPointer>
 #include <QtGui/qwindowdefs.h>
 
 QT_BEGIN_NAMESPACE
 class QCursor;
 class QEvent;
 class QPainter;
+class QQuickItemGrabResult;
 class QSGLayer;
 class QSGNode;
 class QSGRectangleNode;
@@ -114,6 +116,8 @@ public:
     virtual void inputMethodStateChanged(bool editorVisible) = 0;
     virtual void setInputMethodHints(Qt::InputMethodHints hints) = 0;
     virtual void setClearColor(const QColor &color) = 0;
+    // Renders \a sourceRect of the contents, in item coordinates, into an image of \a targetSize.
+    virtual QSharedPointer<QQuickItemGrabResult> grabContents(const QRect &sourceRect, const QSize &targetSize) = 0;
 };
 
 } // namespace QtWebEngineCore
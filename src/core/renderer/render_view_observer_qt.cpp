@@ -40,7 +40,9 @@
 #include "renderer/render_view_observer_qt.h"
 
 #include "common/qt_messages.h"
+#include "renderer/v8_json_conversion.h"
 
+#include "base/third_party/icu/icu_utf.h"
 #include "components/web_cache/renderer/web_cache_impl.h"
 #include "content/public/renderer/render_view.h"
 #include "third_party/WebKit/public/web/WebDocument.h"
@@ -49,8 +51,18 @@
 #include "third_party/WebKit/public/web/WebFrameContentDumper.h"
 #include "third_party/WebKit/public/web/WebFrameWidget.h"
 #include "third_party/WebKit/public/web/WebLocalFrame.h"
+#include "third_party/WebKit/public/web/WebScriptSource.h"
 #include "third_party/WebKit/public/web/WebView.h"
 
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <algorithm>
+#include <limits>
+
+// Bounds the size of each IPC message, and of each string the browser has to convert.
+static const size_t kDocumentChunkLength = 256 * 1024;
+
 RenderViewObserverQt::RenderViewObserverQt(
         content::RenderView* render_view,
         web_cache::WebCacheImpl* web_cache_impl)
@@ -78,6 +90,116 @@ void RenderViewObserverQt::onFetchDocumentInnerText(quint64 requestId)
     Send(new RenderViewObserverHostQt_DidFetchDocumentInnerText(routing_id(), requestId, text));
 }
 
+static size_t toLength(quint64 maxLength)
+{
+    return static_cast<size_t>(std::min<quint64>(maxLength, std::numeric_limits<size_t>::max()));
+}
+
+void RenderViewObserverQt::onStreamDocumentMarkup(quint64 requestId, quint64 maxLength)
+{
+    base::string16 markup;
+    if (render_view()->GetWebView()->mainFrame()->isWebLocalFrame())
+        markup = blink::WebFrameContentDumper::dumpAsMarkup(
+                    static_cast<blink::WebLocalFrame*>(render_view()->GetWebView()->mainFrame()));
+    size_t length = toLength(maxLength);
+    if (markup.size() > length) {
+        if (length && CBU16_IS_LEAD(markup[length - 1]))
+            --length;
+        markup.resize(length);
+    }
+    sendDocumentChunks(requestId, markup);
+}
+
+void RenderViewObserverQt::onStreamDocumentInnerText(quint64 requestId, quint64 maxLength)
+{
+    base::string16 text;
+    if (render_view()->GetWebView()->mainFrame()->isWebLocalFrame())
+        text = blink::WebFrameContentDumper::dumpWebViewAsText(render_view()->GetWebView(), toLength(maxLength));
+    sendDocumentChunks(requestId, text);
+}
+
+void RenderViewObserverQt::sendDocumentChunks(quint64 requestId, const base::string16 &document)
+{
+    size_t offset = 0;
+    do {
+        size_t length = std::min(kDocumentChunkLength, document.size() - offset);
+        // Each chunk is converted on its own by the browser, keep surrogate pairs together.
+        if (offset + length < document.size() && CBU16_IS_LEAD(document[offset + length - 1]))
+            --length;
+        const bool last = offset + length == document.size();
+        Send(new RenderViewObserverHostQt_DidStreamDocumentChunk(routing_id(), requestId,
+                                                                 document.substr(offset, length), last));
+        offset += length;
+    } while (offset < document.size());
+}
+
+static blink::WebLocalFrame *findLocalFrame(blink::WebView *view, const base::string16 &frameName)
+{
+    blink::WebFrame *frame = view->mainFrame();
+    if (!frameName.empty()) {
+        const blink::WebString name(frameName);
+        while (frame && frame->assignedName() != name)
+            frame = frame->traverseNext();
+    }
+    // Frames living in another renderer process can't be scripted from here.
+    if (!frame || !frame->isWebLocalFrame())
+        return nullptr;
+    return frame->toWebLocalFrame();
+}
+
+static QJsonValue executeScript(blink::WebLocalFrame *frame, const base::string16 &script, uint worldId)
+{
+    v8::HandleScope handleScope(v8::Isolate::GetCurrent());
+    blink::WebScriptSource source(script);
+    v8::Local<v8::Value> value;
+    v8::Local<v8::Context> context;
+    if (worldId == 0) {
+        value = frame->executeScriptAndReturnValue(source);
+        context = frame->mainWorldScriptContext();
+    } else {
+        blink::WebVector<v8::Local<v8::Value> > values;
+        frame->executeScriptInIsolatedWorld(worldId, &source, /*numSources = */1, /*extensionGroup = */ 0, &values);
+        if (values.size())
+            value = values[0];
+        context = frame->isolatedWorldScriptContext(worldId, 0);
+    }
+    // Convert straight to the binary JSON format, the browser then reads the
+    // result lazily without any intermediate base::Value or QVariant tree.
+    if (value.IsEmpty() || context.IsEmpty())
+        return QJsonValue();
+    v8::Context::Scope contextScope(context);
+    return QtWebEngineCore::fromV8(value);
+}
+
+void RenderViewObserverQt::onExecuteJavaScript(quint64 requestId, const base::string16 &script, uint worldId)
+{
+    QJsonValue result;
+    if (blink::WebLocalFrame *frame = findLocalFrame(render_view()->GetWebView(), base::string16()))
+        result = executeScript(frame, script, worldId);
+    // Binary JSON documents only hold objects or arrays, wrap the result so that it can be any value.
+    QJsonArray wrapper;
+    wrapper.append(result);
+    const QJsonDocument doc(wrapper);
+    int size = 0;
+    const char *rawData = doc.rawData(&size);
+    Send(new RenderViewObserverHostQt_DidExecuteJavaScript(routing_id(), requestId, QByteArray::fromRawData(rawData, size)));
+}
+
+void RenderViewObserverQt::onExecuteJavaScriptBatch(quint64 requestId, const std::vector<base::string16> &scripts,
+                                                    uint worldId, const base::string16 &frameName)
+{
+    QJsonArray results;
+    for (const base::string16 &script : scripts) {
+        // Look the frame up again for every script, a previous one might have removed or navigated it.
+        blink::WebLocalFrame *frame = findLocalFrame(render_view()->GetWebView(), frameName);
+        results.append(frame ? executeScript(frame, script, worldId) : QJsonValue());
+    }
+    const QJsonDocument doc(results);
+    int size = 0;
+    const char *rawData = doc.rawData(&size);
+    Send(new RenderViewObserverHostQt_DidExecuteJavaScriptBatch(routing_id(), requestId, QByteArray::fromRawData(rawData, size)));
+}
+
 void RenderViewObserverQt::onSetBackgroundColor(quint32 color)
 {
     render_view()->GetWebFrameWidget()->setBaseBackgroundColor(color);
@@ -89,7 +211,11 @@ bool RenderViewObserverQt::OnMessageReceived(const IPC::Message& message)
     IPC_BEGIN_MESSAGE_MAP(RenderViewObserverQt, message)
         IPC_MESSAGE_HANDLER(RenderViewObserverQt_FetchDocumentMarkup, onFetchDocumentMarkup)
         IPC_MESSAGE_HANDLER(RenderViewObserverQt_FetchDocumentInnerText, onFetchDocumentInnerText)
+        IPC_MESSAGE_HANDLER(RenderViewObserverQt_StreamDocumentMarkup, onStreamDocumentMarkup)
+        IPC_MESSAGE_HANDLER(RenderViewObserverQt_StreamDocumentInnerText, onStreamDocumentInnerText)
         IPC_MESSAGE_HANDLER(RenderViewObserverQt_SetBackgroundColor, onSetBackgroundColor)
+        IPC_MESSAGE_HANDLER(RenderViewObserverQt_ExecuteJavaScript, onExecuteJavaScript)
+        IPC_MESSAGE_HANDLER(RenderViewObserverQt_ExecuteJavaScriptBatch, onExecuteJavaScriptBatch)
         IPC_MESSAGE_UNHANDLED(handled = false)
     IPC_END_MESSAGE_MAP()
     return handled;
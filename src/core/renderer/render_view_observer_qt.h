@@ -39,6 +39,7 @@
 #ifndef RENDER_VIEW_OBSERVER_QT_H
 #define RENDER_VIEW_OBSERVER_QT_H
 
+#include "base/strings/string16.h"
 #include "content/public/renderer/render_view_observer.h"
 
 #include <QtGlobal>
@@ -55,7 +56,13 @@ public:
 private:
     void onFetchDocumentMarkup(quint64 requestId);
     void onFetchDocumentInnerText(quint64 requestId);
+    void onStreamDocumentMarkup(quint64 requestId, quint64 maxLength);
+    void onStreamDocumentInnerText(quint64 requestId, quint64 maxLength);
+    void sendDocumentChunks(quint64 requestId, const base::string16 &document);
     void onSetBackgroundColor(quint32 color);
+    void onExecuteJavaScript(quint64 requestId, const base::string16 &script, uint worldId);
+    void onExecuteJavaScriptBatch(quint64 requestId, const std::vector<base::string16> &scripts, uint worldId,
+                                  const base::string16 &frameName);
 
     void OnDestruct() Q_DECL_OVERRIDE { }
 
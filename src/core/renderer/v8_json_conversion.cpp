@@ -0,0 +1,198 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "renderer/v8_json_conversion.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <map>
+
+namespace QtWebEngineCore {
+
+// Same limit as content::V8ValueConverter, deeper structures are replaced by null.
+static const int kMaxMessageDepth = 100;
+
+// The objects on the path from the root to the value being converted, keyed on their
+// identity hash. An object referring back to one of them would be converted endlessly.
+typedef std::multimap<int, v8::Handle<v8::Object>> ConversionPath;
+
+static bool isOnPath(const ConversionPath &path, v8::Handle<v8::Object> object)
+{
+    const auto range = path.equal_range(object->GetIdentityHash());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->StrictEquals(object))
+            return true;
+    }
+    return false;
+}
+
+v8::Handle<v8::Value> toV8(v8::Isolate *isolate, const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        return v8::Boolean::New(isolate, value.toBool());
+    case QJsonValue::Double:
+        return v8::Number::New(isolate, value.toDouble());
+    case QJsonValue::String: {
+        const QString string = value.toString();
+        return v8::String::NewFromTwoByte(isolate, reinterpret_cast<const uint16_t *>(string.utf16()),
+                                          v8::String::kNormalString, string.length());
+    }
+    case QJsonValue::Array: {
+        const QJsonArray array = value.toArray();
+        v8::Handle<v8::Array> v8Array = v8::Array::New(isolate, array.size());
+        for (int i = 0; i < array.size(); ++i)
+            v8Array->Set(i, toV8(isolate, array.at(i)));
+        return v8Array;
+    }
+    case QJsonValue::Object: {
+        const QJsonObject object = value.toObject();
+        v8::Handle<v8::Object> v8Object = v8::Object::New(isolate);
+        for (QJsonObject::const_iterator it = object.constBegin(); it != object.constEnd(); ++it)
+            v8Object->Set(toV8(isolate, QJsonValue(it.key())), toV8(isolate, it.value()));
+        return v8Object;
+    }
+    case QJsonValue::Null:
+    case QJsonValue::Undefined:
+        break;
+    }
+    return v8::Null(isolate);
+}
+
+static QJsonValue toQString(v8::Local<v8::Context> context, v8::Local<v8::Value> value)
+{
+    v8::Local<v8::String> string;
+    if (!value->ToString(context).ToLocal(&string))
+        return QJsonValue();
+    v8::String::Value utf16(string);
+    return QString(reinterpret_cast<const QChar *>(*utf16), utf16.length());
+}
+
+// Reads a property like content::V8ValueConverter does, in its own TryCatch so that
+// a throwing getter or proxy trap only loses that property.
+template<typename Key>
+static bool getProperty(v8::Local<v8::Context> context, v8::Local<v8::Object> object, Key key,
+                        v8::Local<v8::Value> *result)
+{
+    v8::TryCatch tryCatch(context->GetIsolate());
+    return object->Get(context, key).ToLocal(result);
+}
+
+// Getters, proxies and wrapper objects can run script and throw, anything that fails
+// to convert that way becomes null. The caller holds a TryCatch that swallows the exceptions.
+static QJsonValue fromV8(v8::Local<v8::Context> context, v8::Local<v8::Value> value, int depth, ConversionPath *path)
+{
+    if (depth > kMaxMessageDepth)
+        return QJsonValue();
+    if (value->IsBoolean() || value->IsBooleanObject()) {
+        bool boolean = false;
+        if (!value->BooleanValue(context).To(&boolean))
+            return QJsonValue();
+        return boolean;
+    }
+    if (value->IsNumber() || value->IsNumberObject()) {
+        double number = 0;
+        if (!value->NumberValue(context).To(&number))
+            return QJsonValue();
+        return number;
+    }
+    if (value->IsString() || value->IsStringObject())
+        return toQString(context, value);
+    // Like JSON.stringify, skip functions.
+    if (!value->IsObject() || value->IsFunction())
+        return QJsonValue();
+
+    v8::Local<v8::Object> v8Object;
+    if (!value->ToObject(context).ToLocal(&v8Object))
+        return QJsonValue();
+    // Where JSON.stringify would throw on a cycle, the reference is replaced by null.
+    if (isOnPath(*path, v8Object))
+        return QJsonValue();
+    const auto pathEntry = path->insert(std::make_pair(v8Object->GetIdentityHash(), v8Object));
+
+    QJsonValue result;
+    if (value->IsArray()) {
+        v8::Local<v8::Array> v8Array = v8::Local<v8::Array>::Cast(value);
+        QJsonArray array;
+        for (uint32_t i = 0; i < v8Array->Length(); ++i) {
+            v8::Local<v8::Value> element;
+            if (getProperty(context, v8Array, i, &element))
+                array.append(fromV8(context, element, depth + 1, path));
+            else
+                array.append(QJsonValue());
+        }
+        result = array;
+    } else {
+        v8::Local<v8::Array> keys;
+        if (v8Object->GetOwnPropertyNames(context).ToLocal(&keys)) {
+            QJsonObject object;
+            for (uint32_t i = 0; i < keys->Length(); ++i) {
+                v8::Local<v8::Value> key;
+                if (!keys->Get(context, i).ToLocal(&key))
+                    continue;
+                const QJsonValue name = toQString(context, key);
+                if (!name.isString())
+                    continue;
+                v8::Local<v8::Value> property;
+                if (!getProperty(context, v8Object, key, &property)) {
+                    object.insert(name.toString(), QJsonValue());
+                    continue;
+                }
+                if (property->IsFunction() || property->IsUndefined())
+                    continue;
+                object.insert(name.toString(), fromV8(context, property, depth + 1, path));
+            }
+            result = object;
+        }
+    }
+
+    path->erase(pathEntry);
+    return result;
+}
+
+QJsonValue fromV8(v8::Handle<v8::Value> value)
+{
+    v8::Isolate *isolate = v8::Isolate::GetCurrent();
+    v8::TryCatch tryCatch(isolate);
+    ConversionPath path;
+    return fromV8(isolate->GetCurrentContext(), value, 0, &path);
+}
+
+} // namespace QtWebEngineCore
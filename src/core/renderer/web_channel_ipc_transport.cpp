@@ -43,6 +43,7 @@
 #include "renderer/web_channel_ipc_transport.h"
 
 #include "common/qt_messages.h"
+#include "renderer/v8_json_conversion.h"
 
 #include "content/public/renderer/render_frame.h"
 #include "content/public/renderer/render_view.h"
@@ -54,10 +55,35 @@
 #include "third_party/WebKit/public/web/WebView.h"
 #include "v8/include/v8.h"
 
+#include <QJsonArray>
 #include <QJsonDocument>
+#include <QJsonObject>
 
 namespace QtWebEngineCore {
 
+static v8::Handle<v8::Object> createMessageObject(v8::Isolate *isolate, v8::Handle<v8::Context> context,
+                                                  const QJsonObject &message, bool objectMessages)
+{
+    // In object mode the message is built directly from the binary JSON, so the page
+    // does not have to JSON.parse it. qwebchannel.js accepts both.
+    v8::Handle<v8::Value> data;
+    if (objectMessages) {
+        data = toV8(isolate, message);
+    } else {
+        QByteArray json = QJsonDocument(message).toJson(QJsonDocument::Compact);
+        data = v8::String::NewFromUtf8(isolate, json.constData(), v8::String::kNormalString, json.size());
+    }
+
+    v8::Handle<v8::Object> messageObject(v8::Object::New(isolate));
+    v8::Maybe<bool> wasSet = messageObject->DefineOwnProperty(
+                context,
+                v8::String::NewFromUtf8(isolate, "data"),
+                data,
+                v8::PropertyAttribute(v8::ReadOnly | v8::DontDelete));
+    Q_ASSERT(!wasSet.IsNothing() && wasSet.FromJust());
+    return messageObject;
+}
+
 class WebChannelTransport : public gin::Wrappable<WebChannelTransport> {
 public:
     static gin::WrapperInfo kWrapperInfo;
@@ -75,18 +101,24 @@ private:
             return;
         v8::Handle<v8::Value> val;
         args->GetNext(&val);
-        if (!val->IsString() && !val->IsStringObject())
-            return;
-        v8::String::Utf8Value utf8(val->ToString());
+        QJsonDocument doc;
+        if (val->IsString() || val->IsStringObject()) {
+            v8::String::Utf8Value utf8(val->ToString());
 
-        QByteArray valueData(*utf8, utf8.length());
-        QJsonParseError error;
-        QJsonDocument doc = QJsonDocument::fromJson(valueData, &error);
-        if (error.error != QJsonParseError::NoError)
-            qWarning("%s %d: Parsing error: %s",__FILE__, __LINE__, qPrintable(error.errorString()));
+            QByteArray valueData(*utf8, utf8.length());
+            QJsonParseError error;
+            doc = QJsonDocument::fromJson(valueData, &error);
+            if (error.error != QJsonParseError::NoError)
+                qWarning("%s %d: Parsing error: %s",__FILE__, __LINE__, qPrintable(error.errorString()));
+        } else if (val->IsObject() && !val->IsArray() && !val->IsFunction()) {
+            // Messages sent as objects go straight to the binary JSON format, without any JSON text in between.
+            doc = QJsonDocument(fromV8(val).toObject());
+        } else {
+            return;
+        }
         int size = 0;
         const char *rawData = doc.rawData(&size);
-        renderView->Send(new WebChannelIPCTransportHost_SendMessage(renderView->GetRoutingID(), std::vector<char>(rawData, rawData + size)));
+        renderView->Send(new WebChannelIPCTransportHost_SendMessage(renderView->GetRoutingID(), QByteArray::fromRawData(rawData, size)));
     }
 
     DISALLOW_COPY_AND_ASSIGN(WebChannelTransport);
@@ -157,6 +189,7 @@ WebChannelIPCTransport::WebChannelIPCTransport(content::RenderView *renderView)
     , content::RenderViewObserverTracker<WebChannelIPCTransport>(renderView)
     , m_installed(false)
     , m_installedWorldId(0)
+    , m_objectMessages(false)
 {
 }
 
@@ -169,7 +202,7 @@ void WebChannelIPCTransport::RunScriptsAtDocumentStart(content::RenderFrame *ren
 }
 
 
-void WebChannelIPCTransport::installWebChannel(uint worldId)
+void WebChannelIPCTransport::installWebChannel(uint worldId, bool objectMessages)
 {
     blink::WebView *webView = render_view()->GetWebView();
     if (!webView)
@@ -177,6 +210,7 @@ void WebChannelIPCTransport::installWebChannel(uint worldId)
     WebChannelTransport::Install(webView->mainFrame(), worldId);
     m_installed = true;
     m_installedWorldId = worldId;
+    m_objectMessages = objectMessages;
 }
 
 void WebChannelIPCTransport::uninstallWebChannel(uint worldId)
@@ -189,15 +223,21 @@ void WebChannelIPCTransport::uninstallWebChannel(uint worldId)
     m_installed = false;
 }
 
-void WebChannelIPCTransport::dispatchWebChannelMessage(const std::vector<char> &binaryJSON, uint worldId)
+void WebChannelIPCTransport::setObjectMessages(bool objectMessages)
+{
+    // Only affects the messages dispatched from now on, the installed transport object stays.
+    m_objectMessages = objectMessages;
+}
+
+void WebChannelIPCTransport::dispatchWebChannelMessage(const QByteArray &binaryJSON, uint worldId)
 {
     blink::WebView *webView = render_view()->GetWebView();
     if (!webView)
         return;
 
-    QJsonDocument doc = QJsonDocument::fromRawData(binaryJSON.data(), binaryJSON.size(), QJsonDocument::BypassValidation);
-    Q_ASSERT(doc.isObject());
-    QByteArray json = doc.toJson(QJsonDocument::Compact);
+    // A batch of messages comes as an array.
+    QJsonDocument doc = QJsonDocument::fromRawData(binaryJSON.constData(), binaryJSON.size(), QJsonDocument::BypassValidation);
+    Q_ASSERT(doc.isObject() || doc.isArray());
 
     v8::Isolate *isolate = v8::Isolate::GetCurrent();
     v8::HandleScope handleScope(isolate);
@@ -216,25 +256,40 @@ void WebChannelIPCTransport::dispatchWebChannelMessage(const std::vector<char> &
     v8::Handle<v8::Value> webChannelObjectValue(qtObjectValue->ToObject()->Get(gin::StringToV8(isolate, "webChannelTransport")));
     if (!webChannelObjectValue->IsObject())
         return;
-    v8::Handle<v8::Value> onmessageCallbackValue(webChannelObjectValue->ToObject()->Get(gin::StringToV8(isolate, "onmessage")));
+    v8::Handle<v8::Object> webChannelObject = webChannelObjectValue->ToObject();
+
+    if (doc.isArray()) {
+        // Clients that know about batches get the whole batch in one call.
+        v8::Handle<v8::Value> onmessagesCallbackValue(webChannelObject->Get(gin::StringToV8(isolate, "onmessages")));
+        if (onmessagesCallbackValue->IsFunction()) {
+            const QJsonArray messages = doc.array();
+            v8::Handle<v8::Array> messageObjects = v8::Array::New(isolate, messages.size());
+            for (int i = 0; i < messages.size(); ++i)
+                messageObjects->Set(i, createMessageObject(isolate, context, messages.at(i).toObject(), m_objectMessages));
+
+            v8::Handle<v8::Function> callback = v8::Handle<v8::Function>::Cast(onmessagesCallbackValue);
+            const int argc = 1;
+            v8::Handle<v8::Value> argv[argc];
+            argv[0] = messageObjects;
+            frame->callFunctionEvenIfScriptDisabled(callback, webChannelObject, argc, argv);
+            return;
+        }
+    }
+
+    v8::Handle<v8::Value> onmessageCallbackValue(webChannelObject->Get(gin::StringToV8(isolate, "onmessage")));
     if (!onmessageCallbackValue->IsFunction()) {
         qWarning("onmessage is not a callable property of qt.webChannelTransport. Some things might not work as expected.");
         return;
     }
-
-    v8::Handle<v8::Object> messageObject(v8::Object::New(isolate));
-    v8::Maybe<bool> wasSet = messageObject->DefineOwnProperty(
-                context,
-                v8::String::NewFromUtf8(isolate, "data"),
-                v8::String::NewFromUtf8(isolate, json.constData(), v8::String::kNormalString, json.size()),
-                v8::PropertyAttribute(v8::ReadOnly | v8::DontDelete));
-    Q_ASSERT(!wasSet.IsNothing() && wasSet.FromJust());
-
     v8::Handle<v8::Function> callback = v8::Handle<v8::Function>::Cast(onmessageCallbackValue);
-    const int argc = 1;
-    v8::Handle<v8::Value> argv[argc];
-    argv[0] = messageObject;
-    frame->callFunctionEvenIfScriptDisabled(callback, webChannelObjectValue->ToObject(), argc, argv);
+
+    const QJsonArray messages = doc.isArray() ? doc.array() : QJsonArray() << doc.object();
+    Q_FOREACH (const QJsonValue &message, messages) {
+        const int argc = 1;
+        v8::Handle<v8::Value> argv[argc];
+        argv[0] = createMessageObject(isolate, context, message.toObject(), m_objectMessages);
+        frame->callFunctionEvenIfScriptDisabled(callback, webChannelObject, argc, argv);
+    }
 }
 
 bool WebChannelIPCTransport::OnMessageReceived(const IPC::Message &message)
@@ -243,6 +298,7 @@ bool WebChannelIPCTransport::OnMessageReceived(const IPC::Message &message)
     IPC_BEGIN_MESSAGE_MAP(WebChannelIPCTransport, message)
         IPC_MESSAGE_HANDLER(WebChannelIPCTransport_Install, installWebChannel)
         IPC_MESSAGE_HANDLER(WebChannelIPCTransport_Uninstall, uninstallWebChannel)
+        IPC_MESSAGE_HANDLER(WebChannelIPCTransport_SetObjectMessages, setObjectMessages)
         IPC_MESSAGE_HANDLER(WebChannelIPCTransport_Message, dispatchWebChannelMessage)
         IPC_MESSAGE_UNHANDLED(handled = false)
     IPC_END_MESSAGE_MAP()
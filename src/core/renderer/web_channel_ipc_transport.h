@@ -44,6 +44,7 @@
 #include "content/public/renderer/render_view_observer.h"
 #include "content/public/renderer/render_view_observer_tracker.h"
 #include <QtCore/qcompilerdetection.h>
+#include <QtCore/QByteArray>
 
 namespace content {
 class RenderFrame;
@@ -64,14 +65,16 @@ public:
     void RunScriptsAtDocumentStart(content::RenderFrame *render_frame);
 
 private:
-    void dispatchWebChannelMessage(const std::vector<char> &binaryJSON, uint worldId);
-    void installWebChannel(uint worldId);
+    void dispatchWebChannelMessage(const QByteArray &binaryJSON, uint worldId);
+    void installWebChannel(uint worldId, bool objectMessages);
     void uninstallWebChannel(uint worldId);
+    void setObjectMessages(bool objectMessages);
     virtual bool OnMessageReceived(const IPC::Message &message) Q_DECL_OVERRIDE;
     virtual void OnDestruct() Q_DECL_OVERRIDE { }
 
     bool m_installed;
     uint m_installedWorldId;
+    bool m_objectMessages;
 };
 
 } // namespace
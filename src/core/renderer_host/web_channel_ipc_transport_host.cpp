@@ -44,6 +44,7 @@
 #include "common/qt_messages.h"
 #include "type_conversion.h"
 
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 
@@ -53,41 +54,106 @@ WebChannelIPCTransportHost::WebChannelIPCTransportHost(content::WebContents *con
     : QWebChannelAbstractTransport(parent)
     , content::WebContentsObserver(contents)
     , m_worldId(worldId)
+    , m_objectMessages(false)
+    , m_batchMessages(false)
 {
-    Send(new WebChannelIPCTransport_Install(routing_id(), m_worldId));
+    // Batching gathers the messages sent within the batch interval after the first pending one,
+    // or within the current event loop iteration for 0, into a single IPC message.
+    m_batchTimer.setSingleShot(true);
+    m_batchTimer.setInterval(0);
+    connect(&m_batchTimer, &QTimer::timeout, this, &WebChannelIPCTransportHost::flushMessages);
+    Send(new WebChannelIPCTransport_Install(routing_id(), m_worldId, m_objectMessages));
 }
 
 WebChannelIPCTransportHost::~WebChannelIPCTransportHost()
 {
+    // Messages sent before the channel went away still reach the page.
+    flushMessages();
+}
+
+void WebChannelIPCTransportHost::setMessageBatching(bool enabled, int interval)
+{
+    if (enabled == m_batchMessages && interval == m_batchTimer.interval())
+        return;
+    // The pending messages were gathered with the previous configuration.
+    flushMessages();
+    m_batchMessages = enabled;
+    m_batchTimer.setInterval(interval);
+}
+
+void WebChannelIPCTransportHost::setObjectMessages(bool enabled)
+{
+    if (enabled == m_objectMessages)
+        return;
+    // Messages already sent are delivered the way they were sent.
+    flushMessages();
+    m_objectMessages = enabled;
+    Send(new WebChannelIPCTransport_SetObjectMessages(routing_id(), m_objectMessages));
 }
 
 void WebChannelIPCTransportHost::RenderViewHostChanged(content::RenderViewHost *, content::RenderViewHost *)
 {
+    // Whatever is pending was meant for the old page.
+    m_batchTimer.stop();
+    m_pendingMessages = QJsonArray();
+
     // This means that we were moved into a different RenderView, possibly in a different
     // render process and that we lost our WebChannelIPCTransport object and its state.
-    Send(new WebChannelIPCTransport_Install(routing_id(), m_worldId));
+    Send(new WebChannelIPCTransport_Install(routing_id(), m_worldId, m_objectMessages));
+}
+
+void WebChannelIPCTransportHost::WebContentsDestroyed()
+{
+    // There is no page left to send the pending messages to.
+    m_batchTimer.stop();
+    m_pendingMessages = QJsonArray();
 }
 
 void WebChannelIPCTransportHost::setWorldId(uint worldId)
 {
     if (worldId == m_worldId)
         return;
+    flushMessages();
     Send(new WebChannelIPCTransport_Uninstall(routing_id(), m_worldId));
     m_worldId = worldId;
-    Send(new WebChannelIPCTransport_Install(routing_id(), m_worldId));
+    Send(new WebChannelIPCTransport_Install(routing_id(), m_worldId, m_objectMessages));
 }
 
 void WebChannelIPCTransportHost::sendMessage(const QJsonObject &message)
 {
-    QJsonDocument doc(message);
+    if (m_batchMessages) {
+        m_pendingMessages.append(message);
+        if (!m_batchTimer.isActive())
+            m_batchTimer.start();
+        return;
+    }
+    sendDocument(QJsonDocument(message));
+}
+
+void WebChannelIPCTransportHost::flushMessages()
+{
+    m_batchTimer.stop();
+    if (m_pendingMessages.isEmpty())
+        return;
+    // Lone messages are sent as they are, the renderer only sees arrays for actual batches.
+    if (m_pendingMessages.size() == 1)
+        sendDocument(QJsonDocument(m_pendingMessages.first().toObject()));
+    else
+        sendDocument(QJsonDocument(m_pendingMessages));
+    m_pendingMessages = QJsonArray();
+}
+
+void WebChannelIPCTransportHost::sendDocument(const QJsonDocument &doc)
+{
     int size = 0;
     const char *rawData = doc.rawData(&size);
-    Send(new WebChannelIPCTransport_Message(routing_id(), std::vector<char>(rawData, rawData + size), m_worldId));
+    // Writing the IPC message copies the data already.
+    Send(new WebChannelIPCTransport_Message(routing_id(), QByteArray::fromRawData(rawData, size), m_worldId));
 }
 
-void WebChannelIPCTransportHost::onWebChannelMessage(const std::vector<char> &message)
+void WebChannelIPCTransportHost::onWebChannelMessage(const QByteArray &message)
 {
-    QJsonDocument doc = QJsonDocument::fromRawData(message.data(), message.size(), QJsonDocument::BypassValidation);
+    QJsonDocument doc = QJsonDocument::fromRawData(message.constData(), message.size(), QJsonDocument::BypassValidation);
     Q_ASSERT(doc.isObject());
     Q_EMIT messageReceived(doc.object(), this);
 }
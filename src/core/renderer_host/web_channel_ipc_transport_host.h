@@ -45,8 +45,11 @@
 #include "content/public/browser/web_contents_observer.h"
 
 #include "qtwebenginecoreglobal.h"
+#include <QtCore/QJsonArray>
 #include <QtCore/QObject>
+#include <QtCore/QTimer>
 
+QT_FORWARD_DECLARE_CLASS(QJsonDocument)
 QT_FORWARD_DECLARE_CLASS(QString)
 
 namespace QtWebEngineCore {
@@ -60,6 +63,7 @@ public:
 
     // WebContentsObserver
     virtual void RenderViewHostChanged(content::RenderViewHost* old_host, content::RenderViewHost* new_host) Q_DECL_OVERRIDE;
+    virtual void WebContentsDestroyed() Q_DECL_OVERRIDE;
 
     // QWebChannelAbstractTransport
     void sendMessage(const QJsonObject &message) Q_DECL_OVERRIDE;
@@ -67,10 +71,21 @@ public:
     void setWorldId(uint worldId);
     uint worldId() const { return m_worldId; }
 
+    void setMessageBatching(bool enabled, int interval);
+    void setObjectMessages(bool enabled);
+
 private:
     bool OnMessageReceived(const IPC::Message& message) Q_DECL_OVERRIDE;
-    void onWebChannelMessage(const std::vector<char> &message);
+    void onWebChannelMessage(const QByteArray &message);
+    void flushMessages();
+    void sendDocument(const QJsonDocument &doc);
+
     uint m_worldId;
+    // Whether the page receives messages as objects rather than JSON text.
+    bool m_objectMessages;
+    bool m_batchMessages;
+    QJsonArray m_pendingMessages;
+    QTimer m_batchTimer;
 };
 
 } // namespace
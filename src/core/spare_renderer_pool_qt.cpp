@@ -0,0 +1,214 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "spare_renderer_pool_qt.h"
+
+#include "base/bind.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/site_instance.h"
+
+#include <algorithm>
+
+#include <QtGlobal>
+
+namespace QtWebEngineCore {
+
+// Spare processes that have not been used for this long are shut down, except for one
+// that is kept as long as the profile still has pages. The pool is filled again when
+// the profile launches its next render process.
+static const int kSpareRendererIdleTimeoutMinutes = 5;
+
+SpareRendererPoolQt::SpareRendererPoolQt(content::BrowserContext *browserContext)
+    : m_browserContext(browserContext)
+    , m_size(0)
+    , m_active(false)
+    , m_fillScheduled(false)
+    , m_launchingSpare(false)
+    , m_weakPtrFactory(this)
+{
+    bool ok = false;
+    const int size = qEnvironmentVariableIntValue("QTWEBENGINE_SPARE_RENDERER_PROCESSES", &ok);
+    if (ok && size > 0)
+        m_size = size;
+}
+
+SpareRendererPoolQt::~SpareRendererPoolQt()
+{
+    releaseSpares(0);
+}
+
+void SpareRendererPoolQt::setSize(int size)
+{
+    size = std::max(size, 0);
+    if (size == m_size)
+        return;
+    m_size = size;
+    releaseSpares(m_size);
+    if (m_active)
+        scheduleFill();
+}
+
+scoped_refptr<content::SiteInstance> SpareRendererPoolQt::takeSpareSiteInstance()
+{
+    if (!m_size || content::RenderProcessHost::run_renderer_in_process())
+        return nullptr;
+
+    m_active = true;
+    scheduleFill();
+    if (m_spares.empty())
+        return nullptr;
+
+    Spare spare = m_spares.front();
+    m_spares.erase(m_spares.begin());
+    spare.second->RemoveObserver(this);
+    return spare.first;
+}
+
+void SpareRendererPoolQt::renderProcessWillLaunch(content::RenderProcessHost *host)
+{
+    Q_UNUSED(host);
+    // Only start keeping spare processes once the profile is actually used for browsing.
+    if (m_launchingSpare || !m_size || content::RenderProcessHost::run_renderer_in_process())
+        return;
+    m_active = true;
+    scheduleFill();
+}
+
+void SpareRendererPoolQt::RenderProcessExited(content::RenderProcessHost *host, base::TerminationStatus status, int exitCode)
+{
+    // A crashed or killed spare is of no use anymore, replace it.
+    if (!removeSpare(host))
+        return;
+    host->Cleanup();
+    if (m_active)
+        scheduleFill();
+}
+
+void SpareRendererPoolQt::RenderProcessHostDestroyed(content::RenderProcessHost *host)
+{
+    removeSpare(host);
+}
+
+void SpareRendererPoolQt::scheduleFill()
+{
+    if (m_fillScheduled)
+        return;
+    m_fillScheduled = true;
+    // Launch processes from the message loop, not while a page is being created.
+    base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(&SpareRendererPoolQt::fill, m_weakPtrFactory.GetWeakPtr()));
+}
+
+void SpareRendererPoolQt::fill()
+{
+    m_fillScheduled = false;
+    if (!m_active)
+        return;
+
+    while (m_spares.size() < static_cast<size_t>(m_size)) {
+        scoped_refptr<content::SiteInstance> siteInstance = content::SiteInstance::Create(m_browserContext);
+        content::RenderProcessHost *host = siteInstance->GetProcess();
+        // Above the process limit an existing process gets shared, which is no spare.
+        if (host->HasConnection())
+            break;
+        m_launchingSpare = true;
+        const bool launched = host->Init();
+        m_launchingSpare = false;
+        if (!launched)
+            break;
+        host->AddObserver(this);
+        m_spares.push_back(std::make_pair(siteInstance, host));
+    }
+
+    m_idleTimer.Start(FROM_HERE, base::TimeDelta::FromMinutes(kSpareRendererIdleTimeoutMinutes),
+                      base::Bind(&SpareRendererPoolQt::releaseIdleSpares, base::Unretained(this)));
+}
+
+void SpareRendererPoolQt::releaseIdleSpares()
+{
+    if (!hasLiveRenderers()) {
+        releaseSpares(0);
+        return;
+    }
+    // Keep one spare warm for the next page and check again later.
+    releaseSpares(1);
+    m_idleTimer.Start(FROM_HERE, base::TimeDelta::FromMinutes(kSpareRendererIdleTimeoutMinutes),
+                      base::Bind(&SpareRendererPoolQt::releaseIdleSpares, base::Unretained(this)));
+}
+
+void SpareRendererPoolQt::releaseSpares(int keep)
+{
+    if (!keep)
+        m_active = false;
+
+    while (m_spares.size() > static_cast<size_t>(keep)) {
+        content::RenderProcessHost *host = m_spares.back().second;
+        host->RemoveObserver(this);
+        m_spares.pop_back();
+        // Nothing else uses the process, so this shuts it down.
+        host->Cleanup();
+    }
+}
+
+// Whether the profile has render processes other than the spares, which means it still has pages.
+bool SpareRendererPoolQt::hasLiveRenderers() const
+{
+    for (content::RenderProcessHost::iterator it = content::RenderProcessHost::AllHostsIterator(); !it.IsAtEnd(); it.Advance()) {
+        content::RenderProcessHost *host = it.GetCurrentValue();
+        if (host->GetBrowserContext() != m_browserContext || !host->HasConnection())
+            continue;
+        if (std::none_of(m_spares.begin(), m_spares.end(),
+                         [host](const Spare &spare) { return spare.second == host; }))
+            return true;
+    }
+    return false;
+}
+
+bool SpareRendererPoolQt::removeSpare(content::RenderProcessHost *host)
+{
+    auto it = std::find_if(m_spares.begin(), m_spares.end(),
+                           [host](const Spare &spare) { return spare.second == host; });
+    if (it == m_spares.end())
+        return false;
+    host->RemoveObserver(this);
+    m_spares.erase(it);
+    return true;
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,109 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SPARE_RENDERER_POOL_QT_H
+#define SPARE_RENDERER_POOL_QT_H
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/timer/timer.h"
+#include "content/public/browser/render_process_host_observer.h"
+
+#include <utility>
+#include <vector>
+
+namespace content {
+class BrowserContext;
+class RenderProcessHost;
+class SiteInstance;
+}
+
+namespace QtWebEngineCore {
+
+// Keeps a number of render processes of one profile launched ahead of time, so that a new
+// page does not have to wait for its renderer to start up before it can navigate.
+// A spare process has already gone through ContentBrowserClientQt::RenderProcessWillLaunch,
+// and has received the user scripts of the profile. Lives on the UI thread.
+class SpareRendererPoolQt : public content::RenderProcessHostObserver {
+public:
+    explicit SpareRendererPoolQt(content::BrowserContext *browserContext);
+    ~SpareRendererPoolQt();
+
+    int size() const { return m_size; }
+    void setSize(int size);
+
+    // Returns a SiteInstance that is not yet assigned to a site and whose render process
+    // is already launched, or null if there is none available.
+    scoped_refptr<content::SiteInstance> takeSpareSiteInstance();
+
+    // Called for every render process of the profile that is about to launch.
+    void renderProcessWillLaunch(content::RenderProcessHost *host);
+
+    // content::RenderProcessHostObserver
+    void RenderProcessExited(content::RenderProcessHost *host, base::TerminationStatus status, int exitCode) override;
+    void RenderProcessHostDestroyed(content::RenderProcessHost *host) override;
+
+private:
+    // The process is kept next to its SiteInstance, which would start a new one when asked
+    // for the process of a spare that is being destroyed.
+    typedef std::pair<scoped_refptr<content::SiteInstance>, content::RenderProcessHost *> Spare;
+
+    void scheduleFill();
+    void fill();
+    void releaseIdleSpares();
+    void releaseSpares(int keep);
+    bool hasLiveRenderers() const;
+    bool removeSpare(content::RenderProcessHost *host);
+
+    content::BrowserContext *m_browserContext;
+    int m_size;
+    bool m_active;
+    bool m_fillScheduled;
+    bool m_launchingSpare;
+    std::vector<Spare> m_spares;
+    base::OneShotTimer m_idleTimer;
+    base::WeakPtrFactory<SpareRendererPoolQt> m_weakPtrFactory;
+
+    DISALLOW_COPY_AND_ASSIGN(SpareRendererPoolQt);
+};
+
+} // namespace QtWebEngineCore
+
+#endif // SPARE_RENDERER_POOL_QT_H
@@ -139,11 +139,21 @@ inline QRectF toQt(const gfx::RectF &rect)
     return QRectF(rect.x(), rect.y(), rect.width(), rect.height());
 }
 
+inline gfx::Rect toGfx(const QRect &rect)
+{
+    return gfx::Rect(rect.x(), rect.y(), rect.width(), rect.height());
+}
+
 inline QSize toQt(const gfx::Size &size)
 {
     return QSize(size.width(), size.height());
 }
 
+inline gfx::Size toGfx(const QSize &size)
+{
+    return gfx::Size(size.width(), size.height());
+}
+
 inline gfx::SizeF toGfx(const QSizeF& size)
 {
   return gfx::SizeF(size.width(), size.height());
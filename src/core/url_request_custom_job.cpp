@@ -45,9 +45,15 @@
 #include "browser_context_adapter.h"
 #include "type_conversion.h"
 
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/net_errors.h"
 #include "net/base/io_buffer.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/http/http_util.h"
 
 #include <QFileInfo>
 #include <QMimeDatabase>
@@ -58,6 +64,11 @@ using namespace net;
 
 namespace QtWebEngineCore {
 
+// Reply devices are read in chunks of this size on the UI thread, with up to
+// kMaxBufferedReplySize bytes read ahead of the network stack.
+static const int kReplyChunkSize = 256 * 1024;
+static const int kMaxBufferedReplySize = 4 * kReplyChunkSize;
+
 URLRequestCustomJob::URLRequestCustomJob(URLRequest *request, NetworkDelegate *networkDelegate,
                                          const std::string &scheme, QWeakPointer<const BrowserContextAdapter> adapter)
     : URLRequestJob(request, networkDelegate)
@@ -133,22 +144,64 @@ bool URLRequestCustomJob::IsRedirectResponse(GURL* location, int* http_status_co
     return false;
 }
 
+void URLRequestCustomJob::SetExtraRequestHeaders(const HttpRequestHeaders &headers)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    std::string rangeHeader;
+    std::vector<HttpByteRange> ranges;
+    if (!headers.GetHeader(HttpRequestHeaders::kRange, &rangeHeader) || !HttpUtil::ParseRangeHeader(rangeHeader, &ranges))
+        return;
+    // Multiple ranges are not supported, the whole resource is sent instead.
+    if (ranges.size() != 1)
+        return;
+    QMutexLocker lock(&m_shared->m_mutex);
+    m_shared->m_requestedRange = ranges.front();
+}
+
+void URLRequestCustomJob::GetResponseInfo(HttpResponseInfo *info)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    if (!m_shared)
+        return;
+    QMutexLocker lock(&m_shared->m_mutex);
+    const HttpByteRange &range = m_shared->m_replyRange;
+    if (!range.IsValid() && m_shared->m_replyTotalSize < 0)
+        return;
+
+    // Replies from random access devices or with a range can be seeked into, tell so like an HTTP server would.
+    std::string rawHeaders;
+    if (range.IsValid()) {
+        const std::string totalSize = m_shared->m_replyTotalSize >= 0
+                ? base::Int64ToString(m_shared->m_replyTotalSize) : std::string("*");
+        rawHeaders = base::StringPrintf("HTTP/1.1 206 Partial Content\n"
+                                        "Content-Range: bytes %lld-%lld/%s\n"
+                                        "Content-Length: %lld\n",
+                                        static_cast<long long>(range.first_byte_position()),
+                                        static_cast<long long>(range.last_byte_position()),
+                                        totalSize.c_str(),
+                                        static_cast<long long>(range.last_byte_position() - range.first_byte_position() + 1));
+    } else {
+        rawHeaders = base::StringPrintf("HTTP/1.1 200 OK\n"
+                                        "Content-Length: %lld\n",
+                                        static_cast<long long>(m_shared->m_replyTotalSize));
+    }
+    rawHeaders += "Accept-Ranges: bytes\n";
+    if (!m_shared->m_mimeType.empty())
+        rawHeaders += "Content-Type: " + m_shared->m_mimeType + "\n";
+    info->headers = new HttpResponseHeaders(HttpUtil::AssembleRawHeaders(rawHeaders.c_str(), rawHeaders.size()));
+}
+
 int URLRequestCustomJob::ReadRawData(IOBuffer *buf, int bufSize)
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
     Q_ASSERT(m_shared);
     QMutexLocker lock(&m_shared->m_mutex);
-    if (m_shared->m_error)
-        return m_shared->m_error;
-    qint64 rv = m_shared->m_device ? m_shared->m_device->read(buf->data(), bufSize) : -1;
-    if (rv >= 0)
-        return static_cast<int>(rv);
-    else {
-        // QIODevice::read might have called fail on us.
-        if (m_shared->m_error)
-            return m_shared->m_error;
-        return ERR_FAILED;
+    int rv = m_shared->readReplyData(buf->data(), bufSize);
+    if (rv == ERR_IO_PENDING) {
+        m_shared->m_pendingReadBuffer = buf;
+        m_shared->m_pendingReadSize = bufSize;
     }
+    return rv;
 }
 
 
@@ -159,6 +212,18 @@ URLRequestCustomJobShared::URLRequestCustomJobShared(URLRequestCustomJob *job)
     , m_error(0)
     , m_started(false)
     , m_asyncInitialized(false)
+    , m_replyStreamed(false)
+    , m_replyFinished(false)
+    , m_replyDataRequested(false)
+    , m_replyDeviceFinished(false)
+    , m_hasReplyDevice(false)
+    , m_replyDataRejected(false)
+    , m_replyChunkOffset(0)
+    , m_bufferedReplySize(0)
+    , m_replyRemaining(-1)
+    , m_replyTotalSize(-1)
+    , m_replyRangeFromHandler(false)
+    , m_pendingReadSize(0)
     , m_weakFactory(this)
 {
 }
@@ -176,14 +241,13 @@ void URLRequestCustomJobShared::killJob()
     m_job = 0;
     bool doDelete = false;
     if (m_delegate) {
+        // The reply device belongs to the UI thread, it is closed there once the delegate is gone.
         m_delegate->deleteLater();
     } else {
         // Do not delete yet if startAsync has not yet run.
         doDelete = m_asyncInitialized;
     }
-    if (m_device && m_device->isOpen())
-        m_device->close();
-    m_device = 0;
+    m_pendingReadBuffer = nullptr;
     m_weakFactory.InvalidateWeakPtrs();
     lock.unlock();
     if (doDelete)
@@ -196,10 +260,12 @@ void URLRequestCustomJobShared::unsetJobDelegate()
     QMutexLocker lock(&m_mutex);
     m_delegate = 0;
     bool doDelete = false;
-    if (m_job)
+    if (m_job) {
         abort();
-    else
+    } else {
+        closeReplyDevice();
         doDelete = true;
+    }
     lock.unlock();
     if (doDelete)
         delete this;
@@ -226,10 +292,28 @@ void URLRequestCustomJobShared::setReplyDevice(QIODevice *device)
     if (!m_job)
         return;
     m_device = device;
+    m_hasReplyDevice = device;
     if (m_device && !m_device->isReadable())
         m_device->open(QIODevice::ReadOnly);
 
     qint64 size = m_device ? m_device->size() : -1;
+    if (m_replyRangeFromHandler) {
+        // The device only holds the range, as told by the scheme handler.
+        size = m_replyRange.last_byte_position() - m_replyRange.first_byte_position() + 1;
+    } else if (m_device && m_device->isReadable() && !m_device->isSequential() && size >= 0) {
+        m_replyTotalSize = size;
+        // Answer range requests natively on random access devices.
+        if (m_requestedRange.IsValid()) {
+            HttpByteRange range = m_requestedRange;
+            if (!range.ComputeBounds(size) || !m_device->seek(range.first_byte_position())) {
+                fail(ERR_REQUEST_RANGE_NOT_SATISFIABLE);
+                return;
+            }
+            m_replyRange = range;
+            size = range.last_byte_position() - range.first_byte_position() + 1;
+            m_replyRemaining = size;
+        }
+    }
     if (size > 0)
         m_job->set_expected_content_size(size);
     if (m_device && m_device->isReadable())
@@ -238,12 +322,202 @@ void URLRequestCustomJobShared::setReplyDevice(QIODevice *device)
         fail(ERR_INVALID_URL);
 }
 
+void URLRequestCustomJobShared::setReplyRange(qint64 firstBytePosition, qint64 lastBytePosition, qint64 totalSize)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    QMutexLocker lock(&m_mutex);
+    if (!m_job || m_device || m_replyStreamed)
+        return;
+    if (firstBytePosition < 0 || lastBytePosition < firstBytePosition || (totalSize >= 0 && totalSize <= lastBytePosition))
+        return;
+    m_replyRange = HttpByteRange::Bounded(firstBytePosition, lastBytePosition);
+    m_replyTotalSize = totalSize;
+    m_replyRangeFromHandler = true;
+}
+
+void URLRequestCustomJobShared::startStreamedReply(qint64 contentLength)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    QMutexLocker lock(&m_mutex);
+    if (!m_job || m_device || m_replyStreamed)
+        return;
+    m_replyStreamed = true;
+    if (m_replyRangeFromHandler)
+        contentLength = m_replyRange.last_byte_position() - m_replyRange.first_byte_position() + 1;
+    if (contentLength >= 0)
+        m_job->set_expected_content_size(contentLength);
+    content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE, base::Bind(&URLRequestCustomJobShared::notifyStarted, m_weakFactory.GetWeakPtr()));
+}
+
+bool URLRequestCustomJobShared::appendReplyData(const QByteArray &data)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    QMutexLocker lock(&m_mutex);
+    if (!m_job || !m_replyStreamed || m_replyFinished)
+        return false;
+    // Like for devices, no more than kMaxBufferedReplySize bytes are buffered ahead of
+    // the network stack. The handler is told to continue once it has caught up.
+    if (m_bufferedReplySize >= kMaxBufferedReplySize) {
+        m_replyDataRejected = true;
+        return false;
+    }
+    if (data.isEmpty())
+        return true;
+    // Implicitly shared, the data is only copied once into the network stack's buffers.
+    m_replyChunks.append(data);
+    m_bufferedReplySize += data.size();
+    content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE, base::Bind(&URLRequestCustomJobShared::notifyReplyDataAvailable, m_weakFactory.GetWeakPtr()));
+    return true;
+}
+
+void URLRequestCustomJobShared::finishReply()
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    QMutexLocker lock(&m_mutex);
+    if (!m_job || !m_replyStreamed || m_replyFinished)
+        return;
+    m_replyFinished = true;
+    content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE, base::Bind(&URLRequestCustomJobShared::notifyReplyDataAvailable, m_weakFactory.GetWeakPtr()));
+}
+
+void URLRequestCustomJobShared::readReplyDevice()
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    QMutexLocker lock(&m_mutex);
+    m_replyDataRequested = false;
+    if (m_replyStreamed) {
+        // The network stack caught up with a streamed reply that was held back.
+        const bool notify = m_job && m_delegate && m_replyDataRejected && !m_replyFinished && !m_error;
+        m_replyDataRejected = false;
+        URLRequestCustomJobDelegate *delegate = m_delegate;
+        lock.unlock();
+        if (notify)
+            Q_EMIT delegate->readyForReplyData();
+        return;
+    }
+    if (!m_job || !m_device || m_replyFinished || m_error)
+        return;
+
+    bool dataAvailable = false;
+    while (m_bufferedReplySize < kMaxBufferedReplySize) {
+        // Stop at the end of the requested range.
+        if (m_replyRemaining == 0) {
+            m_replyFinished = true;
+            dataAvailable = true;
+            break;
+        }
+        const qint64 chunkSize = m_replyRemaining >= 0 ? qMin<qint64>(kReplyChunkSize, m_replyRemaining) : kReplyChunkSize;
+        QByteArray chunk(chunkSize, Qt::Uninitialized);
+        // The device is only used on the UI thread, don't keep the IO thread waiting while it is read.
+        QPointer<QIODevice> device = m_device;
+        lock.unlock();
+        qint64 rv = device->read(chunk.data(), chunk.size());
+        lock.relock();
+        // QIODevice::read might have called fail on us, or the job might be gone.
+        if (!m_job || m_error)
+            return;
+        if (rv < 0) {
+            fail(ERR_FAILED);
+            return;
+        }
+        if (rv == 0) {
+            if (!device || device != m_device || (device->isSequential() ? m_replyDeviceFinished || !device->isOpen() : device->atEnd())) {
+                m_replyFinished = true;
+                dataAvailable = true;
+            } else if (!device->isSequential()) {
+                // Only sequential devices can have more data to come, they signal it with readyRead.
+                fail(ERR_FAILED);
+                return;
+            }
+            break;
+        }
+        chunk.resize(rv);
+        m_replyChunks.append(chunk);
+        m_bufferedReplySize += rv;
+        if (m_replyRemaining > 0)
+            m_replyRemaining -= rv;
+        dataAvailable = true;
+    }
+    if (dataAvailable)
+        content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE, base::Bind(&URLRequestCustomJobShared::notifyReplyDataAvailable, m_weakFactory.GetWeakPtr()));
+}
+
+void URLRequestCustomJobShared::replyDeviceFinished()
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    {
+        QMutexLocker lock(&m_mutex);
+        m_replyDeviceFinished = true;
+    }
+    // Not called with m_mutex locked, readReplyDevice() releases it while reading.
+    readReplyDevice();
+}
+
+void URLRequestCustomJobShared::requestReplyData()
+{
+    // Called with m_mutex locked. Only flags are looked at here, the device itself
+    // is never touched outside of the UI thread.
+    if (!m_delegate || m_replyFinished || m_replyDataRequested)
+        return;
+    if (!m_hasReplyDevice && !m_replyDataRejected)
+        return;
+    if (m_bufferedReplySize >= kMaxBufferedReplySize)
+        return;
+    m_replyDataRequested = true;
+    QMetaObject::invokeMethod(m_delegate, "pullReplyData", Qt::QueuedConnection);
+}
+
+int URLRequestCustomJobShared::readReplyData(char *data, int size)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    QMutexLocker lock(&m_mutex);
+    if (m_error)
+        return m_error;
+
+    int bytesRead = 0;
+    while (bytesRead < size && !m_replyChunks.isEmpty()) {
+        const QByteArray &chunk = m_replyChunks.first();
+        const int count = qMin(size - bytesRead, chunk.size() - m_replyChunkOffset);
+        memcpy(data + bytesRead, chunk.constData() + m_replyChunkOffset, count);
+        bytesRead += count;
+        m_replyChunkOffset += count;
+        if (m_replyChunkOffset == chunk.size()) {
+            m_replyChunks.removeFirst();
+            m_replyChunkOffset = 0;
+        }
+    }
+    m_bufferedReplySize -= bytesRead;
+
+    // Keep reading ahead from the device while the network stack consumes the data.
+    requestReplyData();
+    if (bytesRead > 0)
+        return bytesRead;
+    if (m_replyFinished)
+        return 0;
+    if (!m_hasReplyDevice && !m_replyStreamed)
+        return ERR_FAILED;
+    return ERR_IO_PENDING;
+}
+
+void URLRequestCustomJobShared::notifyReplyDataAvailable()
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    QMutexLocker lock(&m_mutex);
+    if (!m_job || !m_pendingReadBuffer)
+        return;
+    int rv = readReplyData(m_pendingReadBuffer->data(), m_pendingReadSize);
+    if (rv == ERR_IO_PENDING)
+        return;
+    m_pendingReadBuffer = nullptr;
+    m_job->ReadRawDataComplete(rv);
+}
+
 void URLRequestCustomJobShared::redirect(const GURL &url)
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 
     QMutexLocker lock(&m_mutex);
-    if (m_device || m_error)
+    if (m_device || m_replyStreamed || m_error)
         return;
     if (!m_job)
         return;
@@ -251,13 +525,21 @@ void URLRequestCustomJobShared::redirect(const GURL &url)
     content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE, base::Bind(&URLRequestCustomJobShared::notifyStarted, m_weakFactory.GetWeakPtr()));
 }
 
-void URLRequestCustomJobShared::abort()
+void URLRequestCustomJobShared::closeReplyDevice()
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
     QMutexLocker lock(&m_mutex);
     if (m_device && m_device->isOpen())
         m_device->close();
     m_device = 0;
+    m_hasReplyDevice = false;
+}
+
+void URLRequestCustomJobShared::abort()
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    QMutexLocker lock(&m_mutex);
+    closeReplyDevice();
     if (!m_job)
         return;
     content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE, base::Bind(&URLRequestCustomJobShared::notifyCanceled, m_weakFactory.GetWeakPtr()));
@@ -293,6 +575,7 @@ void URLRequestCustomJobShared::fail(int error)
     if (content::BrowserThread::CurrentlyOn(content::BrowserThread::IO))
         return;
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    closeReplyDevice();
     if (!m_job)
         return;
     content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE, base::Bind(&URLRequestCustomJobShared::notifyFailure, m_weakFactory.GetWeakPtr()));
@@ -304,11 +587,19 @@ void URLRequestCustomJobShared::notifyFailure()
     QMutexLocker lock(&m_mutex);
     if (!m_job)
         return;
-    if (m_device)
-        m_device->close();
-    if (!m_started)
+    if (!m_started) {
         m_job->NotifyStartError(URLRequestStatus::FromError(m_error));
-    // else we fail on the next read, or the read that might already be in progress
+    } else if (m_pendingReadBuffer) {
+        m_pendingReadBuffer = nullptr;
+        m_job->ReadRawDataComplete(m_error);
+    }
+    // else we fail on the next read
+}
+
+HttpByteRange URLRequestCustomJobShared::requestedRange()
+{
+    QMutexLocker lock(&m_mutex);
+    return m_requestedRange;
 }
 
 GURL URLRequestCustomJobShared::requestUrl()
@@ -40,10 +40,14 @@
 #ifndef URL_REQUEST_CUSTOM_JOB_H_
 #define URL_REQUEST_CUSTOM_JOB_H_
 
+#include "net/base/io_buffer.h"
+#include "net/http/http_byte_range.h"
 #include "net/url_request/url_request.h"
 #include "net/url_request/url_request_job.h"
 
 #include <QtCore/qglobal.h>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
 #include <QtCore/QMutex>
 #include <QtCore/QPointer>
 
@@ -61,6 +65,8 @@ public:
     URLRequestCustomJob(net::URLRequest *request, net::NetworkDelegate *networkDelegate, const std::string &scheme, QWeakPointer<const BrowserContextAdapter> adapter);
     virtual void Start() Q_DECL_OVERRIDE;
     virtual void Kill() Q_DECL_OVERRIDE;
+    virtual void SetExtraRequestHeaders(const net::HttpRequestHeaders &headers) Q_DECL_OVERRIDE;
+    virtual void GetResponseInfo(net::HttpResponseInfo *info) Q_DECL_OVERRIDE;
     virtual int ReadRawData(net::IOBuffer *buf, int buf_size)  Q_DECL_OVERRIDE;
     virtual bool GetMimeType(std::string *mimeType) const Q_DECL_OVERRIDE;
     virtual bool GetCharset(std::string *charset) Q_DECL_OVERRIDE;
@@ -89,10 +95,18 @@ public:
     void setReplyMimeType(const std::string &);
     void setReplyCharset(const std::string &);
     void setReplyDevice(QIODevice *);
+    void setReplyRange(qint64 firstBytePosition, qint64 lastBytePosition, qint64 totalSize);
+    void startStreamedReply(qint64 contentLength);
+    // Returns false without taking the data while too much of the reply is buffered.
+    bool appendReplyData(const QByteArray &data);
+    void finishReply();
+    void readReplyDevice();
+    void replyDeviceFinished();
 
     void redirect(const GURL &url);
     void fail(int);
     void abort();
+    void closeReplyDevice();
 
     void killJob();
     void unsetJobDelegate();
@@ -101,9 +115,15 @@ public:
     void notifyStarted();
     void notifyFailure();
     void notifyCanceled();
+    void notifyReplyDataAvailable();
+
+    // Returns ERR_IO_PENDING when no data is buffered yet.
+    int readReplyData(char *data, int size);
+    void requestReplyData();
 
     GURL requestUrl();
     std::string requestMethod();
+    net::HttpByteRange requestedRange();
 
     QMutex m_mutex;
     QPointer<QIODevice> m_device;
@@ -115,6 +135,31 @@ public:
     GURL m_redirect;
     bool m_started;
     bool m_asyncInitialized;
+    // The reply data is buffered here, either read ahead from m_device on
+    // the UI thread or handed over by the scheme handler for streamed replies,
+    // until the network stack reads it on the IO thread.
+    bool m_replyStreamed;
+    bool m_replyFinished;
+    bool m_replyDataRequested;
+    bool m_replyDeviceFinished;
+    // Mirrors whether m_device is set, for the IO thread which must not touch the device.
+    bool m_hasReplyDevice;
+    // The scheme handler was told to hold back streamed data, it gets notified once there is room again.
+    bool m_replyDataRejected;
+    QList<QByteArray> m_replyChunks;
+    int m_replyChunkOffset;
+    int m_bufferedReplySize;
+    scoped_refptr<net::IOBuffer> m_pendingReadBuffer;
+    int m_pendingReadSize;
+    net::HttpByteRange m_requestedRange;
+    // Bytes left to read from the device to complete the requested range, -1 without range.
+    qint64 m_replyRemaining;
+    // Size of the whole resource, known for random access devices or given with the reply range.
+    qint64 m_replyTotalSize;
+    // The part of the resource the reply covers, answered with a 206 response when valid.
+    net::HttpByteRange m_replyRange;
+    // The scheme handler passed a range that its reply data is already limited to.
+    bool m_replyRangeFromHandler;
     base::WeakPtrFactory<URLRequestCustomJobShared> m_weakFactory;
 };
 
@@ -44,6 +44,7 @@
 #include "net/base/net_errors.h"
 
 #include <QByteArray>
+#include <QIODevice>
 
 namespace QtWebEngineCore {
 
@@ -67,12 +68,63 @@ QByteArray URLRequestCustomJobDelegate::method() const
     return QByteArray::fromStdString(m_shared->requestMethod());
 }
 
+qint64 URLRequestCustomJobDelegate::rangeStart() const
+{
+    net::HttpByteRange range = m_shared->requestedRange();
+    if (!range.IsValid() || range.IsSuffixByteRange())
+        return -1;
+    return range.first_byte_position();
+}
+
+qint64 URLRequestCustomJobDelegate::rangeEnd() const
+{
+    net::HttpByteRange range = m_shared->requestedRange();
+    if (!range.IsValid() || range.IsSuffixByteRange() || !range.HasLastBytePosition())
+        return -1;
+    return range.last_byte_position();
+}
+
+void URLRequestCustomJobDelegate::setReplyRange(qint64 start, qint64 end, qint64 totalSize)
+{
+    m_shared->setReplyRange(start, end, totalSize);
+}
+
 void URLRequestCustomJobDelegate::setReply(const QByteArray &contentType, QIODevice *device)
 {
     m_shared->setReplyMimeType(contentType.toStdString());
+    if (device) {
+        connect(device, &QIODevice::readyRead, this, &URLRequestCustomJobDelegate::pullReplyData);
+        connect(device, &QIODevice::readChannelFinished, this, &URLRequestCustomJobDelegate::replyDeviceFinished);
+    }
     m_shared->setReplyDevice(device);
 }
 
+void URLRequestCustomJobDelegate::beginReply(const QByteArray &contentType, qint64 contentLength)
+{
+    m_shared->setReplyMimeType(contentType.toStdString());
+    m_shared->startStreamedReply(contentLength);
+}
+
+bool URLRequestCustomJobDelegate::appendReplyData(const QByteArray &data)
+{
+    return m_shared->appendReplyData(data);
+}
+
+void URLRequestCustomJobDelegate::finishReply()
+{
+    m_shared->finishReply();
+}
+
+void URLRequestCustomJobDelegate::pullReplyData()
+{
+    m_shared->readReplyDevice();
+}
+
+void URLRequestCustomJobDelegate::replyDeviceFinished()
+{
+    m_shared->replyDeviceFinished();
+}
+
 void URLRequestCustomJobDelegate::abort()
 {
     m_shared->abort();
@@ -67,13 +67,26 @@ public:
 
     QUrl url() const;
     QByteArray method() const;
+    qint64 rangeStart() const;
+    qint64 rangeEnd() const;
 
+    void setReplyRange(qint64 start, qint64 end, qint64 totalSize);
     void setReply(const QByteArray &contentType, QIODevice *device);
+    void beginReply(const QByteArray &contentType, qint64 contentLength);
+    bool appendReplyData(const QByteArray &data);
+    void finishReply();
     void redirect(const QUrl& url);
     void abort();
 
     void fail(Error);
 
+Q_SIGNALS:
+    void readyForReplyData();
+
+private Q_SLOTS:
+    void pullReplyData();
+    void replyDeviceFinished();
+
 private:
     URLRequestCustomJobDelegate(URLRequestCustomJobShared *shared);
 
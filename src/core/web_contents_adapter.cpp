@@ -49,12 +49,14 @@
 #include "browser_context_adapter_client.h"
 #include "browser_context_qt.h"
 #include "download_manager_delegate_qt.h"
+#include "frame_timing_recorder.h"
 #include "media_capture_devices_dispatcher.h"
 #include "pdfium_document_wrapper_qt.h"
 #include "print_view_manager_qt.h"
 #include "qwebenginecallback_p.h"
 #include "renderer_host/web_channel_ipc_transport_host.h"
 #include "render_view_observer_host_qt.h"
+#include "spare_renderer_pool_qt.h"
 #include "type_conversion.h"
 #include "web_contents_adapter_client.h"
 #include "web_contents_view_qt.h"
@@ -62,6 +64,7 @@
 #include "web_engine_settings.h"
 
 #include <base/run_loop.h>
+#include "base/process/process_handle.h"
 #include "base/values.h"
 #include "content/browser/renderer_host/render_view_host_impl.h"
 #include "content/browser/web_contents/web_contents_impl.h"
@@ -70,7 +73,11 @@
 #include <content/public/browser/download_manager.h>
 #include "content/public/browser/host_zoom_map.h"
 #include "content/public/browser/navigation_entry.h"
+#include "content/public/browser/render_process_host.h"
 #include "content/public/browser/render_view_host.h"
+#include "content/public/browser/render_widget_host.h"
+#include "content/public/browser/render_widget_host_view.h"
+#include "content/public/browser/site_instance.h"
 #include "content/public/browser/favicon_status.h"
 #include "content/public/common/content_constants.h"
 #include <content/public/common/drop_data.h>
@@ -188,10 +195,10 @@ static void callbackOnEvaluateJS(WebContentsAdapterClient *adapterClient, quint6
 #if BUILDFLAG(ENABLE_BASIC_PRINTING)
 static void callbackOnPrintingFinished(WebContentsAdapterClient *adapterClient,
                                        int requestId,
-                                       const std::vector<char>& result)
+                                       const QByteArray &result)
 {
     if (requestId)
-        adapterClient->didPrintPage(requestId, QByteArray(result.data(), result.size()));
+        adapterClient->didPrintPage(requestId, result);
 }
 
 static void callbackOnPdfSavingFinished(WebContentsAdapterClient *adapterClient,
@@ -200,11 +207,26 @@ static void callbackOnPdfSavingFinished(WebContentsAdapterClient *adapterClient,
 {
     adapterClient->didPrintPageToPdf(filePath, success);
 }
+
+static void callbackOnPdfPagePrinted(WebContentsAdapterClient *adapterClient, const QString &filePath,
+                                     int pageIndex, int pageCount, const QByteArray &pageData)
+{
+    adapterClient->didPrintPdfPage(filePath, pageIndex, pageCount, pageData);
+}
 #endif
 
-static content::WebContents *createBlankWebContents(WebContentsAdapterClient *adapterClient, content::BrowserContext *browserContext)
+static void callbackOnGrabFinished(WebContentsAdapterClient *adapterClient, quint64 requestId,
+                                   const SkBitmap &bitmap, content::ReadbackResponse response)
+{
+    // toQImage() doesn't copy the pixels, the bitmap only lives for this call.
+    adapterClient->didGrabContents(requestId, response == content::READBACK_SUCCESS ? toQImage(bitmap).copy() : QImage());
+}
+
+static content::WebContents *createBlankWebContents(WebContentsAdapterClient *adapterClient, BrowserContextAdapter *browserContextAdapter)
 {
-    content::WebContents::CreateParams create_params(browserContext, NULL);
+    // Start with a renderer that has already been launched if the profile keeps some around.
+    scoped_refptr<content::SiteInstance> siteInstance = browserContextAdapter->spareRendererPool()->takeSpareSiteInstance();
+    content::WebContents::CreateParams create_params(browserContextAdapter->browserContext(), siteInstance.get());
     create_params.routing_id = MSG_ROUTING_NONE;
     create_params.initial_size = gfx::Size(kTestWindowWidth, kTestWindowHeight);
     create_params.context = reinterpret_cast<gfx::NativeView>(adapterClient);
@@ -347,6 +369,8 @@ WebContentsAdapterPrivate::WebContentsAdapterPrivate()
     , adapterClient(0)
     , nextRequestId(CallbackDirectory::ReservedCallbackIdsEnd)
     , lastFindRequestId(0)
+    , frameCaptureRate(0)
+    , frameTimingEnabled(false)
     , currentDropAction(blink::WebDragOperationNone)
 {
 }
@@ -367,7 +391,7 @@ QSharedPointer<WebContentsAdapter> WebContentsAdapter::createFromSerializedNavig
         return QSharedPointer<WebContentsAdapter>();
 
     // Unlike WebCore, Chromium only supports Restoring to a new WebContents instance.
-    content::WebContents* newWebContents = createBlankWebContents(adapterClient, adapterClient->browserContextAdapter()->browserContext());
+    content::WebContents* newWebContents = createBlankWebContents(adapterClient, adapterClient->browserContextAdapter().data());
     content::NavigationController &controller = newWebContents->GetController();
     controller.Restore(currentIndex, content::RestoreType::LAST_SESSION_EXITED_CLEANLY, &entries);
 
@@ -406,7 +430,7 @@ void WebContentsAdapter::initialize(WebContentsAdapterClient *adapterClient)
 
     // Create our own if a WebContents wasn't provided at construction.
     if (!d->webContents)
-        d->webContents.reset(createBlankWebContents(adapterClient, d->browserContextAdapter->browserContext()));
+        d->webContents.reset(createBlankWebContents(adapterClient, d->browserContextAdapter.data()));
 
     // This might replace any adapter that has been initialized with this WebEngineSettings.
     adapterClient->webEngineSettings()->setWebContentsAdapter(this);
@@ -854,6 +878,20 @@ quint64 WebContentsAdapter::runJavaScriptCallbackResult(const QString &javaScrip
     return d->nextRequestId++;
 }
 
+quint64 WebContentsAdapter::runJavaScriptAsJson(const QString &javaScript, quint32 worldId)
+{
+    Q_D(WebContentsAdapter);
+    d->renderViewObserverHost->executeJavaScript(d->nextRequestId, javaScript, worldId);
+    return d->nextRequestId++;
+}
+
+quint64 WebContentsAdapter::runJavaScriptBatch(const QStringList &scripts, quint32 worldId, const QString &frameName)
+{
+    Q_D(WebContentsAdapter);
+    d->renderViewObserverHost->executeJavaScriptBatch(d->nextRequestId, scripts, worldId, frameName);
+    return d->nextRequestId++;
+}
+
 quint64 WebContentsAdapter::fetchDocumentMarkup()
 {
     Q_D(WebContentsAdapter);
@@ -868,6 +906,20 @@ quint64 WebContentsAdapter::fetchDocumentInnerText()
     return d->nextRequestId++;
 }
 
+quint64 WebContentsAdapter::streamDocumentMarkup(quint64 maxLength)
+{
+    Q_D(WebContentsAdapter);
+    d->renderViewObserverHost->streamDocumentMarkup(d->nextRequestId, maxLength);
+    return d->nextRequestId++;
+}
+
+quint64 WebContentsAdapter::streamDocumentInnerText(quint64 maxLength)
+{
+    Q_D(WebContentsAdapter);
+    d->renderViewObserverHost->streamDocumentInnerText(d->nextRequestId, maxLength);
+    return d->nextRequestId++;
+}
+
 quint64 WebContentsAdapter::findText(const QString &subString, bool caseSensitively, bool findBackward)
 {
     Q_D(WebContentsAdapter);
@@ -908,6 +960,11 @@ void WebContentsAdapter::updateWebPreferences(const content::WebPreferences & we
 {
     Q_D(WebContentsAdapter);
     d->webContents->GetRenderViewHost()->UpdateWebkitPreferences(webPreferences);
+    if (d->webChannelTransport) {
+        d->webChannelTransport->setMessageBatching(d->adapterClient->webEngineSettings()->testAttribute(WebEngineSettings::WebChannelMessageBatching),
+                                                   d->adapterClient->webEngineSettings()->webChannelBatchInterval());
+        d->webChannelTransport->setObjectMessages(d->adapterClient->webEngineSettings()->testAttribute(WebEngineSettings::WebChannelObjectMessages));
+    }
 }
 
 void WebContentsAdapter::download(const QUrl &url, const QString &suggestedFileName)
@@ -1006,39 +1063,137 @@ void WebContentsAdapter::wasHidden()
     d->webContents->WasHidden();
 }
 
-void WebContentsAdapter::printToPDF(const QPageLayout &pageLayout, const QString &filePath)
+void WebContentsAdapter::printToPDF(const QPageLayout &pageLayout, const QString &filePath, bool reportPages)
 {
 #if BUILDFLAG(ENABLE_BASIC_PRINTING)
     Q_D(WebContentsAdapter);
     PrintViewManagerQt::PrintToPDFFileCallback callback = base::Bind(&callbackOnPdfSavingFinished,
                                                                 d->adapterClient,
                                                                 filePath);
+    PrintViewManagerQt::PrintToPDFPageCallback pageCallback;
+    if (reportPages)
+        pageCallback = base::Bind(&callbackOnPdfPagePrinted, d->adapterClient, filePath);
     PrintViewManagerQt::FromWebContents(webContents())->PrintToPDFFileWithCallback(pageLayout,
                                                                                    true,
                                                                                    filePath,
-                                                                                   callback);
+                                                                                   callback,
+                                                                                   pageCallback);
+#else
+    Q_UNUSED(pageLayout);
+    Q_UNUSED(filePath);
+    Q_UNUSED(reportPages);
 #endif // if BUILDFLAG(ENABLE_BASIC_PRINTING)
 }
 
 quint64 WebContentsAdapter::printToPDFCallbackResult(const QPageLayout &pageLayout,
-                                                     const bool colorMode)
+                                                     const bool colorMode,
+                                                     bool reportPages)
 {
 #if BUILDFLAG(ENABLE_BASIC_PRINTING)
     Q_D(WebContentsAdapter);
     PrintViewManagerQt::PrintToPDFCallback callback = base::Bind(&callbackOnPrintingFinished,
                                                                  d->adapterClient,
                                                                  d->nextRequestId);
+    PrintViewManagerQt::PrintToPDFPageCallback pageCallback;
+    if (reportPages)
+        pageCallback = base::Bind(&callbackOnPdfPagePrinted, d->adapterClient, QString());
     PrintViewManagerQt::FromWebContents(webContents())->PrintToPDFWithCallback(pageLayout,
                                                                                colorMode,
-                                                                               callback);
+                                                                               callback,
+                                                                               pageCallback);
     return d->nextRequestId++;
 #else
     Q_UNUSED(pageLayout);
     Q_UNUSED(colorMode);
+    Q_UNUSED(reportPages);
     return 0;
 #endif // if BUILDFLAG(ENABLE_BASIC_PRINTING)
 }
 
+void WebContentsAdapter::cancelPrintToPDF()
+{
+#if BUILDFLAG(ENABLE_BASIC_PRINTING)
+    PrintViewManagerQt::FromWebContents(webContents())->CancelPDFJobs();
+#endif // if BUILDFLAG(ENABLE_BASIC_PRINTING)
+}
+
+quint64 WebContentsAdapter::grabContents(const QRect &sourceRect, const QSize &targetSize)
+{
+    Q_D(WebContentsAdapter);
+    content::RenderWidgetHostView *rwhv = d->webContents->GetRenderWidgetHostView();
+    if (!rwhv)
+        return 0;
+    rwhv->GetRenderWidgetHost()->CopyFromBackingStore(toGfx(sourceRect), toGfx(targetSize),
+                                                      base::Bind(&callbackOnGrabFinished, d->adapterClient, d->nextRequestId),
+                                                      kN32_SkColorType);
+    return d->nextRequestId++;
+}
+
+void WebContentsAdapter::setFrameCaptureRate(int framesPerSecond)
+{
+    Q_D(WebContentsAdapter);
+    d->frameCaptureRate = qMax(0, framesPerSecond);
+    if (RenderWidgetHostViewQt *rwhv = static_cast<RenderWidgetHostViewQt *>(d->webContents->GetRenderWidgetHostView()))
+        rwhv->frameCaptureRateChanged();
+}
+
+int WebContentsAdapter::frameCaptureRate() const
+{
+    Q_D(const WebContentsAdapter);
+    return d->frameCaptureRate;
+}
+
+void WebContentsAdapter::setFrameTimingEnabled(bool enabled)
+{
+    Q_D(WebContentsAdapter);
+    if (d->frameTimingEnabled == enabled)
+        return;
+    d->frameTimingEnabled = enabled;
+    // Start over with an empty recording, the views pick it up with their next frame.
+    if (enabled)
+        d->frameTimingRecorder = QSharedPointer<FrameTimingRecorder>(new FrameTimingRecorder);
+}
+
+bool WebContentsAdapter::isFrameTimingEnabled() const
+{
+    Q_D(const WebContentsAdapter);
+    return d->frameTimingEnabled;
+}
+
+QByteArray WebContentsAdapter::frameTimingTrace() const
+{
+    Q_D(const WebContentsAdapter);
+    if (!d->frameTimingRecorder)
+        return QByteArray();
+    return d->frameTimingRecorder->toTraceEventJson();
+}
+
+QVariantList WebContentsAdapter::frameTimings() const
+{
+    Q_D(const WebContentsAdapter);
+    if (!d->frameTimingRecorder)
+        return QVariantList();
+    return d->frameTimingRecorder->toVariantList();
+}
+
+qint64 WebContentsAdapter::renderProcessPid() const
+{
+    Q_D(const WebContentsAdapter);
+    // The handle stays null until the process has finished launching.
+    const base::ProcessHandle handle = d->webContents->GetRenderProcessHost()->GetHandle();
+    if (handle == base::kNullProcessHandle)
+        return 0;
+    return base::GetProcId(handle);
+}
+
+QSharedPointer<FrameTimingRecorder> WebContentsAdapter::frameTimingRecorder() const
+{
+    Q_D(const WebContentsAdapter);
+    if (!d->frameTimingEnabled)
+        return QSharedPointer<FrameTimingRecorder>();
+    return d->frameTimingRecorder;
+}
+
 QPointF WebContentsAdapter::lastScrollOffset() const
 {
     Q_D(const WebContentsAdapter);
@@ -1121,9 +1276,12 @@ void WebContentsAdapter::setWebChannel(QWebChannel *channel, uint worldId)
     if (d->webChannel == channel && d->webChannelWorld == worldId)
         return;
 
-    if (!d->webChannelTransport.get())
+    if (!d->webChannelTransport.get()) {
         d->webChannelTransport.reset(new WebChannelIPCTransportHost(d->webContents.get(), worldId));
-    else {
+        d->webChannelTransport->setMessageBatching(d->adapterClient->webEngineSettings()->testAttribute(WebEngineSettings::WebChannelMessageBatching),
+                                                   d->adapterClient->webEngineSettings()->webChannelBatchInterval());
+        d->webChannelTransport->setObjectMessages(d->adapterClient->webEngineSettings()->testAttribute(WebEngineSettings::WebChannelObjectMessages));
+    } else {
         if (d->webChannel != channel)
             d->webChannel->disconnectFrom(d->webChannelTransport.get());
         if (d->webChannelWorld != worldId)
@@ -48,6 +48,7 @@
 #include <QSharedPointer>
 #include <QString>
 #include <QUrl>
+#include <QVariant>
 
 namespace content {
 class WebContents;
@@ -60,12 +61,14 @@ class QDragEnterEvent;
 class QDragMoveEvent;
 class QPageLayout;
 class QString;
+class QStringList;
 class QWebChannel;
 QT_END_NAMESPACE
 
 namespace QtWebEngineCore {
 
 class BrowserContextQt;
+class FrameTimingRecorder;
 class MessagePassingInterface;
 class WebContentsAdapterPrivate;
 class FaviconManager;
@@ -118,8 +121,12 @@ public:
     qreal currentZoomFactor() const;
     void runJavaScript(const QString &javaScript, quint32 worldId);
     quint64 runJavaScriptCallbackResult(const QString &javaScript, quint32 worldId);
+    quint64 runJavaScriptAsJson(const QString &javaScript, quint32 worldId);
+    quint64 runJavaScriptBatch(const QStringList &scripts, quint32 worldId, const QString &frameName);
     quint64 fetchDocumentMarkup();
     quint64 fetchDocumentInnerText();
+    quint64 streamDocumentMarkup(quint64 maxLength);
+    quint64 streamDocumentInnerText(quint64 maxLength);
     quint64 findText(const QString &subString, bool caseSensitively, bool findBackward);
     void stopFinding();
     void updateWebPreferences(const content::WebPreferences &webPreferences);
@@ -171,11 +178,21 @@ public:
     void updateDragAction(int action);
     void endDragging(const QPoint &clientPos, const QPoint &screenPos);
     void leaveDrag();
-    void printToPDF(const QPageLayout&, const QString&);
-    quint64 printToPDFCallbackResult(const QPageLayout &, const bool colorMode = true);
+    void printToPDF(const QPageLayout&, const QString&, bool reportPages = false);
+    quint64 printToPDFCallbackResult(const QPageLayout &, const bool colorMode = true, bool reportPages = false);
+    void cancelPrintToPDF();
+    quint64 grabContents(const QRect &sourceRect, const QSize &targetSize);
+    void setFrameCaptureRate(int framesPerSecond);
+    int frameCaptureRate() const;
+    void setFrameTimingEnabled(bool enabled);
+    bool isFrameTimingEnabled() const;
+    QByteArray frameTimingTrace() const;
+    QVariantList frameTimings() const;
+    qint64 renderProcessPid() const;
 
     // meant to be used within WebEngineCore only
     content::WebContents *webContents() const;
+    QSharedPointer<FrameTimingRecorder> frameTimingRecorder() const;
     void replaceMisspelling(const QString &word);
 
     void viewSource();
@@ -49,6 +49,8 @@
 #include <QStringList>
 #include <QUrl>
 
+QT_FORWARD_DECLARE_CLASS(QImage)
+QT_FORWARD_DECLARE_CLASS(QJsonValue)
 QT_FORWARD_DECLARE_CLASS(QKeyEvent)
 QT_FORWARD_DECLARE_CLASS(QVariant)
 QT_FORWARD_DECLARE_CLASS(CertificateErrorController)
@@ -342,11 +344,16 @@ public:
     virtual void runFileChooser(QSharedPointer<FilePickerController>) = 0;
     virtual void showColorDialog(QSharedPointer<ColorChooserController>) = 0;
     virtual void didRunJavaScript(quint64 requestId, const QVariant& result) = 0;
+    virtual void didRunJavaScriptAsJson(quint64 requestId, const QJsonValue &result) = 0;
     virtual void didFetchDocumentMarkup(quint64 requestId, const QString& result) = 0;
     virtual void didFetchDocumentInnerText(quint64 requestId, const QString& result) = 0;
+    virtual void didFetchDocumentChunk(quint64 requestId, const QString &chunk, bool last) = 0;
     virtual void didFindText(quint64 requestId, int matchCount) = 0;
     virtual void didPrintPage(quint64 requestId, const QByteArray &result) = 0;
     virtual void didPrintPageToPdf(const QString &filePath, bool success) = 0;
+    virtual void didPrintPdfPage(const QString &filePath, int pageIndex, int pageCount, const QByteArray &pageData) = 0;
+    virtual void didGrabContents(quint64 requestId, const QImage &result) = 0;
+    virtual void didCaptureFrame(const QImage &frame) = 0;
     virtual void passOnFocus(bool reverse) = 0;
     // returns the last QObject (QWidget/QQuickItem) based object in the accessibility
     // hierarchy before going into the BrowserAccessibility tree
@@ -93,6 +93,10 @@ public:
     WebContentsAdapterClient *adapterClient;
     quint64 nextRequestId;
     int lastFindRequestId;
+    int frameCaptureRate;
+    bool frameTimingEnabled;
+    // Kept after disabling frame timing for the recorded frames to stay readable.
+    QSharedPointer<FrameTimingRecorder> frameTimingRecorder;
     std::unique_ptr<content::DropData> currentDropData;
     blink::WebDragOperation currentDropAction;
     bool updateDragActionCalled;
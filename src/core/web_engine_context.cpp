@@ -59,6 +59,7 @@
 #include "content/public/app/content_main.h"
 #include "content/public/app/content_main_runner.h"
 #include "content/public/browser/browser_main_runner.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/plugin_service.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/common/content_paths.h"
@@ -87,6 +88,7 @@
 #include "web_engine_library_info.h"
 #include <QFileInfo>
 #include <QGuiApplication>
+#include <QLoggingCategory>
 #include <QOffscreenSurface>
 #ifndef QT_NO_OPENGL
 # include <QOpenGLContext>
@@ -185,6 +187,8 @@ void WebEngineContext::destroyBrowserContext()
 
 void WebEngineContext::destroy()
 {
+    // Don't let flushing the message loop below start anything we deferred.
+    m_deferredInitializationPending = false;
     if (m_devtoolsServer)
         m_devtoolsServer->stop();
     delete m_globalQObject;
@@ -246,13 +250,56 @@ QObject *WebEngineContext::globalQObject()
 
 const static char kChromiumFlagsEnv[] = "QTWEBENGINE_CHROMIUM_FLAGS";
 const static char kDisableSandboxEnv[] = "QTWEBENGINE_DISABLE_SANDBOX";
+const static char kDeferredStartupEnv[] = "QTWEBENGINE_DEFERRED_STARTUP";
+
+Q_LOGGING_CATEGORY(lcWebEngineStartup, "qt.webengine.startup")
+
+void WebEngineContext::recordStartupPhase(const char *name, base::TimeTicks *phaseStart)
+{
+    if (!m_reportStartupTiming)
+        return;
+    const base::TimeTicks now = base::TimeTicks::Now();
+    m_startupPhases.push_back(std::make_pair(name, now - *phaseStart));
+    *phaseStart = now;
+}
+
+void WebEngineContext::reportStartupPhases(const char *stage)
+{
+    if (!m_reportStartupTiming)
+        return;
+    QString report;
+    base::TimeDelta total;
+    for (const auto &phase : m_startupPhases) {
+        report += QStringLiteral("\n    %1: %2 ms").arg(QLatin1String(phase.first)).arg(phase.second.InMillisecondsF(), 0, 'f', 2);
+        total += phase.second;
+    }
+    qCDebug(lcWebEngineStartup, "%s startup: %.2f ms%s", stage, total.InMillisecondsF(), qPrintable(report));
+    m_startupPhases.clear();
+}
+
+// Runs the initialization of the subsystems that are not needed to show the first page
+// from the message loop, after the rest of the startup has completed.
+void WebEngineContext::initializeDeferredSubsystems()
+{
+    if (!m_deferredInitializationPending)
+        return;
+    m_deferredInitializationPending = false;
+
+    base::TimeTicks phaseStart = base::TimeTicks::Now();
+    m_devtoolsServer->start();
+    recordStartupPhase("devtools server", &phaseStart);
+    reportStartupPhases("deferred");
+}
 
 WebEngineContext::WebEngineContext()
     : m_mainDelegate(new ContentMainDelegateQt)
     , m_contentRunner(content::ContentMainRunner::Create())
     , m_browserRunner(content::BrowserMainRunner::Create())
     , m_globalQObject(new QObject())
+    , m_deferredInitializationPending(qEnvironmentVariableIsSet(kDeferredStartupEnv))
+    , m_reportStartupTiming(lcWebEngineStartup().isDebugEnabled())
 {
+    base::TimeTicks phaseStart = base::TimeTicks::Now();
 #if defined(USE_X11)
     QString platform = qApp->platformName();
     if (platform != QLatin1String("xcb")) {
@@ -333,6 +380,7 @@ WebEngineContext::WebEngineContext()
         parsedCommandLine->AppendSwitch(cc::switches::kDisableCompositedAntialiasing);
         parsedCommandLine->AppendSwitchASCII(switches::kProfilerTiming, switches::kProfilerTimingDisabledValue);
     }
+    recordStartupPhase("command line", &phaseStart);
 
     GLContextHelper::initialize();
 
@@ -389,6 +437,7 @@ WebEngineContext::WebEngineContext()
         parsedCommandLine->AppendSwitchASCII(switches::kUseGL, glType);
     else
         parsedCommandLine->AppendSwitch(switches::kDisableGpu);
+    recordStartupPhase("GL detection", &phaseStart);
 
     content::UtilityProcessHostImpl::RegisterUtilityMainThreadFactory(content::CreateInProcessUtilityThread);
     content::RenderProcessHostImpl::RegisterRendererMainThreadFactory(content::CreateInProcessRendererThread);
@@ -402,14 +451,15 @@ WebEngineContext::WebEngineContext()
     contentMainParams.sandbox_info = &sandbox_info;
 #endif
     m_contentRunner->Initialize(contentMainParams);
+    recordStartupPhase("content main runner", &phaseStart);
     m_browserRunner->Initialize(content::MainFunctionParams(*base::CommandLine::ForCurrentProcess()));
+    recordStartupPhase("browser main runner", &phaseStart);
 
     // Once the MessageLoop has been created, attach a top-level RunLoop.
     m_runLoop.reset(new base::RunLoop);
     m_runLoop->BeforeRun();
 
     m_devtoolsServer.reset(new DevToolsServerQt());
-    m_devtoolsServer->start();
     // Force the initialization of MediaCaptureDevicesDispatcher on the UI
     // thread to avoid a thread check assertion in its constructor when it
     // first gets referenced on the IO thread.
@@ -425,17 +475,37 @@ WebEngineContext::WebEngineContext()
     // can't loads plugins synchronously from the IO thread to serve the render process' request
     // and we need to make sure that it happened beforehand.
     content::PluginService::GetInstance()->GetPlugins(base::Bind(&dummyGetPluginCallback));
+    recordStartupPhase("plugin list", &phaseStart);
 #endif
 
-#if BUILDFLAG(ENABLE_BASIC_PRINTING)
-    m_printJobManager.reset(new printing::PrintJobManager());
-#endif // defined(ENABLE_BASIC_PRINTING)
+    // With deferred startup the DevTools server is started from the message loop,
+    // once the first page has been requested.
+    if (m_deferredInitializationPending) {
+        content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
+                                         base::Bind(&WebEngineContext::initializeDeferredSubsystems, this));
+    } else {
+        m_devtoolsServer->start();
+        recordStartupPhase("devtools server", &phaseStart);
+    }
+    reportStartupPhases("initial");
 }
 
 #if BUILDFLAG(ENABLE_BASIC_PRINTING)
 printing::PrintJobManager* WebEngineContext::getPrintJobManager()
 {
+    // Created when the first print job starts, most applications never print.
+    if (!m_printJobManager)
+        m_printJobManager.reset(new printing::PrintJobManager());
     return m_printJobManager.get();
 }
+
+scoped_refptr<printing::PrintQueriesQueue> WebEngineContext::getPrintQueriesQueue()
+{
+    // Every render process filter and print view manager holds on to the queue,
+    // so keep it separate from the PrintJobManager to not create that for them.
+    if (!m_printQueriesQueue)
+        m_printQueriesQueue = new printing::PrintQueriesQueue();
+    return m_printQueriesQueue;
+}
 #endif // defined(ENABLE_BASIC_PRINTING)
 } // namespace
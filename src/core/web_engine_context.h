@@ -45,11 +45,15 @@
 #include "build/build_config.h"
 
 #include "base/memory/ref_counted.h"
+#include "base/time/time.h"
 #include "base/values.h"
 #include "printing/features/features.h"
 
 #include <QSharedPointer>
 
+#include <utility>
+#include <vector>
+
 namespace base {
 class RunLoop;
 }
@@ -62,6 +66,7 @@ class ContentMainRunner;
 #if BUILDFLAG(ENABLE_BASIC_PRINTING)
 namespace printing {
 class PrintJobManager;
+class PrintQueriesQueue;
 }
 #endif // BUILDFLAG(ENABLE_BASIC_PRINTING)
 
@@ -82,6 +87,7 @@ public:
     QObject *globalQObject();
 #if BUILDFLAG(ENABLE_BASIC_PRINTING)
     printing::PrintJobManager* getPrintJobManager();
+    scoped_refptr<printing::PrintQueriesQueue> getPrintQueriesQueue();
 #endif // BUILDFLAG(ENABLE_BASIC_PRINTING)
     void destroyBrowserContext();
     void destroy();
@@ -91,6 +97,10 @@ private:
     WebEngineContext();
     ~WebEngineContext();
 
+    void initializeDeferredSubsystems();
+    void recordStartupPhase(const char *name, base::TimeTicks *phaseStart);
+    void reportStartupPhases(const char *stage);
+
     std::unique_ptr<base::RunLoop> m_runLoop;
     std::unique_ptr<ContentMainDelegateQt> m_mainDelegate;
     std::unique_ptr<content::ContentMainRunner> m_contentRunner;
@@ -100,7 +110,11 @@ private:
     std::unique_ptr<DevToolsServerQt> m_devtoolsServer;
 #if BUILDFLAG(ENABLE_BASIC_PRINTING)
     std::unique_ptr<printing::PrintJobManager> m_printJobManager;
+    scoped_refptr<printing::PrintQueriesQueue> m_printQueriesQueue;
 #endif // BUILDFLAG(ENABLE_BASIC_PRINTING)
+    bool m_deferredInitializationPending;
+    bool m_reportStartupTiming;
+    std::vector<std::pair<const char *, base::TimeDelta>> m_startupPhases;
 };
 
 } // namespace
@@ -100,6 +100,7 @@ static inline bool isTouchScreenAvailable() {
 
 WebEngineSettings::WebEngineSettings(WebEngineSettings *_parentSettings)
     : m_adapter(0)
+    , m_webChannelBatchInterval(-1)
     , m_batchTimer(new BatchTimer(this))
     , parentSettings(_parentSettings)
 {
@@ -204,6 +205,19 @@ QString WebEngineSettings::defaultTextEncoding() const
     return m_defaultEncoding.isEmpty()? parentSettings->defaultTextEncoding() : m_defaultEncoding;
 }
 
+void WebEngineSettings::setWebChannelBatchInterval(int msecs)
+{
+    m_webChannelBatchInterval = qMax(0, msecs);
+    scheduleApplyRecursively();
+}
+
+int WebEngineSettings::webChannelBatchInterval() const
+{
+    if (!parentSettings)
+        return m_webChannelBatchInterval;
+    return m_webChannelBatchInterval < 0 ? parentSettings->webChannelBatchInterval() : m_webChannelBatchInterval;
+}
+
 void WebEngineSettings::initDefaults(bool offTheRecord)
 {
     if (s_defaultAttributes.isEmpty()) {
@@ -243,6 +257,9 @@ void WebEngineSettings::initDefaults(bool offTheRecord)
         s_defaultAttributes.insert(PrintElementBackgrounds, true);
         s_defaultAttributes.insert(AllowRunningInsecureContent, allowRunningInsecureContent);
         s_defaultAttributes.insert(AllowGeolocationOnInsecureOrigins, false);
+        s_defaultAttributes.insert(WebChannelMessageBatching, false);
+        s_defaultAttributes.insert(PipelinedTextureFetchEnabled, false);
+        s_defaultAttributes.insert(WebChannelObjectMessages, false);
     }
     if (offTheRecord)
         m_attributes.insert(LocalStorageEnabled, false);
@@ -276,6 +293,7 @@ void WebEngineSettings::initDefaults(bool offTheRecord)
     }
 
     m_defaultEncoding = QStringLiteral("ISO-8859-1");
+    m_webChannelBatchInterval = 0;
 }
 
 void WebEngineSettings::scheduleApply()
@@ -83,7 +83,10 @@ public:
         FocusOnNavigationEnabled,
         PrintElementBackgrounds,
         AllowRunningInsecureContent,
-        AllowGeolocationOnInsecureOrigins
+        AllowGeolocationOnInsecureOrigins,
+        WebChannelMessageBatching,
+        PipelinedTextureFetchEnabled,
+        WebChannelObjectMessages
     };
 
     // Must match the values from the public API in qwebenginesettings.h.
@@ -127,6 +130,9 @@ public:
     void setDefaultTextEncoding(const QString &encoding);
     QString defaultTextEncoding() const;
 
+    void setWebChannelBatchInterval(int msecs);
+    int webChannelBatchInterval() const;
+
     void initDefaults(bool offTheRecord = false);
     void scheduleApply();
 
@@ -142,6 +148,7 @@ private:
     QHash<FontFamily, QString> m_fontFamilies;
     QHash<FontSize, int> m_fontSizes;
     QString m_defaultEncoding;
+    int m_webChannelBatchInterval;
     QScopedPointer<content::WebPreferences> webPreferences;
     QScopedPointer<BatchTimer> m_batchTimer;
 
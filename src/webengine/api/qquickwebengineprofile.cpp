@@ -749,6 +749,40 @@ bool QQuickWebEngineProfile::isSpellCheckEnabled() const
      return d->browserContext()->isSpellCheckEnabled();
 }
 
+/*!
+    \property QQuickWebEngineProfile::spareRendererCount
+    \brief the number of render processes the profile keeps launched ahead of time.
+
+    \since QtWebEngine 1.5
+*/
+
+/*!
+    \qmlproperty int WebEngineProfile::spareRendererCount
+
+    The number of render processes the profile keeps launched ahead of time, so that new
+    web engine views using it do not have to wait for their renderer to start. The spare
+    processes are only launched once the profile has started its first render process.
+
+    The default is \c 0, or the value of the \c QTWEBENGINE_SPARE_RENDERER_PROCESSES
+    environment variable.
+
+    \since QtWebEngine 1.5
+*/
+int QQuickWebEngineProfile::spareRendererCount() const
+{
+    const Q_D(QQuickWebEngineProfile);
+    return d->browserContext()->spareRendererCount();
+}
+
+void QQuickWebEngineProfile::setSpareRendererCount(int count)
+{
+    Q_D(QQuickWebEngineProfile);
+    const int oldCount = d->browserContext()->spareRendererCount();
+    d->browserContext()->setSpareRendererCount(count);
+    if (d->browserContext()->spareRendererCount() != oldCount)
+        emit spareRendererCountChanged();
+}
+
 /*!
 
     Returns the cookie store for this profile.
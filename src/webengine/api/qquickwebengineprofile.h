@@ -76,6 +76,7 @@ class Q_WEBENGINE_EXPORT QQuickWebEngineProfile : public QObject {
     Q_PROPERTY(QStringList spellCheckLanguages READ spellCheckLanguages WRITE setSpellCheckLanguages NOTIFY spellCheckLanguagesChanged FINAL REVISION 3)
     Q_PROPERTY(bool spellCheckEnabled READ isSpellCheckEnabled WRITE setSpellCheckEnabled NOTIFY spellCheckEnabledChanged FINAL REVISION 3)
     Q_PROPERTY(QQmlListProperty<QQuickWebEngineScript> userScripts READ userScripts FINAL REVISION 4)
+    Q_PROPERTY(int spareRendererCount READ spareRendererCount WRITE setSpareRendererCount NOTIFY spareRendererCountChanged FINAL REVISION 4)
 
 public:
     QQuickWebEngineProfile(QObject *parent = Q_NULLPTR);
@@ -139,6 +140,9 @@ public:
     void setSpellCheckEnabled(bool enabled);
     bool isSpellCheckEnabled() const;
 
+    int spareRendererCount() const;
+    void setSpareRendererCount(int count);
+
     QQmlListProperty<QQuickWebEngineScript> userScripts();
 
     static QQuickWebEngineProfile *defaultProfile();
@@ -155,6 +159,7 @@ Q_SIGNALS:
     Q_REVISION(1) void httpAcceptLanguageChanged();
     Q_REVISION(3) void spellCheckLanguagesChanged();
     Q_REVISION(3) void spellCheckEnabledChanged();
+    Q_REVISION(4) void spareRendererCountChanged();
 
     void downloadRequested(QQuickWebEngineDownloadItem *download);
     void downloadFinished(QQuickWebEngineDownloadItem *download);
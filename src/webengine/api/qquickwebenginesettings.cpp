@@ -362,6 +362,70 @@ bool QQuickWebEngineSettings::allowGeolocationOnInsecureOrigins() const
     return d_ptr->testAttribute(WebEngineSettings::AllowGeolocationOnInsecureOrigins);
 }
 
+/*!
+  \qmlproperty bool WebEngineSettings::webChannelMessageBatching
+  \since QtWebEngine 1.5
+
+  Gathers the web channel messages sent to the page within the
+  \l webChannelBatchInterval into a single IPC message. If \c qt.webChannelTransport has an
+  \c onmessages callback, it receives each batch as one array of messages.
+  Otherwise \c onmessage is called once per message, as \c qwebchannel.js
+  expects.
+
+  Disabled by default.
+*/
+bool QQuickWebEngineSettings::webChannelMessageBatching() const
+{
+    return d_ptr->testAttribute(WebEngineSettings::WebChannelMessageBatching);
+}
+
+/*!
+  \qmlproperty int WebEngineSettings::webChannelBatchInterval
+  \since QtWebEngine 1.5
+
+  The time in milliseconds during which the web channel messages sent to the
+  page are gathered into a single IPC message, counted from the first message
+  of a batch. With the default of \c 0, the messages sent within one event
+  loop iteration are gathered.
+
+  Only has an effect if \l webChannelMessageBatching is enabled.
+*/
+int QQuickWebEngineSettings::webChannelBatchInterval() const
+{
+    return d_ptr->webChannelBatchInterval();
+}
+
+/*!
+  \qmlproperty bool WebEngineSettings::pipelinedTextureFetchEnabled
+  \since QtWebEngine 1.5
+
+  Fetches the GPU textures of a new frame while the previous frame stays on
+  screen, instead of blocking the scene graph render thread until they are
+  ready. This can delay frames by one update. Has no effect when the Qt
+  OpenGL context is not shared with the one of Qt WebEngine.
+
+  Disabled by default.
+*/
+bool QQuickWebEngineSettings::pipelinedTextureFetchEnabled() const
+{
+    return d_ptr->testAttribute(WebEngineSettings::PipelinedTextureFetchEnabled);
+}
+
+/*!
+  \qmlproperty bool WebEngineSettings::webChannelObjectMessages
+  \since QtWebEngine 1.5
+
+  Hands the web channel messages sent to the page to \c onmessage as objects
+  in \c{message.data} instead of JSON text, so the page does not have to
+  parse them. \c qwebchannel.js accepts both.
+
+  Disabled by default.
+*/
+bool QQuickWebEngineSettings::webChannelObjectMessages() const
+{
+    return d_ptr->testAttribute(WebEngineSettings::WebChannelObjectMessages);
+}
+
 /*!
     \qmlproperty string WebEngineSettings::defaultTextEncoding
     \since QtWebEngine 1.2
@@ -564,6 +628,38 @@ void QQuickWebEngineSettings::setAllowGeolocationOnInsecureOrigins(bool on)
         Q_EMIT allowGeolocationOnInsecureOriginsChanged();
 }
 
+void QQuickWebEngineSettings::setWebChannelMessageBatching(bool on)
+{
+    bool wasOn = d_ptr->testAttribute(WebEngineSettings::WebChannelMessageBatching);
+    d_ptr->setAttribute(WebEngineSettings::WebChannelMessageBatching, on);
+    if (wasOn != on)
+        Q_EMIT webChannelMessageBatchingChanged();
+}
+
+void QQuickWebEngineSettings::setWebChannelBatchInterval(int msecs)
+{
+    const int oldInterval = d_ptr->webChannelBatchInterval();
+    d_ptr->setWebChannelBatchInterval(msecs);
+    if (oldInterval != d_ptr->webChannelBatchInterval())
+        Q_EMIT webChannelBatchIntervalChanged();
+}
+
+void QQuickWebEngineSettings::setPipelinedTextureFetchEnabled(bool on)
+{
+    bool wasOn = d_ptr->testAttribute(WebEngineSettings::PipelinedTextureFetchEnabled);
+    d_ptr->setAttribute(WebEngineSettings::PipelinedTextureFetchEnabled, on);
+    if (wasOn != on)
+        Q_EMIT pipelinedTextureFetchEnabledChanged();
+}
+
+void QQuickWebEngineSettings::setWebChannelObjectMessages(bool on)
+{
+    bool wasOn = d_ptr->testAttribute(WebEngineSettings::WebChannelObjectMessages);
+    d_ptr->setAttribute(WebEngineSettings::WebChannelObjectMessages, on);
+    if (wasOn != on)
+        Q_EMIT webChannelObjectMessagesChanged();
+}
+
 void QQuickWebEngineSettings::setParentSettings(QQuickWebEngineSettings *parentSettings)
 {
     d_ptr->setParentSettings(parentSettings->d_ptr.data());
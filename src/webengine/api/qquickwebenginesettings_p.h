@@ -86,6 +86,10 @@ class Q_WEBENGINE_PRIVATE_EXPORT QQuickWebEngineSettings : public QObject {
     Q_PROPERTY(bool printElementBackgrounds READ printElementBackgrounds WRITE setPrintElementBackgrounds NOTIFY printElementBackgroundsChanged REVISION 3 FINAL)
     Q_PROPERTY(bool allowRunningInsecureContent READ allowRunningInsecureContent WRITE setAllowRunningInsecureContent NOTIFY allowRunningInsecureContentChanged REVISION 3 FINAL)
     Q_PROPERTY(bool allowGeolocationOnInsecureOrigins READ allowGeolocationOnInsecureOrigins WRITE setAllowGeolocationOnInsecureOrigins NOTIFY allowGeolocationOnInsecureOriginsChanged REVISION 4 FINAL)
+    Q_PROPERTY(bool webChannelMessageBatching READ webChannelMessageBatching WRITE setWebChannelMessageBatching NOTIFY webChannelMessageBatchingChanged REVISION 4 FINAL)
+    Q_PROPERTY(int webChannelBatchInterval READ webChannelBatchInterval WRITE setWebChannelBatchInterval NOTIFY webChannelBatchIntervalChanged REVISION 4 FINAL)
+    Q_PROPERTY(bool pipelinedTextureFetchEnabled READ pipelinedTextureFetchEnabled WRITE setPipelinedTextureFetchEnabled NOTIFY pipelinedTextureFetchEnabledChanged REVISION 4 FINAL)
+    Q_PROPERTY(bool webChannelObjectMessages READ webChannelObjectMessages WRITE setWebChannelObjectMessages NOTIFY webChannelObjectMessagesChanged REVISION 4 FINAL)
 
 public:
     ~QQuickWebEngineSettings();
@@ -113,6 +117,10 @@ public:
     bool printElementBackgrounds() const;
     bool allowRunningInsecureContent() const;
     bool allowGeolocationOnInsecureOrigins() const;
+    bool webChannelMessageBatching() const;
+    int webChannelBatchInterval() const;
+    bool pipelinedTextureFetchEnabled() const;
+    bool webChannelObjectMessages() const;
 
     void setAutoLoadImages(bool on);
     void setJavascriptEnabled(bool on);
@@ -137,6 +145,10 @@ public:
     void setPrintElementBackgrounds(bool on);
     void setAllowRunningInsecureContent(bool on);
     void setAllowGeolocationOnInsecureOrigins(bool on);
+    void setWebChannelMessageBatching(bool on);
+    void setWebChannelBatchInterval(int msecs);
+    void setPipelinedTextureFetchEnabled(bool on);
+    void setWebChannelObjectMessages(bool on);
 
 signals:
     void autoLoadImagesChanged();
@@ -162,6 +174,10 @@ signals:
     Q_REVISION(3) void printElementBackgroundsChanged();
     Q_REVISION(3) void allowRunningInsecureContentChanged();
     Q_REVISION(4) void allowGeolocationOnInsecureOriginsChanged();
+    Q_REVISION(4) void webChannelMessageBatchingChanged();
+    Q_REVISION(4) void webChannelBatchIntervalChanged();
+    Q_REVISION(4) void pipelinedTextureFetchEnabledChanged();
+    Q_REVISION(4) void webChannelObjectMessagesChanged();
 
 private:
     explicit QQuickWebEngineSettings(QQuickWebEngineSettings *parentSettings = 0);
@@ -71,6 +71,8 @@
 
 #include <QClipboard>
 #include <QGuiApplication>
+#include <QImage>
+#include <QJsonValue>
 #include <QLoggingCategory>
 #include <QMarginsF>
 #include <QMimeData>
@@ -141,6 +143,7 @@ QQuickWebEngineViewPrivate::QQuickWebEngineViewPrivate()
     , devicePixelRatio(QGuiApplication::primaryScreen()->devicePixelRatio())
     , m_webChannel(0)
     , m_webChannelWorld(0)
+    , m_frameTimingEnabled(false)
     , m_dpiScale(1.0)
     , m_backgroundColor(Qt::white)
     , m_defaultZoomFactor(1.0)
@@ -838,6 +841,9 @@ void QQuickWebEngineViewPrivate::adoptWebContents(WebContentsAdapter *webContent
     if (m_webChannel)
         adapter->setWebChannel(m_webChannel, m_webChannelWorld);
 
+    if (m_frameTimingEnabled)
+        adapter->setFrameTimingEnabled(true);
+
     // set initial background color if non-default
     if (m_backgroundColor != Qt::white)
         adapter->backgroundColorChanged();
@@ -896,6 +902,8 @@ void QQuickWebEngineViewPrivate::ensureContentsAdapter()
             adapter->backgroundColorChanged();
         if (m_webChannel)
             adapter->setWebChannel(m_webChannel, m_webChannelWorld);
+        if (m_frameTimingEnabled)
+            adapter->setFrameTimingEnabled(true);
         if (explicitUrl.isValid())
             adapter->load(explicitUrl);
         // push down the page's user scripts
@@ -1088,6 +1096,15 @@ void QQuickWebEngineViewPrivate::didRunJavaScript(quint64 requestId, const QVari
     callback.call(args);
 }
 
+void QQuickWebEngineViewPrivate::didRunJavaScriptAsJson(quint64 requestId, const QJsonValue &result)
+{
+    Q_Q(QQuickWebEngineView);
+    QJSValue callback = m_callbacks.take(requestId);
+    QJSValueList args;
+    args.append(qmlEngine(q)->toScriptValue(result));
+    callback.call(args);
+}
+
 void QQuickWebEngineViewPrivate::didFindText(quint64 requestId, int matchCount)
 {
     QJSValue callback = m_callbacks.take(requestId);
@@ -1104,6 +1121,15 @@ void QQuickWebEngineViewPrivate::didPrintPage(quint64 requestId, const QByteArra
     callback.call(args);
 }
 
+void QQuickWebEngineViewPrivate::didGrabContents(quint64 requestId, const QImage &result)
+{
+    Q_Q(QQuickWebEngineView);
+    QJSValue callback = m_callbacks.take(requestId);
+    QJSValueList args;
+    args.append(qmlEngine(q)->toScriptValue(result));
+    callback.call(args);
+}
+
 void QQuickWebEngineViewPrivate::didPrintPageToPdf(const QString &filePath, bool success)
 {
     Q_Q(QQuickWebEngineView);
@@ -1245,6 +1271,23 @@ void QQuickWebEngineView::runJavaScript(const QString &script, quint32 worldId,
         d->adapter->runJavaScript(script, worldId);
 }
 
+void QQuickWebEngineView::runJavaScriptBatch(const QStringList &scripts, const QJSValue &callback)
+{
+    Q_D(QQuickWebEngineView);
+    d->ensureContentsAdapter();
+    runJavaScriptBatch(scripts, QQuickWebEngineScript::MainWorld, QString(), callback);
+}
+
+void QQuickWebEngineView::runJavaScriptBatch(const QStringList &scripts, quint32 worldId, const QString &frameName, const QJSValue &callback)
+{
+    Q_D(QQuickWebEngineView);
+    if (!d->adapter)
+        return;
+    quint64 requestId = d->adapter->runJavaScriptBatch(scripts, worldId, frameName);
+    if (!callback.isUndefined())
+        d->m_callbacks.insert(requestId, callback);
+}
+
 qreal QQuickWebEngineView::zoomFactor() const
 {
     Q_D(const QQuickWebEngineView);
@@ -1305,6 +1348,31 @@ bool QQuickWebEngineView::recentlyAudible() const
     return false;
 }
 
+bool QQuickWebEngineView::isFrameTimingEnabled() const
+{
+    Q_D(const QQuickWebEngineView);
+    return d->m_frameTimingEnabled;
+}
+
+void QQuickWebEngineView::setFrameTimingEnabled(bool enabled)
+{
+    Q_D(QQuickWebEngineView);
+    if (d->m_frameTimingEnabled == enabled)
+        return;
+    d->m_frameTimingEnabled = enabled;
+    if (d->adapter)
+        d->adapter->setFrameTimingEnabled(enabled);
+    Q_EMIT frameTimingEnabledChanged(enabled);
+}
+
+QVariantList QQuickWebEngineView::frameTimings() const
+{
+    Q_D(const QQuickWebEngineView);
+    if (!d->adapter)
+        return QVariantList();
+    return d->adapter->frameTimings();
+}
+
 void QQuickWebEngineView::printToPdf(const QString& filePath, PrintedPageSizeId pageSizeId, PrintedPageOrientation orientation)
 {
 #if defined(ENABLE_PDF)
@@ -1346,6 +1414,23 @@ void QQuickWebEngineView::printToPdf(const QJSValue &callback, PrintedPageSizeId
 #endif
 }
 
+void QQuickWebEngineView::grabContents(const QJSValue &callback, const QRect &sourceRect, const QSize &targetSize)
+{
+    Q_D(QQuickWebEngineView);
+    if (callback.isUndefined())
+        return;
+    quint64 requestId = d->adapter ? d->adapter->grabContents(sourceRect, targetSize) : 0;
+    if (!requestId) {
+        // Call back with a null image.
+        QJSValueList args;
+        args.append(qmlEngine(this)->toScriptValue(QImage()));
+        QJSValue callbackCopy = callback;
+        callbackCopy.call(args);
+        return;
+    }
+    d->m_callbacks.insert(requestId, callback);
+}
+
 void QQuickWebEngineView::replaceMisspelledWord(const QString &replacement)
 {
     Q_D(QQuickWebEngineView);
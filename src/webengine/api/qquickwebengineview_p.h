@@ -123,6 +123,7 @@ class Q_WEBENGINE_PRIVATE_EXPORT QQuickWebEngineView : public QQuickItem {
     Q_PROPERTY(bool audioMuted READ isAudioMuted WRITE setAudioMuted NOTIFY audioMutedChanged FINAL REVISION 3)
     Q_PROPERTY(bool recentlyAudible READ recentlyAudible NOTIFY recentlyAudibleChanged FINAL REVISION 3)
     Q_PROPERTY(uint webChannelWorld READ webChannelWorld WRITE setWebChannelWorld NOTIFY webChannelWorldChanged REVISION 3 FINAL)
+    Q_PROPERTY(bool frameTimingEnabled READ isFrameTimingEnabled WRITE setFrameTimingEnabled NOTIFY frameTimingEnabledChanged REVISION 5 FINAL)
 
 #ifdef ENABLE_QML_TESTSUPPORT_API
     Q_PROPERTY(QQuickWebEngineTestSupport *testSupport READ testSupport WRITE setTestSupport NOTIFY testSupportChanged FINAL)
@@ -467,6 +468,10 @@ public:
     void setAudioMuted(bool muted);
     bool recentlyAudible() const;
 
+    bool isFrameTimingEnabled() const;
+    void setFrameTimingEnabled(bool enabled);
+    Q_REVISION(5) Q_INVOKABLE QVariantList frameTimings() const;
+
 #ifdef ENABLE_QML_TESTSUPPORT_API
     QQuickWebEngineTestSupport *testSupport() const;
     void setTestSupport(QQuickWebEngineTestSupport *testSupport);
@@ -477,6 +482,8 @@ public:
 public Q_SLOTS:
     void runJavaScript(const QString&, const QJSValue & = QJSValue());
     Q_REVISION(3) void runJavaScript(const QString&, quint32 worldId, const QJSValue & = QJSValue());
+    Q_REVISION(5) void runJavaScriptBatch(const QStringList &scripts, const QJSValue &callback);
+    Q_REVISION(5) void runJavaScriptBatch(const QStringList &scripts, quint32 worldId, const QString &frameName, const QJSValue &callback);
     void loadHtml(const QString &html, const QUrl &baseUrl = QUrl());
     void goBack();
     void goForward();
@@ -492,6 +499,7 @@ public Q_SLOTS:
     Q_REVISION(3) void printToPdf(const QString &filePath, PrintedPageSizeId pageSizeId = PrintedPageSizeId::A4, PrintedPageOrientation orientation = PrintedPageOrientation::Portrait);
     Q_REVISION(3) void printToPdf(const QJSValue &callback, PrintedPageSizeId pageSizeId = PrintedPageSizeId::A4, PrintedPageOrientation orientation = PrintedPageOrientation::Portrait);
     Q_REVISION(4) void replaceMisspelledWord(const QString &replacement);
+    Q_REVISION(5) void grabContents(const QJSValue &callback, const QRect &sourceRect = QRect(), const QSize &targetSize = QSize());
 
 private Q_SLOTS:
     void lazyInitialize();
@@ -529,6 +537,7 @@ Q_SIGNALS:
     Q_REVISION(4) void fileDialogRequested(QQuickWebEngineFileDialogRequest *request);
     Q_REVISION(4) void formValidationMessageRequested(QQuickWebEngineFormValidationMessageRequest *request);
     Q_REVISION(5) void pdfPrintingFinished(const QString &filePath, bool success);
+    Q_REVISION(5) void frameTimingEnabledChanged(bool enabled);
 
 #ifdef ENABLE_QML_TESTSUPPORT_API
     void testSupportChanged();
@@ -119,11 +119,16 @@ public:
     virtual void runFileChooser(QSharedPointer<QtWebEngineCore::FilePickerController>) Q_DECL_OVERRIDE;
     virtual void showColorDialog(QSharedPointer<QtWebEngineCore::ColorChooserController>) Q_DECL_OVERRIDE;
     virtual void didRunJavaScript(quint64, const QVariant&) Q_DECL_OVERRIDE;
+    virtual void didRunJavaScriptAsJson(quint64, const QJsonValue &) Q_DECL_OVERRIDE;
     virtual void didFetchDocumentMarkup(quint64, const QString&) Q_DECL_OVERRIDE { }
     virtual void didFetchDocumentInnerText(quint64, const QString&) Q_DECL_OVERRIDE { }
+    virtual void didFetchDocumentChunk(quint64, const QString &, bool) Q_DECL_OVERRIDE { }
     virtual void didFindText(quint64, int) Q_DECL_OVERRIDE;
     virtual void didPrintPage(quint64 requestId, const QByteArray &result) Q_DECL_OVERRIDE;
     virtual void didPrintPageToPdf(const QString &filePath, bool success) Q_DECL_OVERRIDE;
+    virtual void didPrintPdfPage(const QString &, int, int, const QByteArray &) Q_DECL_OVERRIDE { }
+    virtual void didGrabContents(quint64 requestId, const QImage &result) Q_DECL_OVERRIDE;
+    virtual void didCaptureFrame(const QImage &) Q_DECL_OVERRIDE { }
     virtual void passOnFocus(bool reverse) Q_DECL_OVERRIDE;
     virtual void javaScriptConsoleMessage(JavaScriptConsoleMessageLevel level, const QString& message, int lineNumber, const QString& sourceID) Q_DECL_OVERRIDE;
     virtual void authenticationRequired(QSharedPointer<QtWebEngineCore::AuthenticationDialogController>) Q_DECL_OVERRIDE;
@@ -186,6 +191,7 @@ public:
     QList<QSharedPointer<CertificateErrorController> > m_certificateErrorControllers;
     QQmlWebChannel *m_webChannel;
     uint m_webChannelWorld;
+    bool m_frameTimingEnabled;
 
 private:
     QScopedPointer<QtWebEngineCore::UIDelegatesManager> m_uIDelegatesManager;
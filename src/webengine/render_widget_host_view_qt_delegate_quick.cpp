@@ -42,11 +42,13 @@
 #include "qquickwebengineview_p.h"
 #include "qquickwebengineview_p_p.h"
 #include <QGuiApplication>
+#include <QQuickItemGrabResult>
 #include <QQuickPaintedItem>
 #include <QQuickWindow>
 #include <QSurfaceFormat>
 #include <QVariant>
 #include <QWindow>
+#include <private/qquickshadereffectsource_p.h>
 #include <private/qquickwindow_p.h>
 #include <private/qsgcontext_p.h>
 
@@ -238,6 +240,29 @@ void RenderWidgetHostViewQtDelegateQuick::inputMethodStateChanged(bool editorVis
 
 }
 
+QSharedPointer<QQuickItemGrabResult> RenderWidgetHostViewQtDelegateQuick::grabContents(const QRect &sourceRect, const QSize &targetSize)
+{
+    if (sourceRect == QRect(QPoint(), size().toSize()))
+        return grabToImage(targetSize);
+
+    // Only render the source rect at the target size, through a shader effect source placed
+    // outside of the visible area of the window. It goes away once the grab is done.
+    QQuickShaderEffectSource *source = new QQuickShaderEffectSource;
+    source->setParentItem(QQuickItem::window()->contentItem());
+    source->setSourceItem(this);
+    source->setSourceRect(sourceRect);
+    source->setTextureSize(targetSize);
+    source->setSize(targetSize);
+    source->setPosition(QPointF(-targetSize.width(), -targetSize.height()));
+    QSharedPointer<QQuickItemGrabResult> grab = source->grabToImage(targetSize);
+    if (!grab) {
+        delete source;
+        return grab;
+    }
+    QObject::connect(grab.data(), &QQuickItemGrabResult::ready, source, &QObject::deleteLater);
+    return grab;
+}
+
 bool RenderWidgetHostViewQtDelegateQuick::event(QEvent *event)
 {
     if (event->type() == QEvent::ShortcutOverride) {
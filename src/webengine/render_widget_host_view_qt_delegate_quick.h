@@ -77,6 +77,7 @@ public:
     virtual void setInputMethodHints(Qt::InputMethodHints) Q_DECL_OVERRIDE { }
     // The QtQuick view doesn't have a backbuffer of its own and doesn't need this
     virtual void setClearColor(const QColor &) Q_DECL_OVERRIDE { }
+    virtual QSharedPointer<QQuickItemGrabResult> grabContents(const QRect &sourceRect, const QSize &targetSize) Q_DECL_OVERRIDE;
 
 protected:
     virtual bool event(QEvent *event) Q_DECL_OVERRIDE;
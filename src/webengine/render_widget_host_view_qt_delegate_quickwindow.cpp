@@ -148,4 +148,9 @@ void RenderWidgetHostViewQtDelegateQuickWindow::move(const QPoint &screenPos)
     QQuickWindow::setPosition(screenPos);
 }
 
+QSharedPointer<QQuickItemGrabResult> RenderWidgetHostViewQtDelegateQuickWindow::grabContents(const QSize &targetSize)
+{
+    return m_realDelegate->grabContents(targetSize);
+}
+
 } // namespace QtWebEngineCore
@@ -79,6 +79,7 @@ public:
     virtual void inputMethodStateChanged(bool) Q_DECL_OVERRIDE {}
     virtual void setInputMethodHints(Qt::InputMethodHints) Q_DECL_OVERRIDE { }
     virtual void setClearColor(const QColor &) Q_DECL_OVERRIDE { }
+    virtual QSharedPointer<QQuickItemGrabResult> grabContents(const QSize &targetSize) Q_DECL_OVERRIDE;
 
 private:
     QScopedPointer<RenderWidgetHostViewQtDelegate> m_realDelegate;
@@ -80,6 +80,7 @@
 #include <QLoggingCategory>
 #include <QMenu>
 #include <QMessageBox>
+#include <QMetaMethod>
 #include <QMimeData>
 #if defined(QT_PRINTSUPPORT_LIB)
 #ifndef QT_NO_PRINTER
@@ -93,6 +94,8 @@
 
 #include <private/qguiapplication_p.h>
 
+#include <limits>
+
 QT_BEGIN_NAMESPACE
 
 using namespace QtWebEngineCore;
@@ -100,10 +103,17 @@ using namespace QtWebEngineCore;
 static const int MaxTooltipLength = 1024;
 
 #if defined(ENABLE_PRINTING) && defined(ENABLE_PDF)
+Q_LOGGING_CATEGORY(lcWebEnginePrinting, "qt.webengine.printing")
+
+// Pages kept rasterized when each of them is printed only once, half of them rendered ahead.
+static const int kPrintCachedPages = 4;
+
 static bool printPdfDataOnPrinter(const QByteArray& data, QPrinter& printer)
 {
     QRect printerPageRect = printer.pageRect();
     PdfiumDocumentWrapperQt pdfiumWrapper(data.constData(), data.size(), printerPageRect.size());
+    // The page rect is in device pixels already, there is nothing to gain from rendering at a higher resolution.
+    pdfiumWrapper.setImageScale(1.0);
 
     int toPage = printer.toPage();
     int fromPage = printer.fromPage();
@@ -132,6 +142,14 @@ static bool printPdfDataOnPrinter(const QByteArray& data, QPrinter& printer)
         documentCopies = 1;
     }
 
+    // Uncollated copies go through the whole range again and keep the default budget.
+    if (documentCopies == 1)
+        pdfiumWrapper.setCacheBudget(qint64(printerPageRect.width()) * printerPageRect.height() * 4 * kPrintCachedPages);
+
+    // Let the pages be rasterized in the background while the previous ones are printed.
+    // This has to come after the budget is set, the prefetching runs ahead by half of it.
+    pdfiumWrapper.prefetchPages(fromPage - 1, toPage - 1);
+
     QPainter painter;
     if (!painter.begin(&printer)) {
 #if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
@@ -174,6 +192,9 @@ static bool printPdfDataOnPrinter(const QByteArray& data, QPrinter& printer)
     }
     painter.end();
 
+    const PdfiumCacheStats stats = pdfiumWrapper.cacheStats();
+    qCDebug(lcWebEnginePrinting, "Page cache: %llu hits, %llu misses, %lld of %lld bytes in %d pages",
+            stats.hits, stats.misses, stats.cachedBytes, stats.budget, stats.cachedPages);
     return true;
 }
 #endif // defined(ENABLE_PRINTING) && defined(ENABLE_PDF)
@@ -366,6 +387,26 @@ void QWebEnginePagePrivate::didPrintPageToPdf(const QString &filePath, bool succ
     Q_EMIT q->pdfPrintingFinished(filePath, success);
 }
 
+void QWebEnginePagePrivate::didPrintPdfPage(const QString &filePath, int pageIndex, int pageCount, const QByteArray &pageData)
+{
+    Q_Q(QWebEnginePage);
+    Q_EMIT q->pdfPagePrinted(filePath, pageIndex, pageCount, pageData);
+}
+
+bool QWebEnginePagePrivate::reportsPdfPages() const
+{
+    Q_Q(const QWebEnginePage);
+    // Rendering every page into a document of its own is extra work, only do it when asked for.
+    static const QMetaMethod pdfPagePrintedSignal = QMetaMethod::fromSignal(&QWebEnginePage::pdfPagePrinted);
+    return q->isSignalConnected(pdfPagePrintedSignal);
+}
+
+void QWebEnginePagePrivate::didCaptureFrame(const QImage &frame)
+{
+    Q_Q(QWebEnginePage);
+    Q_EMIT q->frameCaptured(frame);
+}
+
 void QWebEnginePagePrivate::focusContainer()
 {
     if (view)
@@ -467,6 +508,11 @@ void QWebEnginePagePrivate::didRunJavaScript(quint64 requestId, const QVariant&
     m_callbacks.invoke(requestId, result);
 }
 
+void QWebEnginePagePrivate::didRunJavaScriptAsJson(quint64 requestId, const QJsonValue &result)
+{
+    m_callbacks.invoke(requestId, result);
+}
+
 void QWebEnginePagePrivate::didFetchDocumentMarkup(quint64 requestId, const QString& result)
 {
     m_callbacks.invoke(requestId, result);
@@ -477,6 +523,27 @@ void QWebEnginePagePrivate::didFetchDocumentInnerText(quint64 requestId, const Q
     m_callbacks.invoke(requestId, result);
 }
 
+void QWebEnginePagePrivate::didFetchDocumentChunk(quint64 requestId, const QString &chunk, bool last)
+{
+    if (m_documentDevices.contains(requestId)) {
+        QPointer<QIODevice> &device = m_documentDevices[requestId];
+        if (device && !chunk.isEmpty() && device->write(chunk.toUtf8()) < 0)
+            device.clear();
+        if (last)
+            m_callbacks.invoke(requestId, !m_documentDevices.take(requestId).isNull());
+        return;
+    }
+    if (!chunk.isEmpty())
+        m_callbacks.invokePartial(requestId, chunk);
+    if (last)
+        m_callbacks.invoke(requestId, QString());
+}
+
+void QWebEnginePagePrivate::didGrabContents(quint64 requestId, const QImage &result)
+{
+    m_callbacks.invoke(requestId, result);
+}
+
 void QWebEnginePagePrivate::didFindText(quint64 requestId, int matchCount)
 {
     m_callbacks.invoke(requestId, matchCount > 0);
@@ -748,6 +815,35 @@ QWebEnginePage::QWebEnginePage(QObject* parent)
     \sa printToPdf()
 */
 
+/*!
+    \fn void QWebEnginePage::pdfPagePrinted(const QString &filePath, int pageIndex, int pageCount, const QByteArray &pageData)
+    \since 5.10
+
+    This signal is emitted while printing the web page into a PDF, every time a page
+    has been rendered. \a pageIndex is the zero-based index of the page and \a pageCount
+    the number of pages of the document. \a pageData holds the page as a PDF document of
+    its own.
+
+    \a filePath identifies the request: it is the file path passed to printToPdf(), or an
+    empty string for requests that return the PDF data to a callback.
+
+    The signal is only emitted for PDF printing requests that were made while it was connected.
+    Requests of one page are processed one after the other, in the order they were made, so
+    the pages of a request are reported before the first page of the next one.
+
+    \sa printToPdf(), pdfPrintingFinished()
+*/
+
+/*!
+    \fn void QWebEnginePage::frameCaptured(const QImage &frame)
+    \since 5.10
+
+    This signal is emitted with the content of the page, \a frame, while frame capture
+    is running.
+
+    \sa startFrameCapture()
+*/
+
 /*!
     \property QWebEnginePage::scrollPosition
     \since 5.7
@@ -1806,6 +1902,41 @@ void QWebEnginePage::toPlainText(const QWebEngineCallback<const QString &> &resu
     d->m_callbacks.registerCallback(requestId, resultCallback);
 }
 
+static quint64 maxDocumentLength(qint64 maxSize)
+{
+    return maxSize < 0 ? std::numeric_limits<quint64>::max() : quint64(maxSize);
+}
+
+void QWebEnginePage::toHtml(QIODevice *device, const QWebEngineCallback<bool> &resultCallback, qint64 maxSize) const
+{
+    Q_D(const QWebEnginePage);
+    quint64 requestId = d->adapter->streamDocumentMarkup(maxDocumentLength(maxSize));
+    d->m_documentDevices.insert(requestId, device);
+    d->m_callbacks.registerCallback(requestId, resultCallback);
+}
+
+void QWebEnginePage::toPlainText(QIODevice *device, const QWebEngineCallback<bool> &resultCallback, qint64 maxSize) const
+{
+    Q_D(const QWebEnginePage);
+    quint64 requestId = d->adapter->streamDocumentInnerText(maxDocumentLength(maxSize));
+    d->m_documentDevices.insert(requestId, device);
+    d->m_callbacks.registerCallback(requestId, resultCallback);
+}
+
+void QWebEnginePage::toHtmlChunked(const QWebEngineCallback<const QString &> &chunkCallback, qint64 maxSize) const
+{
+    Q_D(const QWebEnginePage);
+    quint64 requestId = d->adapter->streamDocumentMarkup(maxDocumentLength(maxSize));
+    d->m_callbacks.registerCallback(requestId, chunkCallback);
+}
+
+void QWebEnginePage::toPlainTextChunked(const QWebEngineCallback<const QString &> &chunkCallback, qint64 maxSize) const
+{
+    Q_D(const QWebEnginePage);
+    quint64 requestId = d->adapter->streamDocumentInnerText(maxDocumentLength(maxSize));
+    d->m_callbacks.registerCallback(requestId, chunkCallback);
+}
+
 void QWebEnginePage::setHtml(const QString &html, const QUrl &baseUrl)
 {
     setContent(html.toUtf8(), QStringLiteral("text/html;charset=UTF-8"), baseUrl);
@@ -1915,6 +2046,80 @@ void QWebEnginePage::runJavaScript(const QString& scriptSource, quint32 worldId,
     d->m_callbacks.registerCallback(requestId, resultCallback);
 }
 
+/*!
+    \fn void QWebEnginePage::runJavaScriptAsJson(const QString &scriptSource, FunctorOrLambda resultCallback)
+    \since 5.10
+    \overload runJavaScriptAsJson()
+
+    Runs the JavaScript code contained in \a scriptSource in the \c MainWorld and calls
+    \a resultCallback with the result as a QJsonValue.
+*/
+void QWebEnginePage::runJavaScriptAsJson(const QString &scriptSource, const QWebEngineCallback<const QJsonValue &> &resultCallback)
+{
+    runJavaScriptAsJson(scriptSource, QWebEngineScript::MainWorld, resultCallback);
+}
+
+/*!
+    \fn void QWebEnginePage::runJavaScriptAsJson(const QString &scriptSource, quint32 worldId, FunctorOrLambda resultCallback)
+    \since 5.10
+
+    Runs the JavaScript code contained in \a scriptSource in the world specified by \a worldId,
+    and calls \a resultCallback with the result of the last executed statement as a QJsonValue.
+
+    Unlike runJavaScript(), the result is converted to JSON while still in the render process,
+    mostly following the rules of \c JSON.stringify(): functions and undefined object properties
+    are left out, and values that have no JSON representation become null. Where
+    \c JSON.stringify() would throw, references back to an enclosing object and values nested
+    more than 100 levels deep become null as well. Its objects and arrays
+    are only decoded when they are accessed, which makes this function much faster than
+    runJavaScript() for large results.
+
+    \sa runJavaScript()
+*/
+void QWebEnginePage::runJavaScriptAsJson(const QString &scriptSource, quint32 worldId, const QWebEngineCallback<const QJsonValue &> &resultCallback)
+{
+    Q_D(QWebEnginePage);
+    quint64 requestId = d->adapter->runJavaScriptAsJson(scriptSource, worldId);
+    d->m_callbacks.registerCallback(requestId, resultCallback);
+}
+
+/*!
+    \fn void QWebEnginePage::runJavaScriptBatch(const QStringList &scriptSources, FunctorOrLambda resultCallback)
+    \since 5.10
+    \overload runJavaScriptBatch()
+
+    Runs the JavaScript code snippets in \a scriptSources in the \c MainWorld of the main frame
+    and calls \a resultCallback with their results.
+*/
+void QWebEnginePage::runJavaScriptBatch(const QStringList &scriptSources, const QWebEngineCallback<const QJsonValue &> &resultCallback)
+{
+    runJavaScriptBatch(scriptSources, QWebEngineScript::MainWorld, QString(), resultCallback);
+}
+
+/*!
+    \fn void QWebEnginePage::runJavaScriptBatch(const QStringList &scriptSources, quint32 worldId, const QString &frameName, FunctorOrLambda resultCallback)
+    \since 5.10
+
+    Runs each of the JavaScript code snippets in \a scriptSources, in order, in the world specified
+    by \a worldId and calls \a resultCallback once with a QJsonValue holding an array of the results.
+    The array has one entry per script, converted the same way as by runJavaScriptAsJson().
+
+    All the scripts are sent to the render process together and their results come back together,
+    which avoids the round trip per script that calling runJavaScriptAsJson() repeatedly costs.
+
+    If \a frameName is not empty, the scripts run in the first frame of the page whose name is
+    \a frameName instead of the main frame. The result of a script is null if no such frame exists
+    at the time it would run.
+
+    \sa runJavaScriptAsJson()
+*/
+void QWebEnginePage::runJavaScriptBatch(const QStringList &scriptSources, quint32 worldId, const QString &frameName, const QWebEngineCallback<const QJsonValue &> &resultCallback)
+{
+    Q_D(QWebEnginePage);
+    quint64 requestId = d->adapter->runJavaScriptBatch(scriptSources, worldId, frameName);
+    d->m_callbacks.registerCallback(requestId, resultCallback);
+}
+
 /*!
     Returns the collection of scripts that are injected into the page.
 
@@ -2055,8 +2260,11 @@ QSizeF QWebEnginePage::contentsSize() const
     pdfPrintingFinished().
 
     If a file already exists at the provided file path, it will be overwritten.
+
+    Requests made while a previous one is still running are queued. Across all pages, at most
+    as many documents as there are processor cores are rendered at the same time.
     \since 5.7
-    \sa pdfPrintingFinished()
+    \sa pdfPrintingFinished(), pdfPagePrinted(), cancelPdfPrinting()
 */
 void QWebEnginePage::printToPdf(const QString &filePath, const QPageLayout &pageLayout)
 {
@@ -2072,7 +2280,7 @@ void QWebEnginePage::printToPdf(const QString &filePath, const QPageLayout &page
         return;
     }
 #endif // ENABLE_PRINTING
-    d->adapter->printToPDF(pageLayout, filePath);
+    d->adapter->printToPDF(pageLayout, filePath, d->reportsPdfPages());
 #else
     Q_UNUSED(filePath);
     Q_UNUSED(pageLayout);
@@ -2089,7 +2297,10 @@ void QWebEnginePage::printToPdf(const QString &filePath, const QPageLayout &page
     The \a resultCallback must take a const reference to a QByteArray as parameter. If printing was successful, this byte array
     will contain the PDF data, otherwise, the byte array will be empty.
 
+    Requests made while a previous one is still running are queued.
+
     \since 5.7
+    \sa pdfPagePrinted(), cancelPdfPrinting()
 */
 void QWebEnginePage::printToPdf(const QWebEngineCallback<const QByteArray&> &resultCallback, const QPageLayout &pageLayout)
 {
@@ -2106,7 +2317,7 @@ void QWebEnginePage::printToPdf(const QWebEngineCallback<const QByteArray&> &res
         return;
     }
 #endif // ENABLE_PRINTING
-    quint64 requestId = d->adapter->printToPDFCallbackResult(pageLayout);
+    quint64 requestId = d->adapter->printToPDFCallbackResult(pageLayout, true, d->reportsPdfPages());
     d->m_callbacks.registerCallback(requestId, resultCallback);
 #else // if defined(ENABLE_PDF)
     Q_UNUSED(pageLayout);
@@ -2114,6 +2325,161 @@ void QWebEnginePage::printToPdf(const QWebEngineCallback<const QByteArray&> &res
 #endif // if defined(ENABLE_PDF)
 }
 
+/*!
+    \since 5.10
+    Cancels the running and all queued requests to print the page into a PDF.
+
+    Cancelled requests report failure: callbacks receive an empty byte array, and
+    pdfPrintingFinished() is emitted with \c false for requests to print into a file.
+
+    \sa printToPdf()
+*/
+void QWebEnginePage::cancelPdfPrinting()
+{
+    Q_D(QWebEnginePage);
+    d->adapter->cancelPrintToPDF();
+}
+
+/*!
+    \fn void QWebEnginePage::grabToImage(FunctorOrLambda resultCallback, const QRect &sourceRect, const QSize &targetSize)
+    Grabs the currently displayed content of the page and passes it as a QImage to \a resultCallback.
+
+    Only the area given by \a sourceRect, in device independent pixels, is grabbed. The whole
+    page is grabbed if it is empty. The image is scaled to \a targetSize, or has the size of the
+    grabbed area if it is empty.
+
+    The contents are read back asynchronously from the frame shown by the view, without blocking
+    the GUI thread. The page has to be shown in a view. If grabbing fails, \a resultCallback
+    receives a null image.
+
+    \since 5.10
+*/
+void QWebEnginePage::grabToImage(const QWebEngineCallback<const QImage &> &resultCallback, const QRect &sourceRect, const QSize &targetSize)
+{
+    Q_D(QWebEnginePage);
+    quint64 requestId = d->adapter->grabContents(sourceRect, targetSize);
+    if (!requestId) {
+        d->m_callbacks.invokeEmpty(resultCallback);
+        return;
+    }
+    d->m_callbacks.registerCallback(requestId, resultCallback);
+}
+
+/*!
+    Starts capturing the content of the page shown in a view, the frames are delivered
+    with the frameCaptured() signal.
+
+    A frame is captured when the page has rendered new content, at most
+    \a maxFramesPerSecond times per second. Content rendered while the previous capture is
+    still being read back is coalesced into the next frame, so slow consumers get fewer
+    frames instead of a growing backlog.
+
+    \since 5.10
+    \sa stopFrameCapture(), grabToImage()
+*/
+void QWebEnginePage::startFrameCapture(int maxFramesPerSecond)
+{
+    Q_D(QWebEnginePage);
+    d->adapter->setFrameCaptureRate(maxFramesPerSecond);
+}
+
+/*!
+    Stops capturing frames.
+
+    \since 5.10
+    \sa startFrameCapture()
+*/
+void QWebEnginePage::stopFrameCapture()
+{
+    Q_D(QWebEnginePage);
+    d->adapter->setFrameCaptureRate(0);
+}
+
+/*!
+    Enables or disables recording the timing of the frames rendered for the page, depending
+    on \a enabled.
+
+    For each compositor frame, the time it was received from the renderer, committed to the
+    scene graph, prepared for rendering and acknowledged is recorded along with the number of
+    render passes, quads and resources it contained, how long fetching its GPU textures took,
+    how many bytes of software rendered tiles were uploaded to textures and how many of them
+    had to be converted first, and whether the scene graph node tree had to be rebuilt for it.
+    Enabling the recording again discards the frames recorded so far.
+
+    \since 5.10
+    \sa frameTimingTrace(), frameTimings()
+*/
+void QWebEnginePage::setFrameTimingEnabled(bool enabled)
+{
+    Q_D(QWebEnginePage);
+    d->adapter->setFrameTimingEnabled(enabled);
+}
+
+/*!
+    Returns whether the timing of rendered frames is being recorded.
+
+    \since 5.10
+    \sa setFrameTimingEnabled()
+*/
+bool QWebEnginePage::isFrameTimingEnabled() const
+{
+    Q_D(const QWebEnginePage);
+    return d->adapter->isFrameTimingEnabled();
+}
+
+/*!
+    Returns the frame timings recorded for the page in the Chrome trace event JSON format,
+    which can be loaded in \c chrome://tracing. The most recent frames are kept.
+
+    Returns an empty byte array if frame timing was never enabled.
+
+    \since 5.10
+    \sa setFrameTimingEnabled(), frameTimings()
+*/
+QByteArray QWebEnginePage::frameTimingTrace() const
+{
+    Q_D(const QWebEnginePage);
+    return d->adapter->frameTimingTrace();
+}
+
+/*!
+    Returns the frame timings recorded for the page, oldest first, as one QVariantMap per
+    frame. The most recent frames are kept.
+
+    The \c swapTime, \c commitStartTime, \c commitEndTime, \c preprocessStartTime,
+    \c preprocessEndTime and \c ackTime entries hold the time in microseconds at which each
+    stage of the frame started or finished, or \c 0 if it did not run (yet). The
+    \c mailboxFetchLatency and \c mailboxFetchBlockedTime durations are in microseconds too.
+    The other entries hold the same counters as the arguments of the \c CompositorFrame
+    events in frameTimingTrace(): \c frameId, \c renderPasses, \c quads,
+    \c resourcesImported, \c resourcesReturned, \c deferredCommits, \c mailboxesFetched,
+    \c nodesCreated, \c nodesReused, \c softwareBytesUploaded, \c softwareBytesConverted,
+    \c treeRebuilt and \c acked.
+
+    Returns an empty list if frame timing was never enabled.
+
+    \since 5.10
+    \sa setFrameTimingEnabled(), frameTimingTrace()
+*/
+QVariantList QWebEnginePage::frameTimings() const
+{
+    Q_D(const QWebEnginePage);
+    return d->adapter->frameTimings();
+}
+
+/*!
+    Returns the process ID of the render process the page is currently displayed in,
+    or \c 0 if that process has not finished launching yet.
+
+    \since 5.10
+    \sa QWebEngineProfile::setSpareRendererCount()
+*/
+qint64 QWebEnginePage::renderProcessPid() const
+{
+    Q_D(const QWebEnginePage);
+    return d->adapter->renderProcessPid();
+}
+
 #if defined(QT_PRINTSUPPORT_LIB)
 #ifndef QT_NO_PRINTER
 /*!
@@ -54,6 +54,7 @@
 #include <QtWidgets/qwidget.h>
 
 QT_BEGIN_NAMESPACE
+class QIODevice;
 class QMenu;
 #if defined(QT_PRINTSUPPORT_LIB)
 #ifndef QT_NO_PRINTER
@@ -260,9 +261,17 @@ public:
 #ifdef Q_QDOC
     void toHtml(FunctorOrLambda resultCallback) const;
     void toPlainText(FunctorOrLambda resultCallback) const;
+    void toHtml(QIODevice *device, FunctorOrLambda resultCallback, qint64 maxSize = -1) const;
+    void toPlainText(QIODevice *device, FunctorOrLambda resultCallback, qint64 maxSize = -1) const;
+    void toHtmlChunked(FunctorOrLambda chunkCallback, qint64 maxSize = -1) const;
+    void toPlainTextChunked(FunctorOrLambda chunkCallback, qint64 maxSize = -1) const;
 #else
     void toHtml(const QWebEngineCallback<const QString &> &resultCallback) const;
     void toPlainText(const QWebEngineCallback<const QString &> &resultCallback) const;
+    void toHtml(QIODevice *device, const QWebEngineCallback<bool> &resultCallback, qint64 maxSize = -1) const;
+    void toPlainText(QIODevice *device, const QWebEngineCallback<bool> &resultCallback, qint64 maxSize = -1) const;
+    void toHtmlChunked(const QWebEngineCallback<const QString &> &chunkCallback, qint64 maxSize = -1) const;
+    void toPlainTextChunked(const QWebEngineCallback<const QString &> &chunkCallback, qint64 maxSize = -1) const;
 #endif
 
     QString title() const;
@@ -286,6 +295,17 @@ public:
 #else
     void runJavaScript(const QString& scriptSource, const QWebEngineCallback<const QVariant &> &resultCallback);
     void runJavaScript(const QString& scriptSource, quint32 worldId, const QWebEngineCallback<const QVariant &> &resultCallback);
+#endif
+#ifdef Q_QDOC
+    void runJavaScriptAsJson(const QString &scriptSource, FunctorOrLambda resultCallback);
+    void runJavaScriptAsJson(const QString &scriptSource, quint32 worldId, FunctorOrLambda resultCallback);
+    void runJavaScriptBatch(const QStringList &scriptSources, FunctorOrLambda resultCallback);
+    void runJavaScriptBatch(const QStringList &scriptSources, quint32 worldId, const QString &frameName, FunctorOrLambda resultCallback);
+#else
+    void runJavaScriptAsJson(const QString &scriptSource, const QWebEngineCallback<const QJsonValue &> &resultCallback);
+    void runJavaScriptAsJson(const QString &scriptSource, quint32 worldId, const QWebEngineCallback<const QJsonValue &> &resultCallback);
+    void runJavaScriptBatch(const QStringList &scriptSources, const QWebEngineCallback<const QJsonValue &> &resultCallback);
+    void runJavaScriptBatch(const QStringList &scriptSources, quint32 worldId, const QString &frameName, const QWebEngineCallback<const QJsonValue &> &resultCallback);
 #endif
     QWebEngineScriptCollection &scripts();
     QWebEngineSettings *settings() const;
@@ -309,6 +329,21 @@ public:
 #else
     void printToPdf(const QWebEngineCallback<const QByteArray&> &resultCallback, const QPageLayout &layout = QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF()));
 #endif
+    void cancelPdfPrinting();
+
+#ifdef Q_QDOC
+    void grabToImage(FunctorOrLambda resultCallback, const QRect &sourceRect = QRect(), const QSize &targetSize = QSize());
+#else
+    void grabToImage(const QWebEngineCallback<const QImage &> &resultCallback, const QRect &sourceRect = QRect(), const QSize &targetSize = QSize());
+#endif
+    void startFrameCapture(int maxFramesPerSecond = 30);
+    void stopFrameCapture();
+    void setFrameTimingEnabled(bool enabled);
+    bool isFrameTimingEnabled() const;
+    QByteArray frameTimingTrace() const;
+    QVariantList frameTimings() const;
+
+    qint64 renderProcessPid() const;
 
 #if defined(QT_PRINTSUPPORT_LIB)
 #ifndef QT_NO_PRINTER
@@ -353,6 +388,8 @@ Q_SIGNALS:
     void recentlyAudibleChanged(bool recentlyAudible);
 
     void pdfPrintingFinished(const QString &filePath, bool success);
+    void pdfPagePrinted(const QString &filePath, int pageIndex, int pageCount, const QByteArray &pageData);
+    void frameCaptured(const QImage &frame);
 
 protected:
     virtual QWebEnginePage *createWindow(WebWindowType type);
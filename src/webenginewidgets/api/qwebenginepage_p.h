@@ -58,6 +58,9 @@
 #include "qwebenginescriptcollection.h"
 #include "web_contents_adapter_client.h"
 #include <QtCore/qcompilerdetection.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qpointer.h>
 
 namespace QtWebEngineCore {
 class RenderWidgetHostViewQtDelegate;
@@ -115,11 +118,16 @@ public:
     virtual void runFileChooser(QSharedPointer<QtWebEngineCore::FilePickerController>) Q_DECL_OVERRIDE;
     virtual void showColorDialog(QSharedPointer<QtWebEngineCore::ColorChooserController>) Q_DECL_OVERRIDE;
     virtual void didRunJavaScript(quint64 requestId, const QVariant& result) Q_DECL_OVERRIDE;
+    virtual void didRunJavaScriptAsJson(quint64 requestId, const QJsonValue &result) Q_DECL_OVERRIDE;
     virtual void didFetchDocumentMarkup(quint64 requestId, const QString& result) Q_DECL_OVERRIDE;
     virtual void didFetchDocumentInnerText(quint64 requestId, const QString& result) Q_DECL_OVERRIDE;
+    virtual void didFetchDocumentChunk(quint64 requestId, const QString &chunk, bool last) Q_DECL_OVERRIDE;
     virtual void didFindText(quint64 requestId, int matchCount) Q_DECL_OVERRIDE;
     virtual void didPrintPage(quint64 requestId, const QByteArray &result) Q_DECL_OVERRIDE;
     virtual void didPrintPageToPdf(const QString &filePath, bool success) Q_DECL_OVERRIDE;
+    virtual void didPrintPdfPage(const QString &filePath, int pageIndex, int pageCount, const QByteArray &pageData) Q_DECL_OVERRIDE;
+    virtual void didGrabContents(quint64 requestId, const QImage &result) Q_DECL_OVERRIDE;
+    virtual void didCaptureFrame(const QImage &frame) Q_DECL_OVERRIDE;
     virtual void passOnFocus(bool reverse) Q_DECL_OVERRIDE;
     virtual void javaScriptConsoleMessage(JavaScriptConsoleMessageLevel level, const QString& message, int lineNumber, const QString& sourceID) Q_DECL_OVERRIDE;
     virtual void authenticationRequired(QSharedPointer<QtWebEngineCore::AuthenticationDialogController>) Q_DECL_OVERRIDE;
@@ -159,6 +167,7 @@ public:
     void recreateFromSerializedHistory(QDataStream &input);
 
     void setFullScreenMode(bool);
+    bool reportsPdfPages() const;
 
     QSharedPointer<QtWebEngineCore::WebContentsAdapter> adapter;
     QWebEngineHistory *history;
@@ -178,6 +187,8 @@ public:
     bool m_navigationActionTriggered;
 
     mutable QtWebEngineCore::CallbackDirectory m_callbacks;
+    // Devices that toHtml() and toPlainText() are writing to, reset when a write fails.
+    mutable QHash<quint64, QPointer<QIODevice> > m_documentDevices;
     mutable QAction *actions[QWebEnginePage::WebActionCount];
 #if defined(ENABLE_PRINTING)
     QPrinter *currentPrinter;
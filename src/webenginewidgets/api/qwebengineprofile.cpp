@@ -476,6 +476,41 @@ void QWebEngineProfile::setHttpCacheMaximumSize(int maxSize)
     d->browserContext()->setHttpCacheMaxSize(maxSize);
 }
 
+/*!
+    \since 5.10
+
+    Returns the number of render processes the profile keeps launched ahead of time.
+
+    \sa setSpareRendererCount()
+*/
+int QWebEngineProfile::spareRendererCount() const
+{
+    const Q_D(QWebEngineProfile);
+    return d->browserContext()->spareRendererCount();
+}
+
+/*!
+    \since 5.10
+
+    Sets the number of render processes the profile keeps launched ahead of time to \a count.
+
+    Pages created for this profile then start with a renderer that has already been launched
+    and has received the user scripts of the profile, instead of waiting for a new one, which
+    makes opening new pages faster. The spare processes are only launched once the profile has
+    started its first render process. They are shut down after some minutes without use, except
+    for one that is kept as long as the profile has pages.
+
+    The default is \c 0, or the value of the \c QTWEBENGINE_SPARE_RENDERER_PROCESSES
+    environment variable. It has no effect when renderers run in the browser process.
+
+    \sa spareRendererCount()
+*/
+void QWebEngineProfile::setSpareRendererCount(int count)
+{
+    Q_D(QWebEngineProfile);
+    d->browserContext()->setSpareRendererCount(count);
+}
+
 /*!
     Returns the cookie store for this profile.
 
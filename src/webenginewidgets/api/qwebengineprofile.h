@@ -128,6 +128,9 @@ public:
     void setSpellCheckEnabled(bool enabled);
     bool isSpellCheckEnabled() const;
 
+    int spareRendererCount() const;
+    void setSpareRendererCount(int count);
+
     static QWebEngineProfile *defaultProfile();
 
 Q_SIGNALS:
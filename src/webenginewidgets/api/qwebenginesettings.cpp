@@ -97,6 +97,12 @@ static WebEngineSettings::Attribute toWebEngineAttribute(QWebEngineSettings::Web
         return WebEngineSettings::AllowRunningInsecureContent;
     case QWebEngineSettings::AllowGeolocationOnInsecureOrigins:
         return WebEngineSettings::AllowGeolocationOnInsecureOrigins;
+    case QWebEngineSettings::WebChannelMessageBatching:
+        return WebEngineSettings::WebChannelMessageBatching;
+    case QWebEngineSettings::PipelinedTextureFetchEnabled:
+        return WebEngineSettings::PipelinedTextureFetchEnabled;
+    case QWebEngineSettings::WebChannelObjectMessages:
+        return WebEngineSettings::WebChannelObjectMessages;
 
     default:
         return WebEngineSettings::UnsupportedInCoreSettings;
@@ -191,6 +197,18 @@ QString QWebEngineSettings::defaultTextEncoding() const
     return d->defaultTextEncoding();
 }
 
+void QWebEngineSettings::setWebChannelBatchInterval(int msecs)
+{
+    Q_D(QWebEngineSettings);
+    d->setWebChannelBatchInterval(msecs);
+}
+
+int QWebEngineSettings::webChannelBatchInterval() const
+{
+    Q_D(const QWebEngineSettings);
+    return d->webChannelBatchInterval();
+}
+
 void QWebEngineSettings::setAttribute(QWebEngineSettings::WebAttribute attr, bool on)
 {
     Q_D(QWebEngineSettings);
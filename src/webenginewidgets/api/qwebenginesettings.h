@@ -89,7 +89,10 @@ public:
         FocusOnNavigationEnabled,
         PrintElementBackgrounds,
         AllowRunningInsecureContent,
-        AllowGeolocationOnInsecureOrigins
+        AllowGeolocationOnInsecureOrigins,
+        WebChannelMessageBatching,
+        PipelinedTextureFetchEnabled,
+        WebChannelObjectMessages
     };
 
     enum FontSize {
@@ -119,6 +122,9 @@ public:
     void setDefaultTextEncoding(const QString &encoding);
     QString defaultTextEncoding() const;
 
+    void setWebChannelBatchInterval(int msecs);
+    int webChannelBatchInterval() const;
+
 private:
     Q_DISABLE_COPY(QWebEngineSettings)
     typedef ::QtWebEngineCore::WebEngineSettings QWebEngineSettingsPrivate;
@@ -45,10 +45,12 @@
 #include <QLayout>
 #include <QMouseEvent>
 #include <QOpenGLContext>
+#include <QQuickItemGrabResult>
 #include <QResizeEvent>
 #include <QSGAbstractRenderer>
 #include <QSGNode>
 #include <QWindow>
+#include <private/qquickshadereffectsource_p.h>
 #include <private/qquickwindow_p.h>
 
 #if (QT_VERSION < QT_VERSION_CHECK(5, 8, 0))
@@ -359,6 +361,31 @@ void RenderWidgetHostViewQtDelegateWidget::setClearColor(const QColor &color)
     update();
 }
 
+QSharedPointer<QQuickItemGrabResult> RenderWidgetHostViewQtDelegateWidget::grabContents(const QRect &sourceRect, const QSize &targetSize)
+{
+    // The root item renders into the QQuickWidget's offscreen window, so this
+    // works without the widget being exposed.
+    if (sourceRect == QRect(QPoint(), m_rootItem->size().toSize()))
+        return m_rootItem->grabToImage(targetSize);
+
+    // Only render the source rect at the target size, through a shader effect source placed
+    // outside of the visible area of the window. It goes away once the grab is done.
+    QQuickShaderEffectSource *source = new QQuickShaderEffectSource;
+    source->setParentItem(quickWindow()->contentItem());
+    source->setSourceItem(m_rootItem.data());
+    source->setSourceRect(sourceRect);
+    source->setTextureSize(targetSize);
+    source->setSize(targetSize);
+    source->setPosition(QPointF(-targetSize.width(), -targetSize.height()));
+    QSharedPointer<QQuickItemGrabResult> grab = source->grabToImage(targetSize);
+    if (!grab) {
+        delete source;
+        return grab;
+    }
+    QObject::connect(grab.data(), &QQuickItemGrabResult::ready, source, &QObject::deleteLater);
+    return grab;
+}
+
 QVariant RenderWidgetHostViewQtDelegateWidget::inputMethodQuery(Qt::InputMethodQuery query) const
 {
     return m_client->inputMethodQuery(query);
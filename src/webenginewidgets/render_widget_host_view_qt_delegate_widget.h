@@ -77,6 +77,7 @@ public:
     virtual void inputMethodStateChanged(bool editorVisible) Q_DECL_OVERRIDE;
     virtual void setInputMethodHints(Qt::InputMethodHints) Q_DECL_OVERRIDE;
     virtual void setClearColor(const QColor &color) Q_DECL_OVERRIDE;
+    virtual QSharedPointer<QQuickItemGrabResult> grabContents(const QRect &sourceRect, const QSize &targetSize) Q_DECL_OVERRIDE;
 
 protected:
     bool event(QEvent *event) Q_DECL_OVERRIDE;
@@ -52,6 +52,10 @@ private Q_SLOTS:
     void cookieSignals();
     void setAndDeleteCookie();
     void batchCookieTasks();
+    void setAndGetCookieList();
+    void pendingOperationOrder();
+    void coalescedCookieChanges();
+    void cancelledCookieChanges();
 };
 
 tst_QWebEngineCookieStore::tst_QWebEngineCookieStore()
@@ -185,5 +189,187 @@ void tst_QWebEngineCookieStore::batchCookieTasks()
     QTRY_COMPARE(cookieRemovedSpy.count(), 4);
 }
 
+void tst_QWebEngineCookieStore::setAndGetCookieList()
+{
+    QWebEngineView view;
+    QWebEngineCookieStore *client = view.page()->profile()->cookieStore();
+    client->deleteAllCookies();
+
+    QSignalSpy loadSpy(&view, SIGNAL(loadFinished(bool)));
+    QSignalSpy cookieAddedSpy(client, SIGNAL(cookieAdded(const QNetworkCookie &)));
+
+    QList<QNetworkCookie> cookies;
+    cookies += QNetworkCookie::parseCookies(QByteArrayLiteral("khaos=I9GX8CWI; Domain=.example.com; Path=/docs"));
+    cookies += QNetworkCookie::parseCookies(QByteArrayLiteral("Test%20Cookie=foobar; domain=www.example.com; Path=/"));
+    cookies += QNetworkCookie::parseCookies(QByteArrayLiteral("other=value; domain=example.org; Path=/"));
+    cookies += QNetworkCookie::parseCookies(QByteArrayLiteral("secure=value; domain=www.example.com; Path=/; Secure"));
+    QCOMPARE(cookies.size(), 4);
+
+    // the list is set while the cookie store is still pending
+    int acceptedCount = -1;
+    client->setCookies(cookies, [&acceptedCount](int count) { acceptedCount = count; });
+
+    view.load(QUrl("qrc:///resources/content.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QTRY_COMPARE(acceptedCount, 4);
+    QTRY_COMPARE(cookieAddedSpy.count(), 4);
+
+    bool done = false;
+    QList<QNetworkCookie> result;
+    client->getCookies([&](const QList<QNetworkCookie> &list) { result = list; done = true; }, QUrl("http://www.example.com/docs/index.html"));
+    QTRY_VERIFY(done);
+    QCOMPARE(result.size(), 3);
+    for (const QNetworkCookie &cookie : qAsConst(result))
+        QVERIFY(cookie.domain().endsWith(QLatin1String("example.com")));
+
+    // cookies are matched by domain only, neither the path of the khaos cookie nor
+    // the Secure attribute over http exclude them
+    done = false;
+    client->getCookies([&](const QList<QNetworkCookie> &list) { result = list; done = true; }, QUrl("http://www.example.com/"));
+    QTRY_VERIFY(done);
+    QCOMPARE(result.size(), 3);
+
+    // the www.example.com cookies are not set for the parent domain
+    done = false;
+    client->getCookies([&](const QList<QNetworkCookie> &list) { result = list; done = true; }, QUrl("http://example.com/"));
+    QTRY_VERIFY(done);
+    QCOMPARE(result.size(), 1);
+    QCOMPARE(result.first().name(), QByteArrayLiteral("khaos"));
+
+    done = false;
+    client->getCookies([&](const QList<QNetworkCookie> &list) { result = list; done = true; });
+    QTRY_VERIFY(done);
+    QCOMPARE(result.size(), 4);
+
+    done = false;
+    client->getCookies([&](const QList<QNetworkCookie> &list) { result = list; done = true; }, QUrl("http://ample.com/docs/"));
+    QTRY_VERIFY(done);
+    QVERIFY(result.isEmpty());
+
+    // a cookie without a domain has no scope and is dropped, the others in the list are still set
+    QList<QNetworkCookie> mixed;
+    mixed += QNetworkCookie::parseCookies(QByteArrayLiteral("nodomain=value"));
+    mixed += QNetworkCookie::parseCookies(QByteArrayLiteral("scoped=value; domain=example.net; Path=/"));
+    acceptedCount = -1;
+    client->setCookies(mixed, [&acceptedCount](int count) { acceptedCount = count; });
+    QTRY_COMPARE(acceptedCount, 1);
+    done = false;
+    client->getCookies([&](const QList<QNetworkCookie> &list) { result = list; done = true; });
+    QTRY_VERIFY(done);
+    QCOMPARE(result.size(), 5);
+    for (const QNetworkCookie &cookie : qAsConst(result))
+        QVERIFY(cookie.name() != QByteArrayLiteral("nodomain"));
+}
+
+void tst_QWebEngineCookieStore::pendingOperationOrder()
+{
+    QWebEngineProfile profile;
+    QWebEnginePage page(&profile);
+    QWebEngineCookieStore *client = profile.cookieStore();
+
+    QNetworkCookie cookie1(QNetworkCookie::parseCookies(QByteArrayLiteral("first=1; Domain=.example.com; Path=/")).first());
+    QNetworkCookie cookie2(QNetworkCookie::parseCookies(QByteArrayLiteral("second=2; Domain=.example.com; Path=/")).first());
+
+    // all of these are queued until the cookie store is available and must run in this order
+    client->setCookie(cookie1);
+    client->deleteAllCookies();
+    int acceptedCount = -1;
+    client->setCookies(QList<QNetworkCookie>() << cookie2, [&acceptedCount](int count) { acceptedCount = count; });
+    bool done = false;
+    QList<QNetworkCookie> result;
+    client->getCookies([&](const QList<QNetworkCookie> &list) { result = list; done = true; });
+
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    page.load(QUrl("qrc:///resources/content.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QTRY_COMPARE(acceptedCount, 1);
+    QTRY_VERIFY(done);
+    QCOMPARE(result.size(), 1);
+    QCOMPARE(result.first().name(), QByteArrayLiteral("second"));
+}
+
+void tst_QWebEngineCookieStore::coalescedCookieChanges()
+{
+    QWebEngineView view;
+    QWebEngineCookieStore *client = view.page()->profile()->cookieStore();
+    client->deleteAllCookies();
+    client->setCookieChangeFilter(QStringList() << QStringLiteral("example.com"));
+
+    QSignalSpy loadSpy(&view, SIGNAL(loadFinished(bool)));
+    QSignalSpy cookieAddedSpy(client, SIGNAL(cookieAdded(const QNetworkCookie &)));
+    QSignalSpy cookiesChangedSpy(client, SIGNAL(cookiesChanged(const QList<QNetworkCookie> &, const QList<QNetworkCookie> &)));
+
+    view.load(QUrl("qrc:///resources/content.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+
+    QList<QNetworkCookie> cookies;
+    cookies += QNetworkCookie::parseCookies(QByteArrayLiteral("first=1; Domain=.example.com; Path=/"));
+    cookies += QNetworkCookie::parseCookies(QByteArrayLiteral("first=2; Domain=.example.com; Path=/"));
+    cookies += QNetworkCookie::parseCookies(QByteArrayLiteral("second=1; domain=www.example.com; Path=/"));
+    cookies += QNetworkCookie::parseCookies(QByteArrayLiteral("filtered=1; domain=example.org; Path=/"));
+
+    int acceptedCount = -1;
+    client->setCookies(cookies, [&acceptedCount](int count) { acceptedCount = count; });
+    QTRY_COMPARE(acceptedCount, 4);
+
+    // changes are delivered in batches, and example.org is filtered out
+    QTRY_VERIFY(cookieAddedSpy.count() >= 2);
+    QTRY_VERIFY(!cookiesChangedSpy.isEmpty());
+    QList<QNetworkCookie> added;
+    for (const QList<QVariant> &arguments : qAsConst(cookiesChangedSpy))
+        added += arguments.at(0).value<QList<QNetworkCookie>>();
+    QCOMPARE(added.size(), cookieAddedSpy.count());
+    QByteArray lastFirstValue;
+    for (const QNetworkCookie &cookie : qAsConst(added)) {
+        QVERIFY(cookie.domain().endsWith(QLatin1String("example.com")));
+        if (cookie.name() == QByteArrayLiteral("first"))
+            lastFirstValue = cookie.value();
+    }
+    // an overwritten cookie is reported with its latest value
+    QCOMPARE(lastFirstValue, QByteArrayLiteral("2"));
+
+    client->setCookieChangeFilter(QStringList());
+}
+
+void tst_QWebEngineCookieStore::cancelledCookieChanges()
+{
+    QWebEngineView view;
+    QWebEngineCookieStore *client = view.page()->profile()->cookieStore();
+    client->deleteAllCookies();
+    client->setCookieChangeFilter(QStringList() << QStringLiteral("example.com"));
+
+    QSignalSpy loadSpy(&view, SIGNAL(loadFinished(bool)));
+    view.load(QUrl("qrc:///resources/content.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+
+    const QUrl origin(QStringLiteral("http://www.example.com"));
+    const QNetworkCookie kept = QNetworkCookie::parseCookies(QByteArrayLiteral("kept=1; Domain=.example.com; Path=/")).first();
+    const QNetworkCookie transient = QNetworkCookie::parseCookies(QByteArrayLiteral("transient=1; Domain=.example.com; Path=/")).first();
+    const QNetworkCookie marker = QNetworkCookie::parseCookies(QByteArrayLiteral("marker=1; Domain=.example.com; Path=/")).first();
+
+    QSignalSpy cookieAddedSpy(client, SIGNAL(cookieAdded(const QNetworkCookie &)));
+    client->setCookie(kept, origin);
+    QTRY_COMPARE(cookieAddedSpy.count(), 1);
+
+    QStringList changes;
+    connect(client, &QWebEngineCookieStore::cookieAdded, [&changes](const QNetworkCookie &cookie) {
+        changes.append(QLatin1Char('+') + QString::fromLatin1(cookie.name()));
+    });
+    connect(client, &QWebEngineCookieStore::cookieRemoved, [&changes](const QNetworkCookie &cookie) {
+        changes.append(QLatin1Char('-') + QString::fromLatin1(cookie.name()));
+    });
+
+    // A cookie added and removed within the same interval is never reported, and the
+    // remaining changes are reported in the order they were made.
+    client->setCookie(transient, origin);
+    client->deleteCookie(transient, origin);
+    client->deleteCookie(kept, origin);
+    client->setCookie(marker, origin);
+    QTRY_VERIFY(changes.contains(QStringLiteral("+marker")));
+    QCOMPARE(changes, QStringList() << QStringLiteral("-kept") << QStringLiteral("+marker"));
+
+    client->setCookieChangeFilter(QStringList());
+}
+
 QTEST_MAIN(tst_QWebEngineCookieStore)
 #include "tst_qwebenginecookiestore.moc"
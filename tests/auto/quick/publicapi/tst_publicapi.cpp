@@ -203,6 +203,9 @@ static QStringList expectedAPI = QStringList()
     << "QQuickWebEngineView.reload() --> void"
     << "QQuickWebEngineView.reloadAndBypassCache() --> void"
     << "QQuickWebEngineView.stop() --> void"
+    << "QQuickWebEngineView.grabContents(QJSValue,QRect,QSize) --> void"
+    << "QQuickWebEngineView.grabContents(QJSValue,QRect) --> void"
+    << "QQuickWebEngineView.grabContents(QJSValue) --> void"
     << "QQuickWebEngineView.findText(QString,FindFlags,QJSValue) --> void"
     << "QQuickWebEngineView.findText(QString,FindFlags) --> void"
     << "QQuickWebEngineView.findText(QString) --> void"
@@ -351,8 +354,13 @@ static QStringList expectedAPI = QStringList()
     << "QQuickWebEngineView.audioMutedChanged(bool) --> void"
     << "QQuickWebEngineView.recentlyAudibleChanged(bool) --> void"
     << "QQuickWebEngineView.webChannelWorldChanged(uint) --> void"
+    << "QQuickWebEngineView.frameTimingEnabled --> bool"
+    << "QQuickWebEngineView.frameTimingEnabledChanged(bool) --> void"
+    << "QQuickWebEngineView.frameTimings() --> QVariantList"
     << "QQuickWebEngineView.runJavaScript(QString,uint,QJSValue) --> void"
     << "QQuickWebEngineView.runJavaScript(QString,uint) --> void"
+    << "QQuickWebEngineView.runJavaScriptBatch(QStringList,QJSValue) --> void"
+    << "QQuickWebEngineView.runJavaScriptBatch(QStringList,uint,QString,QJSValue) --> void"
     << "QQuickWebEngineView.printToPdf(QString,PrintedPageSizeId,PrintedPageOrientation) --> void"
     << "QQuickWebEngineView.printToPdf(QString,PrintedPageSizeId) --> void"
     << "QQuickWebEngineView.printToPdf(QString) --> void"
@@ -459,6 +467,8 @@ static QStringList expectedAPI = QStringList()
     << "QQuickWebEngineProfile.spellCheckEnabled --> bool"
     << "QQuickWebEngineProfile.spellCheckLanguageChanged() --> void"
     << "QQuickWebEngineProfile.spellCheckEnabledChanged() --> void"
+    << "QQuickWebEngineProfile.spareRendererCount --> int"
+    << "QQuickWebEngineProfile.spareRendererCountChanged() --> void"
     << "QQuickWebEngineProfile.clearHttpCache() --> void"
     << "QQuickWebEngineScript.Deferred --> InjectionPoint"
     << "QQuickWebEngineScript.DocumentReady --> InjectionPoint"
@@ -525,6 +535,14 @@ static QStringList expectedAPI = QStringList()
     << "QQuickWebEngineSettings.touchIconsEnabledChanged() --> void"
     << "QQuickWebEngineSettings.focusOnNavigationEnabled --> bool"
     << "QQuickWebEngineSettings.focusOnNavigationEnabledChanged() --> void"
+    << "QQuickWebEngineSettings.webChannelMessageBatching --> bool"
+    << "QQuickWebEngineSettings.webChannelMessageBatchingChanged() --> void"
+    << "QQuickWebEngineSettings.webChannelBatchInterval --> int"
+    << "QQuickWebEngineSettings.webChannelBatchIntervalChanged() --> void"
+    << "QQuickWebEngineSettings.pipelinedTextureFetchEnabled --> bool"
+    << "QQuickWebEngineSettings.pipelinedTextureFetchEnabledChanged() --> void"
+    << "QQuickWebEngineSettings.webChannelObjectMessages --> bool"
+    << "QQuickWebEngineSettings.webChannelObjectMessagesChanged() --> void"
     << "QQuickWebEngineFullScreenRequest.origin --> QUrl"
     << "QQuickWebEngineFullScreenRequest.toggleOn --> bool"
     << "QQuickWebEngineFullScreenRequest.accept() --> void"
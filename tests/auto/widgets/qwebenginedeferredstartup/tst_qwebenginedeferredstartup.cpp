@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include "../util.h"
+
+#include <QLoggingCategory>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <qwebengineview.h>
+
+class tst_QWebEngineDeferredStartup : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void deferredStartup();
+};
+
+void tst_QWebEngineDeferredStartup::deferredStartup()
+{
+    // The deferred startup mode and the startup logging category are read once,
+    // when the WebEngineContext is created, so they have to be set up before
+    // the application instantiates the first page.
+    qputenv("QTWEBENGINE_DEFERRED_STARTUP", "1");
+    qputenv("QTWEBENGINE_REMOTE_DEBUGGING", "127.0.0.1:35491");
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.webengine.startup.debug=true"));
+
+    int argc = 1;
+    char *argv[] = { const_cast<char*>("tst_QWebEngineDeferredStartup") };
+    QApplication app(argc, argv);
+
+    QTest::ignoreMessage(QtDebugMsg, QRegularExpression(QStringLiteral("^initial startup: ")));
+    QTest::ignoreMessage(QtDebugMsg, QRegularExpression(QStringLiteral("^deferred startup: .*devtools server")));
+
+    QWebEngineView view;
+    QSignalSpy loadSpy(&view, &QWebEngineView::loadFinished);
+    view.setHtml(QStringLiteral("<html><body>deferred</body></html>"));
+    view.show();
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QVERIFY(loadSpy.takeFirst().value(0).toBool());
+
+    // The DevTools server is only started from the message loop, but it must
+    // be up once the first page has been loaded.
+    QNetworkAccessManager network;
+    QScopedPointer<QNetworkReply> reply(network.get(QNetworkRequest(QUrl(QStringLiteral("http://127.0.0.1:35491/json/version")))));
+    QSignalSpy finishedSpy(reply.data(), &QNetworkReply::finished);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QVERIFY(reply->readAll().contains("Browser"));
+}
+
+QTEST_APPLESS_MAIN(tst_QWebEngineDeferredStartup)
+#include "tst_qwebenginedeferredstartup.moc"
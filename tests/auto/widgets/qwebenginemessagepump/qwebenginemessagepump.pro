@@ -0,0 +1 @@
+include(../tests.pri)
@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include "../util.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QTimer>
+#include <qwebenginepage.h>
+
+// Counts the events that wake up the message pump of the browser's UI thread.
+class WakeUpCounter : public QObject
+{
+public:
+    WakeUpCounter() : wakeUps(0) { }
+
+    bool eventFilter(QObject *watched, QEvent *event) Q_DECL_OVERRIDE
+    {
+        if (event->type() == QEvent::User && watched->objectName() == QLatin1String("QtWebEngineMessagePump"))
+            ++wakeUps;
+        return false;
+    }
+
+    int wakeUps;
+};
+
+class tst_QWebEngineMessagePump : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void defaultWorkBudget();
+};
+
+void tst_QWebEngineMessagePump::defaultWorkBudget()
+{
+    // The work budget is read when the browser's message pump is created, before
+    // the application instantiates the first page.
+    qunsetenv("QTWEBENGINE_MESSAGE_PUMP_BUDGET");
+
+    int argc = 1;
+    char *argv[] = { const_cast<char*>("tst_QWebEngineMessagePump") };
+    QApplication app(argc, argv);
+
+    QWebEnginePage page;
+    QSignalSpy loadSpy(&page, &QWebEnginePage::loadFinished);
+    page.setHtml(QStringLiteral("<html><body>pump</body></html>"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+
+    // Every result is a task of its own on the UI thread, and takes a millisecond to handle.
+    const int scriptCount = 200;
+    int results = 0;
+    for (int i = 0; i < scriptCount; ++i) {
+        page.runJavaScript(QStringLiteral("%1 + 1").arg(i), [&](const QVariant &) {
+            ++results;
+            QElapsedTimer timer;
+            timer.start();
+            while (timer.nsecsElapsed() < 1000000) { }
+        });
+    }
+
+    // Block the UI thread, so that the results pile up in its task queue.
+    QTest::qSleep(2000);
+    QCOMPARE(results, 0);
+
+    WakeUpCounter counter;
+    app.installEventFilter(&counter);
+    int ticksWhilePending = 0;
+    QTimer ticker;
+    ticker.setInterval(0);
+    QObject::connect(&ticker, &QTimer::timeout, [&]() {
+        if (results > 0 && results < scriptCount)
+            ++ticksWhilePending;
+    });
+    ticker.start();
+
+    QTRY_COMPARE(results, scriptCount);
+    ticker.stop();
+    app.removeEventFilter(&counter);
+
+    // The queued tasks are run in slices of the 8 ms budget: a single wake-up runs many
+    // of them, instead of one task per wake-up ...
+    QVERIFY2(counter.wakeUps < scriptCount / 4, qPrintable(QString::number(counter.wakeUps)));
+    // ... but the pump still returns to the Qt event loop in between.
+    QVERIFY(ticksWhilePending > 0);
+}
+
+QTEST_APPLESS_MAIN(tst_QWebEngineMessagePump)
+#include "tst_qwebenginemessagepump.moc"
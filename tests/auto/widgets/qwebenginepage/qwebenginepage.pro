@@ -1,4 +1,5 @@
 include(../tests.pri)
 QT *= core-private
+qtHaveModule(printsupport): QT += printsupport
 
 contains(WEBENGINE_CONFIG, use_pdf): DEFINES+=QWEBENGINEPAGE_PDFPRINTINGENABLED
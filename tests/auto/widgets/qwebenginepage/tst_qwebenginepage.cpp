@@ -52,6 +52,9 @@
 #include <qwebenginesettings.h>
 #include <qwebengineview.h>
 #include <qimagewriter.h>
+#if defined(QT_PRINTSUPPORT_LIB)
+#include <QPrinter>
+#endif
 
 static void removeRecursive(const QString& dirname)
 {
@@ -162,6 +165,10 @@ private Q_SLOTS:
 #endif
 
     void runJavaScript();
+    void runJavaScriptAsJson();
+    void runJavaScriptBatch();
+    void runJavaScriptLargeResult_data();
+    void runJavaScriptLargeResult();
     void fullScreenRequested();
 
 
@@ -203,11 +210,20 @@ private Q_SLOTS:
     void restoreHistory();
     void toPlainTextLoadFinishedRace_data();
     void toPlainTextLoadFinishedRace();
+    void toPlainTextChunked();
+    void toHtmlDevice();
     void setZoomFactor();
     void mouseButtonTranslation();
     void mouseMovementProperties();
 
     void printToPdf();
+    void printToPdfQueue();
+    void printPageCache();
+    void grabToImage();
+    void partialRepaint();
+    void frameCapture();
+    void frameTiming_data();
+    void frameTiming();
     void viewSource();
     void viewSourceURL_data();
     void viewSourceURL();
@@ -3495,6 +3511,124 @@ void tst_QWebEnginePage::runJavaScript()
     QVERIFY(watcher.wait());
 }
 
+static QJsonValue evaluateJavaScriptAsJsonSync(QWebEnginePage *page, const QString &script, quint32 worldId = QWebEngineScript::MainWorld)
+{
+    CallbackSpy<QJsonValue> spy;
+    page->runJavaScriptAsJson(script, worldId, spy.ref());
+    return spy.waitForResult();
+}
+
+void tst_QWebEnginePage::runJavaScriptAsJson()
+{
+    QWebEnginePage page;
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "false"), QJsonValue(false));
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "2.5"), QJsonValue(2.5));
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "\"Test\""), QJsonValue(QStringLiteral("Test")));
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "null"), QJsonValue());
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "undefined"), QJsonValue());
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "[]"), QJsonValue(QJsonArray()));
+
+    const QJsonObject object = evaluateJavaScriptAsJsonSync(&page, "var el = {test: 2, list: [1, 'a'], f: function() {}}; el").toObject();
+    QCOMPARE(object.size(), 2);
+    QCOMPARE(object.value(QStringLiteral("test")), QJsonValue(2));
+    QCOMPARE(object.value(QStringLiteral("list")).toArray(), QJsonArray() << 1 << QStringLiteral("a"));
+
+    // Isolated worlds don't see the variables of the main world.
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "typeof el", QWebEngineScript::ApplicationWorld), QJsonValue(QStringLiteral("undefined")));
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "document.body.tagName", QWebEngineScript::ApplicationWorld), QJsonValue(QStringLiteral("BODY")));
+
+    // References back to an enclosing object become null, shared ones are kept.
+    const QJsonObject cyclic = evaluateJavaScriptAsJsonSync(&page, "var shared = {x: 1}; var o = {a: shared, b: shared, n: 3}; "
+                                                                   "o.self = o; o.list = [o, shared]; o").toObject();
+    QCOMPARE(cyclic.value(QStringLiteral("n")), QJsonValue(3));
+    QCOMPARE(cyclic.value(QStringLiteral("self")), QJsonValue());
+    QCOMPARE(cyclic.value(QStringLiteral("a")).toObject().value(QStringLiteral("x")), QJsonValue(1));
+    QCOMPARE(cyclic.value(QStringLiteral("b")).toObject().value(QStringLiteral("x")), QJsonValue(1));
+    QCOMPARE(cyclic.value(QStringLiteral("list")).toArray().at(0), QJsonValue());
+    QCOMPARE(cyclic.value(QStringLiteral("list")).toArray().at(1).toObject().value(QStringLiteral("x")), QJsonValue(1));
+
+    // Objects with several references to themselves must not blow up the conversion.
+    QVERIFY(evaluateJavaScriptAsJsonSync(&page, "window").isObject());
+    QVERIFY(evaluateJavaScriptAsJsonSync(&page, "var deep = {}; var d = deep; for (var i = 0; i < 1000; ++i) d = d.next = {}; deep").isObject());
+
+    // Throwing getters and proxy traps only lose their own value.
+    const QJsonObject throwing = evaluateJavaScriptAsJsonSync(&page, "({get x() { throw 1; }, y: 2})").toObject();
+    QCOMPARE(throwing.value(QStringLiteral("x")), QJsonValue());
+    QCOMPARE(throwing.value(QStringLiteral("y")), QJsonValue(2));
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "[1, new Proxy({}, {ownKeys: function() { throw 1; }}), 3]").toArray(),
+             QJsonArray() << 1 << QJsonValue() << 3);
+    QCOMPARE(evaluateJavaScriptSync(&page, "({get x() { throw 1; }, y: 2})").toMap().value(QStringLiteral("y")).toInt(), 2);
+    // The renderer is still alive.
+    QCOMPARE(evaluateJavaScriptAsJsonSync(&page, "1 + 1"), QJsonValue(2));
+}
+
+void tst_QWebEnginePage::runJavaScriptBatch()
+{
+    QWebEnginePage page;
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    page.setHtml(QStringLiteral("<html><body><iframe name='child' srcdoc='<html><title>child</title></html>'></iframe></body></html>"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QTRY_COMPARE(evaluateJavaScriptSync(&page, "window.frames[0].document.title").toString(), QStringLiteral("child"));
+
+    // Scripts run in order and see the side effects of the previous ones.
+    CallbackSpy<QJsonValue> spy;
+    page.runJavaScriptBatch(QStringList() << "var counter = 1; counter" << "++counter" << "undefined" << "[counter]", spy.ref());
+    QCOMPARE(spy.waitForResult().toArray(), QJsonArray() << 1 << 2 << QJsonValue() << (QJsonArray() << 2));
+
+    CallbackSpy<QJsonValue> frameSpy;
+    page.runJavaScriptBatch(QStringList() << "document.title" << "typeof counter", QWebEngineScript::MainWorld,
+                            QStringLiteral("child"), frameSpy.ref());
+    QCOMPARE(frameSpy.waitForResult().toArray(), QJsonArray() << QStringLiteral("child") << QStringLiteral("undefined"));
+
+    CallbackSpy<QJsonValue> isolatedSpy;
+    page.runJavaScriptBatch(QStringList() << "typeof counter" << "document.title", QWebEngineScript::ApplicationWorld,
+                            QStringLiteral("child"), isolatedSpy.ref());
+    QCOMPARE(isolatedSpy.waitForResult().toArray(), QJsonArray() << QStringLiteral("undefined") << QStringLiteral("child"));
+
+    CallbackSpy<QJsonValue> missingSpy;
+    page.runJavaScriptBatch(QStringList() << "1" << "2", QWebEngineScript::MainWorld, QStringLiteral("missing"), missingSpy.ref());
+    QCOMPARE(missingSpy.waitForResult().toArray(), QJsonArray() << QJsonValue() << QJsonValue());
+}
+
+void tst_QWebEnginePage::runJavaScriptLargeResult_data()
+{
+    QTest::addColumn<bool>("asJson");
+    QTest::newRow("variant") << false;
+    QTest::newRow("json") << true;
+}
+
+void tst_QWebEnginePage::runJavaScriptLargeResult()
+{
+    QFETCH(bool, asJson);
+    const int count = 1000;
+
+    QWebEnginePage page;
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    evaluateJavaScriptSync(&page, QStringLiteral("var rows = []; for (var i = 0; i < %1; ++i) "
+                                                 "rows.push({id: i, name: 'row ' + i, values: [i, i * 2, i * 3]}); "
+                                                 "true").arg(count));
+
+    int size = 0;
+    QString lastName;
+    if (asJson) {
+        const QJsonArray rows = evaluateJavaScriptAsJsonSync(&page, QStringLiteral("rows")).toArray();
+        size = rows.size();
+        lastName = rows.last().toObject().value(QStringLiteral("name")).toString();
+    } else {
+        const QVariantList rows = evaluateJavaScriptSync(&page, QStringLiteral("rows")).toList();
+        size = rows.size();
+        lastName = rows.last().toMap().value(QStringLiteral("name")).toString();
+    }
+    QCOMPARE(size, count);
+    QCOMPARE(lastName, QStringLiteral("row %1").arg(count - 1));
+}
+
 void tst_QWebEnginePage::fullScreenRequested()
 {
     JavaScriptCallbackWatcher watcher;
@@ -4655,6 +4789,74 @@ void tst_QWebEnginePage::toPlainTextLoadFinishedRace()
     QVERIFY(spy.count() == 3);
 }
 
+void tst_QWebEnginePage::toPlainTextChunked()
+{
+    QStringList chunks;
+    bool finished = false;
+    QWebEnginePage page;
+    QSignalSpy spy(&page, SIGNAL(loadFinished(bool)));
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QTRY_COMPARE(spy.count(), 1);
+    // Large enough to be split, with surrogate pairs that must not be cut in half.
+    evaluateJavaScriptSync(&page, "document.body.textContent = 'abc\\uD83D\\uDE00'.repeat(100000)");
+    const QString text = QString::fromUtf8("abc\xF0\x9F\x98\x80").repeated(100000);
+
+    page.toPlainTextChunked([&](const QString &chunk) {
+        if (chunk.isEmpty())
+            finished = true;
+        else
+            chunks.append(chunk);
+    });
+    QTRY_VERIFY(finished);
+    QVERIFY(chunks.size() > 1);
+    for (const QString &chunk : qAsConst(chunks))
+        QVERIFY(!chunk.at(chunk.size() - 1).isHighSurrogate());
+    QCOMPARE(chunks.join(QString()), text);
+
+    chunks.clear();
+    finished = false;
+    page.toPlainTextChunked([&](const QString &chunk) {
+        if (chunk.isEmpty())
+            finished = true;
+        else
+            chunks.append(chunk);
+    }, 1000);
+    QTRY_VERIFY(finished);
+    QCOMPARE(chunks.size(), 1);
+    QVERIFY(text.startsWith(chunks.first()));
+    QVERIFY(chunks.first().size() >= 999 && chunks.first().size() <= 1000);
+}
+
+void tst_QWebEnginePage::toHtmlDevice()
+{
+    QBuffer buffer;
+    int result = -1;
+    QWebEnginePage page;
+    QSignalSpy spy(&page, SIGNAL(loadFinished(bool)));
+    page.setHtml(QStringLiteral("<html><body><p>Test</p></body></html>"));
+    QTRY_COMPARE(spy.count(), 1);
+
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    page.toHtml(&buffer, [&](bool success) { result = success; });
+    QTRY_COMPARE(result, 1);
+    QCOMPARE(QString::fromUtf8(buffer.data()), toHtmlSync(&page));
+
+    // Writing stops at the size cap.
+    buffer.close();
+    buffer.setData(QByteArray());
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    result = -1;
+    page.toHtml(&buffer, [&](bool success) { result = success; }, 6);
+    QTRY_COMPARE(result, 1);
+    QCOMPARE(buffer.data(), QByteArray("<html>"));
+
+    // A device that can't be written to fails the request.
+    buffer.close();
+    result = -1;
+    page.toHtml(&buffer, [&](bool success) { result = success; });
+    QTRY_COMPARE(result, 0);
+}
+
 void tst_QWebEnginePage::setZoomFactor()
 {
     QWebEnginePage page;
@@ -4722,6 +4924,341 @@ void tst_QWebEnginePage::printToPdf()
 #endif
 }
 
+void tst_QWebEnginePage::printToPdfQueue()
+{
+#if !defined(QWEBENGINEPAGE_PDFPRINTINGENABLED)
+    QSKIP("QWEBENGINEPAGE_PDFPRINTINGENABLED");
+#else
+    QWebEnginePage page;
+    QSignalSpy spy(&page, SIGNAL(loadFinished(bool)));
+    page.load(QUrl("qrc:///resources/basic_printing_page.html"));
+    QTRY_VERIFY(spy.count() == 1);
+    QPageLayout layout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF(0.0, 0.0, 0.0, 0.0));
+
+    QTemporaryDir tempDir(QDir::tempPath() + "/tst_qwebengineview-XXXXXX");
+    QVERIFY(tempDir.isValid());
+    QString path = tempDir.path() + "/print_queue.pdf";
+
+    // Requests made while another one is running are queued instead of failing.
+    QSignalSpy pageSpy(&page, SIGNAL(pdfPagePrinted(const QString&, int, int, const QByteArray&)));
+    QSignalSpy fileSpy(&page, SIGNAL(pdfPrintingFinished(const QString&, bool)));
+    CallbackSpy<QByteArray> firstSpy;
+    page.printToPdf(firstSpy.ref(), layout);
+    page.printToPdf(path, layout);
+    QVERIFY(firstSpy.waitForResult().length() > 0);
+    QTRY_COMPARE(fileSpy.count(), 1);
+    QVERIFY(fileSpy.takeFirst().value(1).toBool());
+
+    // Pages are reported per request, in the order the requests were made.
+    QVERIFY(pageSpy.count() >= 2);
+    QVERIFY(pageSpy.first().at(0).toString().isEmpty());
+    QCOMPARE(pageSpy.last().at(0).toString(), path);
+    for (const QList<QVariant> &arguments : qAsConst(pageSpy)) {
+        QVERIFY(arguments.at(1).toInt() < arguments.at(2).toInt());
+        QVERIFY(arguments.at(3).toByteArray().startsWith("%PDF"));
+    }
+
+    CallbackSpy<QByteArray> cancelledSpy;
+    CallbackSpy<QByteArray> cancelledQueuedSpy;
+    page.printToPdf(cancelledSpy.ref(), layout);
+    page.printToPdf(cancelledQueuedSpy.ref(), layout);
+    page.cancelPdfPrinting();
+    QCOMPARE(cancelledSpy.waitForResult().length(), 0);
+    QCOMPARE(cancelledQueuedSpy.waitForResult().length(), 0);
+
+    // The page can print again right away, the cancelled document does not hold on to its slot.
+    CallbackSpy<QByteArray> afterCancelSpy;
+    page.printToPdf(afterCancelSpy.ref(), layout);
+    QVERIFY(afterCancelSpy.waitForResult().length() > 0);
+
+    // Navigating to another document cancels the requests of the previous one.
+    CallbackSpy<QByteArray> navigatedAwaySpy;
+    page.printToPdf(navigatedAwaySpy.ref(), layout);
+    page.setHtml("<html><body>Another document</body></html>");
+    QCOMPARE(navigatedAwaySpy.waitForResult().length(), 0);
+    QTRY_COMPARE(spy.count(), 2);
+
+    CallbackSpy<QByteArray> afterNavigationSpy;
+    page.printToPdf(afterNavigationSpy.ref(), layout);
+    QVERIFY(afterNavigationSpy.waitForResult().length() > 0);
+#endif
+}
+
+#if defined(QT_PRINTSUPPORT_LIB)
+static QStringList s_printingMessages;
+
+static void printingMessageHandler(QtMsgType, const QMessageLogContext &context, const QString &message)
+{
+    if (qstrcmp(context.category, "qt.webengine.printing") == 0)
+        s_printingMessages.append(message);
+}
+#endif
+
+void tst_QWebEnginePage::printPageCache()
+{
+#if !defined(QWEBENGINEPAGE_PDFPRINTINGENABLED) || !defined(QT_PRINTSUPPORT_LIB) || defined(QT_NO_PRINTER)
+    QSKIP("QWEBENGINEPAGE_PDFPRINTINGENABLED && QT_PRINTSUPPORT_LIB");
+#else
+    const int pageCount = 10;
+    QString html = QStringLiteral("<html><body>");
+    for (int i = 0; i < pageCount; ++i)
+        html += QStringLiteral("<div style='page-break-before: %1'>Page %2</div>").arg(QLatin1String(i ? "always" : "auto")).arg(i + 1);
+    html += QStringLiteral("</body></html>");
+
+    QWebEnginePage page;
+    QSignalSpy spy(&page, SIGNAL(loadFinished(bool)));
+    page.setHtml(html);
+    QTRY_COMPARE(spy.count(), 1);
+
+    QTemporaryDir tempDir(QDir::tempPath() + "/tst_qwebenginepage-XXXXXX");
+    QVERIFY(tempDir.isValid());
+    QPrinter printer(QPrinter::ScreenResolution);
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(tempDir.path() + "/print_page_cache.pdf");
+
+    // The page cache statistics are logged once the pages are printed.
+    s_printingMessages.clear();
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.webengine.printing.debug=true"));
+    QtMessageHandler previousHandler = qInstallMessageHandler(printingMessageHandler);
+    CallbackSpy<bool> resultSpy;
+    page.print(&printer, resultSpy.ref());
+    const bool printed = resultSpy.waitForResult();
+    qInstallMessageHandler(previousHandler);
+    QLoggingCategory::setFilterRules(QString());
+    QVERIFY(printed);
+
+    QCOMPARE(s_printingMessages.size(), 1);
+    QRegularExpression statsPattern(QStringLiteral("(\\d+) hits, (\\d+) misses, (\\d+) of (\\d+) bytes in (\\d+) pages"));
+    QRegularExpressionMatch match = statsPattern.match(s_printingMessages.first());
+    QVERIFY2(match.hasMatch(), qPrintable(s_printingMessages.first()));
+    const int hits = match.captured(1).toInt();
+    const int misses = match.captured(2).toInt();
+    const qint64 cachedBytes = match.captured(3).toLongLong();
+    const qint64 budget = match.captured(4).toLongLong();
+    const int cachedPages = match.captured(5).toInt();
+
+    // Every page is asked for once, and the pages rendered ahead are taken from the cache.
+    QCOMPARE(hits + misses, pageCount);
+    QVERIFY(hits > 0);
+
+    // The budget holds a few pages at the printer's resolution, older pages are evicted.
+    const QRect pageRect = printer.pageRect();
+    QVERIFY(budget > 0);
+    QVERIFY(budget <= qint64(pageRect.width()) * pageRect.height() * 4 * pageCount / 2);
+    QVERIFY(cachedBytes <= budget);
+    QVERIFY(cachedPages > 0);
+    QVERIFY(cachedPages < pageCount);
+#endif
+}
+
+void tst_QWebEnginePage::grabToImage()
+{
+    QWebEngineView view;
+    QSignalSpy spy(&view, SIGNAL(loadFinished(bool)));
+    view.setHtml(QStringLiteral("<html><body style='margin:0'>"
+                                "<div style='width:100px;height:100px;background-color:#ff0000'></div>"
+                                "<div style='width:100px;height:100px;background-color:#0000ff'></div>"
+                                "</body></html>"));
+    view.resize(300, 300);
+    view.show();
+    QTest::qWaitForWindowExposed(&view);
+    QTRY_COMPARE(spy.count(), 1);
+
+    CallbackSpy<QImage> fullSpy;
+    view.page()->grabToImage(fullSpy.ref());
+    QImage image = fullSpy.waitForResult();
+    QVERIFY(!image.isNull());
+    QCOMPARE(image.size(), view.size());
+
+    CallbackSpy<QImage> scaledSpy;
+    view.page()->grabToImage(scaledSpy.ref(), QRect(0, 100, 100, 100), QSize(20, 20));
+    image = scaledSpy.waitForResult();
+    QCOMPARE(image.size(), QSize(20, 20));
+    QCOMPARE(QColor(image.pixel(10, 10)), QColor(Qt::blue));
+
+    // Only the source rect is scaled up, not the whole view.
+    CallbackSpy<QImage> upscaledSpy;
+    view.page()->grabToImage(upscaledSpy.ref(), QRect(0, 0, 100, 100), QSize(400, 400));
+    image = upscaledSpy.waitForResult();
+    QCOMPARE(image.size(), QSize(400, 400));
+    QCOMPARE(QColor(image.pixel(200, 200)), QColor(Qt::red));
+
+    // Target sizes beyond what a texture can hold are still delivered at the requested size.
+    CallbackSpy<QImage> largeSpy;
+    view.page()->grabToImage(largeSpy.ref(), QRect(0, 100, 100, 10), QSize(6000, 600));
+    image = largeSpy.waitForResult();
+    QCOMPARE(image.size(), QSize(6000, 600));
+    QCOMPARE(QColor(image.pixel(3000, 300)), QColor(Qt::blue));
+}
+
+static QColor grabPixel(QWebEnginePage *page, const QPoint &pos)
+{
+    CallbackSpy<QImage> spy;
+    page->grabToImage(spy.ref(), QRect(pos, QSize(1, 1)));
+    return QColor(spy.waitForResult().pixel(0, 0));
+}
+
+void tst_QWebEnginePage::partialRepaint()
+{
+    QWebEngineView view;
+    QSignalSpy spy(&view, SIGNAL(loadFinished(bool)));
+    view.setHtml(QStringLiteral("<html><body style='margin:0;background-color:#0000ff'>"
+                                "<div id='box' style='position:absolute;left:50px;top:50px;"
+                                "width:10px;height:10px;background-color:#0000ff'></div>"
+                                "</body></html>"));
+    view.resize(300, 300);
+    view.show();
+    QTest::qWaitForWindowExposed(&view);
+    QTRY_COMPARE(spy.count(), 1);
+    QTRY_COMPARE(grabPixel(view.page(), QPoint(55, 55)), QColor(Qt::blue));
+
+    // Only the box is damaged, the rest of the tile it is drawn in has to stay as it was.
+    const QStringList colors = QStringList() << QStringLiteral("#ff0000") << QStringLiteral("#00ff00")
+                                             << QStringLiteral("#0000ff");
+    foreach (const QString &color, colors) {
+        evaluateJavaScriptSync(view.page(), QStringLiteral("document.getElementById('box').style.backgroundColor = '%1'").arg(color));
+        QTRY_COMPARE(grabPixel(view.page(), QPoint(55, 55)), QColor(color));
+        QCOMPARE(grabPixel(view.page(), QPoint(45, 55)), QColor(Qt::blue));
+        QCOMPARE(grabPixel(view.page(), QPoint(65, 55)), QColor(Qt::blue));
+        QCOMPARE(grabPixel(view.page(), QPoint(150, 150)), QColor(Qt::blue));
+    }
+}
+
+void tst_QWebEnginePage::frameCapture()
+{
+    QWebEngineView view;
+    QSignalSpy loadSpy(&view, SIGNAL(loadFinished(bool)));
+    view.setHtml(QStringLiteral("<html><body><div id='box' style='width:100px;height:100px'></div>"
+                                "<script>var n = 0; setInterval(function() {"
+                                "document.getElementById('box').style.backgroundColor = (++n % 2) ? 'red' : 'green';"
+                                "}, 10);</script></body></html>"));
+    view.resize(300, 300);
+    view.show();
+    QTest::qWaitForWindowExposed(&view);
+    QTRY_COMPARE(loadSpy.count(), 1);
+
+    QSignalSpy frameSpy(view.page(), &QWebEnginePage::frameCaptured);
+    const int changesBefore = evaluateJavaScriptSync(view.page(), "n").toInt();
+    view.page()->startFrameCapture(10);
+    QTRY_VERIFY(frameSpy.count() >= 5);
+    // The page changes every 10 ms, the capture rate limits it to 10 frames per second,
+    // so far fewer frames are captured than the page has rendered meanwhile.
+    const int changes = evaluateJavaScriptSync(view.page(), "n").toInt() - changesBefore;
+    QVERIFY2(frameSpy.count() * 3 < changes,
+             qPrintable(QString("%1 frames captured for %2 changes").arg(frameSpy.count()).arg(changes)));
+    QCOMPARE(qvariant_cast<QImage>(frameSpy.first().first()).size(), view.size());
+
+    view.page()->stopFrameCapture();
+    QTest::qWait(100);
+    const int count = frameSpy.count();
+    QTest::qWait(500);
+    QCOMPARE(frameSpy.count(), count);
+}
+
+void tst_QWebEnginePage::frameTiming_data()
+{
+    QTest::addColumn<bool>("pipelinedTextureFetch");
+    QTest::newRow("default") << false;
+    QTest::newRow("pipelinedTextureFetch") << true;
+}
+
+void tst_QWebEnginePage::frameTiming()
+{
+    QFETCH(bool, pipelinedTextureFetch);
+    QWebEngineView view;
+    view.settings()->setAttribute(QWebEngineSettings::PipelinedTextureFetchEnabled, pipelinedTextureFetch);
+    QVERIFY(!view.page()->isFrameTimingEnabled());
+    QVERIFY(view.page()->frameTimingTrace().isEmpty());
+    QVERIFY(view.page()->frameTimings().isEmpty());
+
+    view.page()->setFrameTimingEnabled(true);
+    QVERIFY(view.page()->isFrameTimingEnabled());
+    QSignalSpy loadSpy(&view, SIGNAL(loadFinished(bool)));
+    // The text is rasterized into tiles, so that frames carry textures and not only solid colors.
+    view.setHtml(QStringLiteral("<html><body style='background-color:green'><h1>Frame timing</h1></body></html>"));
+    view.resize(300, 300);
+    view.show();
+    QTest::qWaitForWindowExposed(&view);
+    QTRY_COMPARE(loadSpy.count(), 1);
+
+    // Wait for a frame with textures to make it to the scene graph.
+    QJsonArray events;
+    QTRY_VERIFY([&]() {
+        events = QJsonDocument::fromJson(view.page()->frameTimingTrace()).object().value(QStringLiteral("traceEvents")).toArray();
+        for (const QJsonValue &event : events) {
+            const QJsonObject object = event.toObject();
+            const QJsonObject args = object.value(QStringLiteral("args")).toObject();
+            if (object.value(QStringLiteral("name")).toString() == QLatin1String("CompositorFrame")
+                    && args.value(QStringLiteral("acked")).toBool()
+                    && args.value(QStringLiteral("resourcesImported")).toInt() > 0)
+                return true;
+        }
+        return false;
+    }());
+
+    const QStringList frameKeys = QStringList()
+            << QStringLiteral("frameId") << QStringLiteral("renderPasses") << QStringLiteral("quads")
+            << QStringLiteral("resourcesImported") << QStringLiteral("resourcesReturned")
+            << QStringLiteral("deferredCommits") << QStringLiteral("mailboxesFetched")
+            << QStringLiteral("mailboxFetchLatency") << QStringLiteral("mailboxFetchBlockedTime")
+            << QStringLiteral("nodesCreated") << QStringLiteral("nodesReused")
+            << QStringLiteral("softwareBytesUploaded") << QStringLiteral("softwareBytesConverted")
+            << QStringLiteral("treeRebuilt") << QStringLiteral("acked");
+    bool committed = false;
+    int mailboxesFetched = 0;
+    qint64 softwareBytesUploaded = 0;
+    for (const QJsonValue &event : events) {
+        const QJsonObject object = event.toObject();
+        if (object.value(QStringLiteral("name")).toString() == QLatin1String("CompositorFrame")) {
+            const QJsonObject args = object.value(QStringLiteral("args")).toObject();
+            for (const QString &key : frameKeys)
+                QVERIFY2(args.contains(key), qPrintable(key));
+            QVERIFY(args.value(QStringLiteral("renderPasses")).toInt() >= 1);
+            QVERIFY(args.value(QStringLiteral("softwareBytesConverted")).toDouble()
+                    <= args.value(QStringLiteral("softwareBytesUploaded")).toDouble());
+            QVERIFY(object.value(QStringLiteral("dur")).toDouble() >= 0);
+            mailboxesFetched += args.value(QStringLiteral("mailboxesFetched")).toInt();
+            softwareBytesUploaded += qint64(args.value(QStringLiteral("softwareBytesUploaded")).toDouble());
+        } else if (object.value(QStringLiteral("name")).toString() == QLatin1String("DelegatedFrameNode::commit")) {
+            committed = true;
+        }
+    }
+    QVERIFY(committed);
+
+    view.page()->setFrameTimingEnabled(false);
+    QVERIFY(!view.page()->isFrameTimingEnabled());
+    // The recorded frames stay available.
+    QVERIFY(!view.page()->frameTimingTrace().isEmpty());
+
+    // The same frames are available as maps, together with their timestamps.
+    const QVariantList frames = view.page()->frameTimings();
+    QVERIFY(!frames.isEmpty());
+    const QStringList timeKeys = QStringList()
+            << QStringLiteral("swapTime") << QStringLiteral("commitStartTime") << QStringLiteral("commitEndTime")
+            << QStringLiteral("preprocessStartTime") << QStringLiteral("preprocessEndTime") << QStringLiteral("ackTime");
+    bool ackedFrame = false;
+    for (const QVariant &frame : frames) {
+        const QVariantMap timing = frame.toMap();
+        for (const QString &key : frameKeys + timeKeys)
+            QVERIFY2(timing.contains(key), qPrintable(key));
+        QVERIFY(timing.value(QStringLiteral("swapTime")).toLongLong() > 0);
+        if (timing.value(QStringLiteral("acked")).toBool()) {
+            ackedFrame = true;
+            QVERIFY(timing.value(QStringLiteral("ackTime")).toLongLong()
+                    >= timing.value(QStringLiteral("swapTime")).toLongLong());
+        }
+    }
+    QVERIFY(ackedFrame);
+
+    // Software compositing uploads its bitmaps, GPU compositing fetches its textures from mailboxes.
+    if (softwareBytesUploaded > 0) {
+        if (pipelinedTextureFetch)
+            QSKIP("Pipelined texture fetching needs GPU compositing");
+    } else {
+        QVERIFY(mailboxesFetched > 0);
+    }
+}
+
 void tst_QWebEnginePage::mouseButtonTranslation()
 {
     QWebEngineView view;
@@ -29,10 +29,14 @@
 #include "../util.h"
 #include <QtCore/qbuffer.h>
 #include <QtTest/QtTest>
+#include <QtWebEngineCore/qwebengineurlrequestinfo.h>
+#include <QtWebEngineCore/qwebengineurlrequestinterceptor.h>
 #include <QtWebEngineCore/qwebengineurlrequestjob.h>
 #include <QtWebEngineCore/qwebengineurlschemehandler.h>
 #include <QtWebEngineWidgets/qwebengineprofile.h>
 #include <QtWebEngineWidgets/qwebenginepage.h>
+#include <QtWebEngineWidgets/qwebenginescript.h>
+#include <QtWebEngineWidgets/qwebenginescriptcollection.h>
 #include <QtWebEngineWidgets/qwebenginesettings.h>
 #include <QtWebEngineWidgets/qwebengineview.h>
 #include <QtWebEngineWidgets/qwebenginedownloaditem.h>
@@ -49,10 +53,15 @@ private Q_SLOTS:
     void urlSchemeHandlers();
     void urlSchemeHandlerFailRequest();
     void urlSchemeHandlerFailOnRead();
+    void urlSchemeHandlerStreamedReply();
+    void urlSchemeHandlerStreamedReplyBackpressure();
+    void urlSchemeHandlerRange_data();
+    void urlSchemeHandlerRange();
     void customUserAgent();
     void httpAcceptLanguage();
     void downloadItem();
     void changePersistentPath();
+    void spareRenderers();
 };
 
 void tst_QWebEngineProfile::defaultProfile()
@@ -310,6 +319,176 @@ void tst_QWebEngineProfile::urlSchemeHandlerFailOnRead()
     QCOMPARE(toPlainTextSync(view.page()), QString());
 }
 
+class StreamingUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+public:
+    void requestStarted(QWebEngineUrlRequestJob *job) override
+    {
+        const QByteArray data = job->requestUrl().toString().toUtf8();
+        job->beginReply(QByteArrayLiteral("text/plain;charset=utf-8"), data.size());
+        // Hand the data over one byte at a time from the event loop.
+        for (int i = 0; i < data.size(); ++i) {
+            QTimer::singleShot(i, job, [job, data, i] {
+                job->appendReplyData(data.mid(i, 1));
+                if (i == data.size() - 1)
+                    job->finishReply();
+            });
+        }
+    }
+};
+
+void tst_QWebEngineProfile::urlSchemeHandlerStreamedReply()
+{
+    StreamingUrlSchemeHandler handler;
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("stream", &handler);
+    QWebEngineView view;
+    view.setPage(new QWebEnginePage(&profile, &view));
+    view.settings()->setAttribute(QWebEngineSettings::ErrorPageEnabled, false);
+    QUrl url = QUrl(QStringLiteral("stream://olsen-banden.dk/egon"));
+    QVERIFY(loadSync(&view, url));
+    QCOMPARE(toPlainTextSync(view.page()), url.toString());
+}
+
+class BackpressureUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+public:
+    static const int chunkSize = 64 * 1024;
+    static const int chunkCount = 128;
+
+    int rejectedCount = 0;
+    int appendedCount = 0;
+
+    void requestStarted(QWebEngineUrlRequestJob *job) override
+    {
+        job->beginReply(QByteArrayLiteral("text/plain"), qint64(chunkSize) * chunkCount);
+        connect(job, &QWebEngineUrlRequestJob::readyForReplyData, job, [this, job] { appendChunks(job); });
+        appendChunks(job);
+    }
+
+private:
+    void appendChunks(QWebEngineUrlRequestJob *job)
+    {
+        // Produce data as fast as the job takes it, a well behaved streaming handler.
+        while (appendedCount < chunkCount) {
+            if (!job->appendReplyData(QByteArray(chunkSize, 'a' + appendedCount % 26))) {
+                ++rejectedCount;
+                return;
+            }
+            ++appendedCount;
+        }
+        job->finishReply();
+    }
+};
+
+void tst_QWebEngineProfile::urlSchemeHandlerStreamedReplyBackpressure()
+{
+    BackpressureUrlSchemeHandler handler;
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("stream", &handler);
+    QWebEngineView view;
+    view.setPage(new QWebEnginePage(&profile, &view));
+    view.settings()->setAttribute(QWebEngineSettings::ErrorPageEnabled, false);
+    QVERIFY(loadSync(&view, QUrl(QStringLiteral("stream://backpressure"))));
+
+    // The reply is much larger than what is buffered ahead, so the handler had to wait.
+    QVERIFY(handler.rejectedCount > 0);
+    QCOMPARE(handler.appendedCount, int(BackpressureUrlSchemeHandler::chunkCount));
+    QCOMPARE(evaluateJavaScriptSync(view.page(), QStringLiteral("document.body.textContent.length")).toInt(),
+             BackpressureUrlSchemeHandler::chunkSize * BackpressureUrlSchemeHandler::chunkCount);
+}
+
+class RangeRequestInterceptor : public QWebEngineUrlRequestInterceptor
+{
+public:
+    QByteArray range;
+
+    void interceptRequest(QWebEngineUrlRequestInfo &info) override
+    {
+        if (!range.isEmpty())
+            info.setHttpHeader(QByteArrayLiteral("Range"), range);
+    }
+};
+
+class RangeUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+public:
+    static QByteArray resource() { return QByteArrayLiteral("0123456789"); }
+
+    qint64 requestedStart = -2;
+    qint64 requestedEnd = -2;
+
+    void requestStarted(QWebEngineUrlRequestJob *job) override
+    {
+        requestedStart = job->requestedRangeStart();
+        requestedEnd = job->requestedRangeEnd();
+        if (job->requestUrl().path() == QLatin1String("/device")) {
+            // The job applies the range to random access devices.
+            QBuffer *buffer = new QBuffer(job);
+            buffer->setData(resource());
+            job->reply(QByteArrayLiteral("text/plain"), buffer);
+            return;
+        }
+
+        // The handler applies the range itself and streams it.
+        QByteArray data = resource();
+        if (requestedStart >= 0) {
+            const qint64 end = requestedEnd >= 0 ? requestedEnd : data.size() - 1;
+            data = data.mid(requestedStart, end - requestedStart + 1);
+            job->setReplyRange(requestedStart, end, resource().size());
+        }
+        job->beginReply(QByteArrayLiteral("text/plain"));
+        job->appendReplyData(data);
+        job->finishReply();
+    }
+};
+
+void tst_QWebEngineProfile::urlSchemeHandlerRange_data()
+{
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<QByteArray>("range");
+    QTest::addColumn<qint64>("requestedStart");
+    QTest::addColumn<qint64>("requestedEnd");
+    QTest::addColumn<bool>("loadOk");
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("no range") << "/device" << QByteArray() << qint64(-1) << qint64(-1) << true << "0123456789";
+    QTest::newRow("range") << "/device" << QByteArray("bytes=2-5") << qint64(2) << qint64(5) << true << "2345";
+    QTest::newRow("open range") << "/device" << QByteArray("bytes=7-") << qint64(7) << qint64(-1) << true << "789";
+    QTest::newRow("suffix range") << "/device" << QByteArray("bytes=-3") << qint64(-1) << qint64(-1) << true << "789";
+    QTest::newRow("unsatisfiable range") << "/device" << QByteArray("bytes=20-30") << qint64(20) << qint64(30) << false << "";
+    QTest::newRow("range applied by handler") << "/handler" << QByteArray("bytes=2-5") << qint64(2) << qint64(5) << true << "2345";
+    QTest::newRow("open range applied by handler") << "/handler" << QByteArray("bytes=7-") << qint64(7) << qint64(-1) << true << "789";
+}
+
+void tst_QWebEngineProfile::urlSchemeHandlerRange()
+{
+    QFETCH(QString, path);
+    QFETCH(QByteArray, range);
+    QFETCH(qint64, requestedStart);
+    QFETCH(qint64, requestedEnd);
+    QFETCH(bool, loadOk);
+    QFETCH(QString, text);
+
+    RangeUrlSchemeHandler handler;
+    RangeRequestInterceptor interceptor;
+    interceptor.range = range;
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("range", &handler);
+    profile.setRequestInterceptor(&interceptor);
+    QWebEngineView view;
+    view.setPage(new QWebEnginePage(&profile, &view));
+    view.settings()->setAttribute(QWebEngineSettings::ErrorPageEnabled, false);
+    QSignalSpy loadFinishedSpy(&view, SIGNAL(loadFinished(bool)));
+    view.load(QUrl(QStringLiteral("range://resource") + path));
+    QTRY_COMPARE(loadFinishedSpy.count(), 1);
+
+    QCOMPARE(handler.requestedStart, requestedStart);
+    QCOMPARE(handler.requestedEnd, requestedEnd);
+    QCOMPARE(loadFinishedSpy.takeFirst().value(0).toBool(), loadOk);
+    QCOMPARE(toPlainTextSync(view.page()), text);
+}
+
 void tst_QWebEngineProfile::customUserAgent()
 {
     QString defaultUserAgent = QWebEngineProfile::defaultProfile()->httpUserAgent();
@@ -395,5 +574,65 @@ void tst_QWebEngineProfile::changePersistentPath()
     QVERIFY(newPath.endsWith(QStringLiteral("Test2")));
 }
 
+// A page that starts in a spare renderer has a launched process right away,
+// other pages only get one once its launch has finished asynchronously.
+static QWebEnginePage *createPageInSpareRenderer(QWebEngineProfile *profile)
+{
+    QScopedPointer<QWebEnginePage> page(new QWebEnginePage(profile));
+    if (page->renderProcessPid() <= 0)
+        return nullptr;
+    return page.take();
+}
+
+void tst_QWebEngineProfile::spareRenderers()
+{
+    QWebEngineProfile testProfile;
+    QCOMPARE(testProfile.spareRendererCount(), 0);
+    testProfile.setSpareRendererCount(1);
+    QCOMPARE(testProfile.spareRendererCount(), 1);
+    testProfile.setSpareRendererCount(-1);
+    QCOMPARE(testProfile.spareRendererCount(), 0);
+    testProfile.setSpareRendererCount(2);
+
+    QWebEngineScript script;
+    script.setName(QStringLiteral("marker"));
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(QWebEngineScript::MainWorld);
+    script.setSourceCode(QStringLiteral("window.spareRendererMarker = 42;"));
+    testProfile.scripts()->insert(script);
+
+    // The first page launches its own renderer and starts filling the pool.
+    QWebEnginePage page(&testProfile);
+    QSignalSpy loadFinishedSpy(&page, SIGNAL(loadFinished(bool)));
+    page.setHtml(QStringLiteral("<html><body>Hello world!</body></html>"));
+    QTRY_COMPARE(loadFinishedSpy.count(), 1);
+    QVERIFY(loadFinishedSpy.takeFirst().takeFirst().toBool());
+    QVERIFY(page.renderProcessPid() > 0);
+
+    // Pages created afterwards start in spare renderers, which must be fully set up.
+    QSet<qint64> pids;
+    pids.insert(page.renderProcessPid());
+    for (int i = 0; i < 3; ++i) {
+        QWebEnginePage *sparePage = nullptr;
+        QTRY_VERIFY((sparePage = createPageInSpareRenderer(&testProfile)));
+        QScopedPointer<QWebEnginePage> spare(sparePage);
+        const qint64 pid = spare->renderProcessPid();
+        QVERIFY(!pids.contains(pid));
+        pids.insert(pid);
+
+        QSignalSpy spareLoadFinishedSpy(spare.data(), SIGNAL(loadFinished(bool)));
+        spare->setHtml(QStringLiteral("<html><body>Hello again!</body></html>"));
+        QTRY_COMPARE(spareLoadFinishedSpy.count(), 1);
+        QVERIFY(spareLoadFinishedSpy.takeFirst().takeFirst().toBool());
+        QCOMPARE(spare->renderProcessPid(), pid);
+        QCOMPARE(evaluateJavaScriptSync(spare.data(), QStringLiteral("window.spareRendererMarker")).toInt(), 42);
+    }
+
+    // Without spares new pages have to wait for their renderer to launch.
+    testProfile.setSpareRendererCount(0);
+    QWebEnginePage withoutSpare(&testProfile);
+    QCOMPARE(withoutSpare.renderProcessPid(), qint64(0));
+}
+
 QTEST_MAIN(tst_QWebEngineProfile)
 #include "tst_qwebengineprofile.moc"
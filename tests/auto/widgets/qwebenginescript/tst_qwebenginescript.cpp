@@ -22,6 +22,7 @@
 #include <qwebenginepage.h>
 #include <qwebenginescript.h>
 #include <qwebenginescriptcollection.h>
+#include <qwebenginesettings.h>
 #include <qwebengineview.h>
 #include "../util.h"
 #include <QWebChannel>
@@ -38,6 +39,10 @@ private Q_SLOTS:
     void webChannel_data();
     void webChannel();
     void noTransportWithoutWebChannel();
+    void webChannelThroughput_data();
+    void webChannelThroughput();
+    void webChannelBatchedMessages();
+    void webChannelBatchInterval();
 };
 
 void tst_QWebEngineScript::domEditing()
@@ -246,6 +251,184 @@ void tst_QWebEngineScript::noTransportWithoutWebChannel()
     QCOMPARE(evaluateJavaScriptSync(&page, "qt.webChannelTransport"), QVariant(QVariant::Invalid));
 }
 
+class PingObject : public QObject
+{
+    Q_OBJECT
+public:
+    PingObject(QObject *parent = 0) : QObject(parent), m_lastPong(-1) { }
+
+    Q_INVOKABLE void pong(int count) { m_lastPong = count; }
+    int lastPong() const { return m_lastPong; }
+
+signals:
+    void ping(int count);
+
+private:
+    int m_lastPong;
+};
+
+void tst_QWebEngineScript::webChannelThroughput_data()
+{
+    QTest::addColumn<bool>("objectMessages");
+    QTest::addColumn<bool>("batched");
+    QTest::newRow("JsonText") << false << false;
+    QTest::newRow("Objects") << true << false;
+    QTest::newRow("BatchedJsonText") << false << true;
+    QTest::newRow("BatchedObjects") << true << true;
+}
+
+void tst_QWebEngineScript::webChannelThroughput()
+{
+    QFETCH(bool, objectMessages);
+    QFETCH(bool, batched);
+    const int messageCount = 2000;
+
+    QWebEnginePage page;
+    page.settings()->setAttribute(QWebEngineSettings::WebChannelMessageBatching, batched);
+    page.settings()->setAttribute(QWebEngineSettings::WebChannelObjectMessages, objectMessages);
+    PingObject pingObject;
+    QScopedPointer<QWebChannel> channel(new QWebChannel(this));
+    channel->registerObject(QStringLiteral("object"), &pingObject);
+    page.setWebChannel(channel.data());
+
+    QFile qwebchanneljs(":/qwebchannel.js");
+    QVERIFY(qwebchanneljs.open(QFile::ReadOnly));
+    QWebEngineScript script;
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(QWebEngineScript::MainWorld);
+    script.setSourceCode(QString::fromLatin1(qwebchanneljs.readAll()));
+    page.scripts().insert(script);
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QVERIFY(spyFinished.wait());
+
+    page.runJavaScript(QStringLiteral(
+                           "new QWebChannel(qt.webChannelTransport, function(channel) {"
+                           "    window.pingObject = channel.objects.object;"
+                           "    pingObject.ping.connect(function(count) {"
+                           "        if (count == %1)"
+                           "            pingObject.pong(count);"
+                           "    });"
+                           "    pingObject.pong(0);"
+                           "});").arg(messageCount));
+    QTRY_COMPARE(pingObject.lastPong(), 0);
+
+    for (int i = 1; i <= messageCount; ++i)
+        emit pingObject.ping(i);
+    QTRY_COMPARE_WITH_TIMEOUT(pingObject.lastPong(), messageCount, 30000);
+
+    page.runJavaScript(QStringLiteral("for (var i = 1; i <= %1; ++i) pingObject.pong(-i);").arg(messageCount));
+    QTRY_COMPARE_WITH_TIMEOUT(pingObject.lastPong(), -messageCount, 30000);
+}
+
+void tst_QWebEngineScript::webChannelBatchedMessages()
+{
+    const int messageCount = 100;
+
+    QWebEnginePage page;
+    page.settings()->setAttribute(QWebEngineSettings::WebChannelMessageBatching, true);
+    PingObject pingObject;
+    QScopedPointer<QWebChannel> channel(new QWebChannel(this));
+    channel->registerObject(QStringLiteral("object"), &pingObject);
+    page.setWebChannel(channel.data());
+
+    QFile qwebchanneljs(":/qwebchannel.js");
+    QVERIFY(qwebchanneljs.open(QFile::ReadOnly));
+    QWebEngineScript script;
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(QWebEngineScript::MainWorld);
+    script.setSourceCode(QString::fromLatin1(qwebchanneljs.readAll()));
+    page.scripts().insert(script);
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QVERIFY(spyFinished.wait());
+
+    // qwebchannel.js only handles onmessage, the batches are forwarded to it one message at a time.
+    page.runJavaScript(QStringLiteral(
+                           "window.batchSizes = [];"
+                           "new QWebChannel(qt.webChannelTransport, function(channel) {"
+                           "    qt.webChannelTransport.onmessages = function(messages) {"
+                           "        batchSizes.push(messages.length);"
+                           "        for (var i = 0; i < messages.length; ++i)"
+                           "            qt.webChannelTransport.onmessage(messages[i]);"
+                           "    };"
+                           "    window.pingObject = channel.objects.object;"
+                           "    pingObject.ping.connect(function(count) {"
+                           "        if (count == %1)"
+                           "            pingObject.pong(count);"
+                           "    });"
+                           "    pingObject.pong(0);"
+                           "});").arg(messageCount));
+    QTRY_COMPARE(pingObject.lastPong(), 0);
+
+    for (int i = 1; i <= messageCount; ++i)
+        emit pingObject.ping(i);
+    QTRY_COMPARE(pingObject.lastPong(), messageCount);
+
+    // All the signals were emitted within one event loop iteration.
+    QCOMPARE(evaluateJavaScriptSync(&page, "batchSizes.length").toInt(), 1);
+    QCOMPARE(evaluateJavaScriptSync(&page, "batchSizes[0]").toInt(), messageCount);
+
+    // Messages still pending when the channel goes away are delivered.
+    emit pingObject.ping(messageCount + 1);
+    emit pingObject.ping(messageCount + 2);
+    page.setWebChannel(nullptr);
+    QTRY_COMPARE(evaluateJavaScriptSync(&page, "batchSizes.length").toInt(), 2);
+}
+
+void tst_QWebEngineScript::webChannelBatchInterval()
+{
+    const int messageCount = 10;
+
+    QWebEnginePage page;
+    QCOMPARE(page.settings()->webChannelBatchInterval(), 0);
+    page.settings()->setAttribute(QWebEngineSettings::WebChannelMessageBatching, true);
+    page.settings()->setWebChannelBatchInterval(1000);
+    QCOMPARE(page.settings()->webChannelBatchInterval(), 1000);
+    PingObject pingObject;
+    QScopedPointer<QWebChannel> channel(new QWebChannel(this));
+    channel->registerObject(QStringLiteral("object"), &pingObject);
+    page.setWebChannel(channel.data());
+
+    QFile qwebchanneljs(":/qwebchannel.js");
+    QVERIFY(qwebchanneljs.open(QFile::ReadOnly));
+    QWebEngineScript script;
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(QWebEngineScript::MainWorld);
+    script.setSourceCode(QString::fromLatin1(qwebchanneljs.readAll()));
+    page.scripts().insert(script);
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QVERIFY(spyFinished.wait());
+
+    page.runJavaScript(QStringLiteral(
+                           "window.batchSizes = [];"
+                           "new QWebChannel(qt.webChannelTransport, function(channel) {"
+                           "    qt.webChannelTransport.onmessages = function(messages) {"
+                           "        batchSizes.push(messages.length);"
+                           "        for (var i = 0; i < messages.length; ++i)"
+                           "            qt.webChannelTransport.onmessage(messages[i]);"
+                           "    };"
+                           "    window.pingObject = channel.objects.object;"
+                           "    pingObject.ping.connect(function(count) {"
+                           "        if (count == %1)"
+                           "            pingObject.pong(count);"
+                           "    });"
+                           "    pingObject.pong(0);"
+                           "});").arg(messageCount));
+    QTRY_COMPARE(pingObject.lastPong(), 0);
+    evaluateJavaScriptSync(&page, "batchSizes = []");
+
+    // Messages sent from separate event loop iterations within the interval still go out together.
+    for (int i = 1; i <= messageCount; ++i) {
+        emit pingObject.ping(i);
+        QTest::qWait(10);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(pingObject.lastPong(), messageCount, 10000);
+    QCOMPARE(evaluateJavaScriptSync(&page, "batchSizes.length").toInt(), 1);
+    QCOMPARE(evaluateJavaScriptSync(&page, "batchSizes[0]").toInt(), messageCount);
+}
+
 QTEST_MAIN(tst_QWebEngineScript)
 
 #include "tst_qwebenginescript.moc"
@@ -3,7 +3,9 @@ TEMPLATE = subdirs
 SUBDIRS += \
     qwebengineaccessibility \
     qwebenginedefaultsurfaceformat \
+    qwebenginedeferredstartup \
     qwebenginefaviconmanager \
+    qwebenginemessagepump \
     qwebenginepage \
     qwebenginehistory \
     qwebenginehistoryinterface \
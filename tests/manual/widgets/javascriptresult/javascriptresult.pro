@@ -0,0 +1,10 @@
+QT += core gui widgets webenginewidgets testlib
+
+TARGET = tst_javascriptresult
+TEMPLATE = app
+CONFIG += c++11
+
+INCLUDEPATH += $$PWD/../../../auto/widgets
+
+SOURCES += \
+    tst_javascriptresult.cpp
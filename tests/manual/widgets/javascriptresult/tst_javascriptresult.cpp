@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "util.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QtTest/QtTest>
+#include <QtWebEngineWidgets/qwebenginepage.h>
+#include <QtWebEngineWidgets/qwebenginescript.h>
+
+// Measures how long large script results take to reach the callback, as QVariant and as JSON.
+class tst_JavaScriptResult : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void largeResult_data();
+    void largeResult();
+};
+
+static QJsonValue evaluateJavaScriptAsJsonSync(QWebEnginePage *page, const QString &script)
+{
+    CallbackSpy<QJsonValue> spy;
+    page->runJavaScriptAsJson(script, QWebEngineScript::MainWorld, spy.ref());
+    return spy.waitForResult();
+}
+
+void tst_JavaScriptResult::largeResult_data()
+{
+    QTest::addColumn<bool>("asJson");
+    QTest::addColumn<int>("count");
+    QTest::newRow("variant-1000") << false << 1000;
+    QTest::newRow("json-1000") << true << 1000;
+    QTest::newRow("variant-100000") << false << 100000;
+    QTest::newRow("json-100000") << true << 100000;
+}
+
+void tst_JavaScriptResult::largeResult()
+{
+    QFETCH(bool, asJson);
+    QFETCH(int, count);
+
+    QWebEnginePage page;
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    evaluateJavaScriptSync(&page, QStringLiteral("var rows = []; for (var i = 0; i < %1; ++i) "
+                                                 "rows.push({id: i, name: 'row ' + i, values: [i, i * 2, i * 3]}); "
+                                                 "true").arg(count));
+
+    int size = 0;
+    QBENCHMARK {
+        if (asJson)
+            size = evaluateJavaScriptAsJsonSync(&page, QStringLiteral("rows")).toArray().size();
+        else
+            size = evaluateJavaScriptSync(&page, QStringLiteral("rows")).toList().size();
+    }
+    QCOMPARE(size, count);
+}
+
+QTEST_MAIN(tst_JavaScriptResult)
+#include "tst_javascriptresult.moc"